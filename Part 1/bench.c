@@ -0,0 +1,623 @@
+/* bench.c */
+/* make bench - per-kernel timings of libvowelstats, written as JSON */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h> // for clock_gettime()
+#include <unistd.h> // for rmdir(), unlink()
+#include <sys/stat.h> // for stat()
+#include "vowel_stats.h"
+#include "vowel_perf.h"
+
+// Every kernel runs through vowelStatsAnalyze() with only its pass enabled,
+// so the numbers include the dispatch a real call pays. Each (input, size,
+// kernel) cell gets `warmup` untimed runs and `reps` timed ones; the JSON
+// has one result per line so two runs diff cleanly. The *_template kernels
+// are the same passes on the engines of vowel_templates.cpp; compare them
+// with --simd=scalar, where the plain kernels run the hand-unrolled C.
+//
+// The sampling kernels call vowelStatsSample() once per stride of --strides,
+// with and without prefetching, and time the whole list sampled one stride
+// after another against one vowelStatsSampleStrides() pass. Their effects
+// only show on buffers well past the last-level cache, e.g. --sizes=1048576.
+//
+// histogram_hash is the histogram with the content hash folded into its
+// loop; the difference from histogram is what hashing costs. The cache
+// kernels run the pipeline against a result cache in a temporary directory:
+// after the warm-up every run of pipeline_cache_hit hits, while
+// pipeline_cache_miss has no room for an entry, so every run misses, stores
+// and evicts. Their hit and miss counts cover the timed runs.
+//
+// mismatches_4 lists every window within 4 mismatches of pi (q-gram filter)
+// and mismatches_12 the same past the filter's reach, where every window is
+// counted; top_10 keeps the 10 best windows. Compare them with hamming and
+// hamming_qgram on pi_near, whose near-copies of pi are what the filter finds.
+//
+// index_build writes the suffix index of the input (to the same temporary
+// directory) and notes its size; index_query_pi answers the longest pi
+// prefix from an index built before the timed runs. Its median is one
+// query's latency, to set against pi_prefix rescanning the input.
+
+#define DEFAULT_REPS 15
+#define DEFAULT_WARMUP 3
+#define MAX_SIZES 16
+#define MAX_STRIDES 16
+
+typedef enum {
+    RUN_ANALYZE,         // vowelStatsAnalyze() with `passes`
+    RUN_SAMPLE_BUMP,     // Each stride alone, no prefetch
+    RUN_SAMPLE_PREFETCH, // Each stride alone, default prefetch distance
+    RUN_SAMPLE_EACH,     // All strides, one walk each
+    RUN_SAMPLE_BATCH,    // All strides in one walk
+    RUN_MISMATCHES,      // vowelStatsFindMismatches() within `matches`
+    RUN_TOP,             // vowelStatsTopMatches() for the best `matches`
+    RUN_INDEX_BUILD,     // vowelStatsBuildIndex() to the temporary directory
+    RUN_INDEX_QUERY,     // Longest pi prefix from a prebuilt index
+} RunKind;
+
+typedef enum {
+    NO_CACHE,
+    CACHE_WARM, // Room for every result
+    CACHE_COLD, // Room for none
+} CacheMode;
+
+typedef struct {
+    const char* name;
+    RunKind kind;
+    unsigned passes;
+    size_t fusedBlock;     // 0 = multi-pass
+    const char* hamming;   // Hamming engine, NULL = default
+    const char* prefix;    // Pi prefix engine, NULL = default
+    const char* histogram; // Histogram engine, NULL = default
+    CacheMode cache;
+    size_t matches;        // Mismatch threshold or top-K count
+} Kernel;
+
+static const Kernel kernels[] = {
+    { .name = "histogram", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_HISTOGRAM },
+    { .name = "histogram_unrolled", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_HISTOGRAM, .histogram = "unrolled" },
+    { .name = "histogram_hash", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_HISTOGRAM | VOWEL_STATS_HASH },
+    { .name = "pi_prefix", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_PI_PREFIX },
+    { .name = "hamming", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_HAMMING },
+    { .name = "pi_prefix_template", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_PI_PREFIX, .prefix = "template" },
+    { .name = "hamming_template", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_HAMMING, .hamming = "template" },
+    { .name = "hamming_qgram", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_HAMMING, .hamming = "qgram" },
+    { .name = "mismatches_4", .kind = RUN_MISMATCHES, .matches = 4 },
+    { .name = "mismatches_12", .kind = RUN_MISMATCHES, .matches = 12 },
+    { .name = "top_10", .kind = RUN_TOP, .matches = 10 },
+    { .name = "index_build", .kind = RUN_INDEX_BUILD },
+    { .name = "index_query_pi", .kind = RUN_INDEX_QUERY },
+    { .name = "sparse", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_SPARSE },
+    { .name = "utf8", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_UTF8 },
+    { .name = "pipeline", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_DEFAULT },
+    { .name = "pipeline_fused", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_DEFAULT, .fusedBlock = 256 << 10 },
+    { .name = "pipeline_cache_hit", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_DEFAULT, .cache = CACHE_WARM },
+    { .name = "pipeline_cache_miss", .kind = RUN_ANALYZE, .passes = VOWEL_STATS_DEFAULT, .cache = CACHE_COLD },
+    { .name = "sample_bump", .kind = RUN_SAMPLE_BUMP },
+    { .name = "sample_prefetch", .kind = RUN_SAMPLE_PREFETCH },
+    { .name = "sample_each", .kind = RUN_SAMPLE_EACH },
+    { .name = "sample_batch", .kind = RUN_SAMPLE_BATCH },
+};
+#define KERNEL_COUNT (sizeof(kernels) / sizeof(kernels[0]))
+
+// ==========================================
+// INPUTS
+// ==========================================
+
+static uint64_t rngState;
+
+// splitmix64: fixed seed, so every run times the same bytes
+static uint64_t nextRandom(void) {
+    uint64_t z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void fillFromPool(char* buf, size_t size, const char* pool, size_t poolSize) {
+    for (size_t i = 0; i < size; i++) buf[i] = pool[nextRandom() % poolSize];
+}
+
+// create_buffer.out's distribution: the 52 letters once each, then digits
+// filling the rest of 256 entries (about 80% digits)
+static void fillMixed(char* buf, size_t size) {
+    static char pool[256];
+    static size_t poolSize = 0;
+    if (poolSize == 0) {
+        const char* letters = "aeiouAEIOUbcdfghjklmnpqrstvwxyzBCDFGHJKLMNPQRSTVWXYZ";
+        for (const char* c = letters; *c; c++) pool[poolSize++] = *c;
+        for (int d = 0; poolSize < sizeof(pool); d = (d + 1) % 10) pool[poolSize++] = (char)('0' + d);
+    }
+    fillFromPool(buf, size, pool, poolSize);
+}
+
+// No digits: the pi kernels find nothing and Hamming never scores
+static void fillLetters(char* buf, size_t size) {
+    const char* letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    fillFromPool(buf, size, letters, 52);
+}
+
+// Uniform digits: a '3' every 10 bytes, the pi scan's busiest case
+static void fillDigits(char* buf, size_t size) {
+    fillFromPool(buf, size, "0123456789", 10);
+}
+
+// Uniform digits with a long pi prefix every KiB, so prefix compares run long
+static void fillPiRuns(char* buf, size_t size) {
+    const char* pi = "3141592653589793238462643383279502884197169399375105820974944592";
+    size_t piLength = strlen(pi);
+    fillDigits(buf, size);
+    for (size_t at = 512; at + piLength <= size; at += 1024) {
+        memcpy(buf + at, pi, 8 + nextRandom() % (piLength - 8));
+    }
+}
+
+// Low entropy: runs of 16 to 271 copies of one letter or digit, as in
+// padded records or repeated characters; each run is one counter hit over and over
+static void fillRuns(char* buf, size_t size) {
+    const char* pool = "aeiouAEIOUbcdfghjklmnpqrstvwxyz0123456789 ";
+    for (size_t i = 0; i < size; ) {
+        size_t run = 16 + nextRandom() % 256;
+        if (run > size - i) run = size - i;
+        memset(buf + i, pool[nextRandom() % strlen(pool)], run);
+        i += run;
+    }
+}
+
+// Uniform digits with a copy of pi every 64 KiB, 1 to 7 of its digits changed:
+// the near matches a k-mismatch search is after
+static void fillPiNear(char* buf, size_t size) {
+    const char* pi = "3141592653589793238462643383279502884197169399375105820974944592"
+                     "307816406286208998628034825342117067";
+    fillDigits(buf, size);
+    for (size_t at = 4096; at + 100 <= size; at += 64 << 10) {
+        memcpy(buf + at, pi, 100);
+        for (int changes = 1 + nextRandom() % 7; changes > 0; changes--) buf[at + nextRandom() % 100] = 'x';
+    }
+}
+
+// Every byte value, as in binary input
+static void fillBytes(char* buf, size_t size) {
+    for (size_t i = 0; i < size; i++) buf[i] = (char)nextRandom();
+}
+
+// Well-formed UTF-8 prose: mostly ASCII letters, then accented Latin,
+// Cyrillic, Han and emoji, one code point at a time
+static void fillUtf8(char* buf, size_t size) {
+    static const char* const pool[] = {
+        "a", "e", "t", "n", "s", "r", " ", "\xc3\xa9", "\xc3\xa0", "\xc3\xbc", "\xd0\xb4", "\xd0\xb6",
+        "\xe4\xb8\xad", "\xe6\x96\x87", "\xf0\x9f\x98\x80",
+    };
+    static const int weights[] = { 16, 16, 12, 12, 12, 12, 10, 3, 1, 1, 2, 1, 1, 1, 1 };
+    int total = 0;
+    for (size_t p = 0; p < sizeof(weights) / sizeof(weights[0]); p++) total += weights[p];
+    size_t i = 0;
+    while (i < size) {
+        int pick = (int)(nextRandom() % total);
+        size_t p = 0;
+        while (pick >= weights[p]) pick -= weights[p++];
+        size_t length = strlen(pool[p]);
+        if (length > size - i) length = 0; // No room: pad the end with spaces
+        if (length == 0) {
+            buf[i++] = ' ';
+        } else {
+            memcpy(buf + i, pool[p], length);
+            i += length;
+        }
+    }
+}
+
+typedef struct {
+    const char* name;
+    void (*fill)(char* buf, size_t size);
+} Input;
+
+static const Input inputs[] = {
+    { "mixed", fillMixed },
+    { "letters", fillLetters },
+    { "digits", fillDigits },
+    { "pi_runs", fillPiRuns },
+    { "pi_near", fillPiNear },
+    { "runs", fillRuns },
+    { "bytes", fillBytes },
+    { "utf8", fillUtf8 },
+};
+#define INPUT_COUNT (sizeof(inputs) / sizeof(inputs[0]))
+
+// ==========================================
+// TIMING
+// ==========================================
+
+typedef struct {
+    double median;
+    double p95;
+    double mean;
+    double stddev;
+    double min;
+} Summary;
+
+static double nowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts samples in place
+static Summary summarize(double* samples, int count) {
+    Summary summary;
+    qsort(samples, count, sizeof(double), compareDoubles);
+    summary.median = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    int rank = (int)ceil(0.95 * count) - 1; // Nearest rank
+    summary.p95 = samples[rank < 0 ? 0 : rank];
+    summary.min = samples[0];
+
+    double sum = 0;
+    for (int i = 0; i < count; i++) sum += samples[i];
+    summary.mean = sum / count;
+    double squares = 0;
+    for (int i = 0; i < count; i++) squares += (samples[i] - summary.mean) * (samples[i] - summary.mean);
+    summary.stddev = count > 1 ? sqrt(squares / (count - 1)) : 0;
+    return summary;
+}
+
+// One timed unit of work
+typedef struct {
+    VowelStats* stats;
+    const Kernel* kernel;
+    const char* buf;
+    size_t size;
+    const VowelStatsStride* strides; // The one stride, or the whole list
+    int strideCount;
+    ResultCache* cache;              // The context's result cache, or NULL
+    const char* indexPath;           // Where index_build writes
+    const SuffixIndex* index;        // index_query's prebuilt index
+} Cell;
+
+static int runCell(const Cell* cell) {
+    VowelStatsResult result;
+    VowelStatsSparse samples[MAX_STRIDES];
+    MismatchHit top[16];
+    MismatchList hits;
+    size_t count;
+    uint64_t occurrences, at;
+    int status;
+    switch (cell->kernel->kind) {
+        case RUN_ANALYZE:
+            return vowelStatsAnalyze(cell->stats, cell->buf, cell->size, &result);
+        case RUN_MISMATCHES:
+            mismatchListInit(&hits);
+            status = vowelStatsFindMismatches(cell->stats, cell->buf, cell->size, (int)cell->kernel->matches, &hits);
+            mismatchListFree(&hits);
+            return status;
+        case RUN_TOP:
+            return vowelStatsTopMatches(cell->stats, cell->buf, cell->size, cell->kernel->matches, top, &count);
+        case RUN_INDEX_BUILD:
+            return vowelStatsBuildIndex(cell->stats, cell->buf, cell->size, cell->indexPath);
+        case RUN_INDEX_QUERY:
+            suffixIndexLongestPrefix(cell->index, piDigits, VOWEL_STATS_PI_LENGTH, &occurrences, &at);
+            return 0;
+        case RUN_SAMPLE_BUMP:
+        case RUN_SAMPLE_PREFETCH:
+        case RUN_SAMPLE_EACH:
+            for (int s = 0; s < cell->strideCount; s++) {
+                if (vowelStatsSample(cell->stats, cell->buf, cell->size, cell->strides[s].offset,
+                                     cell->strides[s].stride, &samples[s]) != 0) {
+                    return -1;
+                }
+            }
+            return 0;
+        case RUN_SAMPLE_BATCH:
+            return vowelStatsSampleStrides(cell->stats, cell->buf, cell->size, cell->strides,
+                                           cell->strideCount, samples);
+    }
+    return -1;
+}
+
+// With `counters`, the timed runs are also counted and *perRun gets the
+// per-run average. With a cache, *lookups gets its counts over the timed runs.
+static int timeKernel(const Cell* cell, int warmup, int reps, double* samples, Summary* summary,
+                      PerfCounters* counters, PerfSample* perRun, ResultCacheCounters* lookups) {
+    for (int i = 0; i < warmup; i++) {
+        if (runCell(cell) != 0) return -1;
+    }
+    ResultCacheCounters before;
+    if (cell->cache != NULL) resultCacheCounters(cell->cache, &before);
+    if (counters != NULL) perfCountersStart(counters);
+    for (int i = 0; i < reps; i++) {
+        double start = nowNs();
+        if (runCell(cell) != 0) return -1;
+        samples[i] = nowNs() - start;
+    }
+    if (counters != NULL) {
+        perfCountersStop(counters, perRun);
+        for (int id = 0; id < PERF_COUNTER_COUNT; id++) perRun->values[id] /= reps;
+    }
+    if (cell->cache != NULL) {
+        resultCacheCounters(cell->cache, lookups);
+        lookups->hits -= before.hits;
+        lookups->misses -= before.misses;
+        lookups->stores -= before.stores;
+        lookups->evictions -= before.evictions;
+    }
+    *summary = summarize(samples, reps);
+    return 0;
+}
+
+// ==========================================
+// MAIN
+// ==========================================
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --json=PATH        write results to PATH (default: stdout)\n");
+    fprintf(stderr, "  --label=TEXT       tag the run, e.g. with the commit it measures\n");
+    fprintf(stderr, "  --sizes=KiB,...    input sizes (default 64,1024,8192)\n");
+    fprintf(stderr, "  --strides=B,...    sampling strides (default 64,256,1000,4096,16384,65536)\n");
+    fprintf(stderr, "  --reps=N           timed runs per cell (default %d)\n", DEFAULT_REPS);
+    fprintf(stderr, "  --warmup=N         untimed runs per cell (default %d)\n", DEFAULT_WARMUP);
+    fprintf(stderr, "  --threads=N        analysis threads (default 1, for stable numbers)\n");
+    fprintf(stderr, "  --simd=LEVEL       kernel level (default: best supported)\n");
+    fprintf(stderr, "  --kernel=NAME      only this kernel (repeatable)\n");
+    fprintf(stderr, "  --input=NAME       only this input distribution (repeatable)\n");
+    fprintf(stderr, "  --perf             add per-run hardware counters to each result\n");
+    fprintf(stderr, "  --small-pages      plain malloc() for the input instead of huge pages\n");
+}
+
+static int selected(const char* name, const char** wanted, int count) {
+    if (count == 0) return 1;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(name, wanted[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    const char* jsonPath = NULL;
+    const char* label = "";
+    size_t sizes[MAX_SIZES] = { 64 << 10, 1 << 20, 8 << 20 };
+    int sizeCount = 3;
+    int reps = DEFAULT_REPS;
+    int warmup = DEFAULT_WARMUP;
+    int threads = 1;
+    const char* wantedKernels[KERNEL_COUNT];
+    int wantedKernelCount = 0;
+    const char* wantedInputs[INPUT_COUNT];
+    int wantedInputCount = 0;
+    int countEvents = 0;
+    VowelStatsStride strides[MAX_STRIDES] = {
+        { 0, 64 }, { 0, 256 }, { 0, 1000 }, { 0, 4096 }, { 0, 16384 }, { 0, 65536 },
+    };
+    int strideCount = 6;
+    int smallPages = 0;
+
+    VowelStats* stats = vowelStatsCreate();
+    if (stats == NULL) {
+        fprintf(stderr, "Failed to allocate the analysis context\n");
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--json=", 7) == 0) {
+            jsonPath = argv[i] + 7;
+        } else if (strncmp(argv[i], "--label=", 8) == 0) {
+            label = argv[i] + 8;
+        } else if (strncmp(argv[i], "--sizes=", 8) == 0) {
+            sizeCount = 0;
+            for (char* next = argv[i] + 8; *next && sizeCount < MAX_SIZES; ) {
+                size_t kib = strtoul(next, &next, 10);
+                if (kib == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                sizes[sizeCount++] = kib << 10;
+                if (*next == ',') next++;
+            }
+        } else if (strncmp(argv[i], "--strides=", 10) == 0) {
+            strideCount = 0;
+            for (char* next = argv[i] + 10; *next && strideCount < MAX_STRIDES; ) {
+                size_t stride = strtoul(next, &next, 10);
+                if (stride == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                strides[strideCount].offset = 0;
+                strides[strideCount++].stride = stride;
+                if (*next == ',') next++;
+            }
+        } else if (strncmp(argv[i], "--reps=", 7) == 0) {
+            reps = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--warmup=", 9) == 0) {
+            warmup = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = atoi(argv[i] + 10);
+        } else if (strncmp(argv[i], "--simd=", 7) == 0) {
+            if (vowelStatsSetSimdLevel(stats, argv[i] + 7) != 0) {
+                fprintf(stderr, "SIMD level '%s' is unknown or not supported by this CPU\n", argv[i] + 7);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--kernel=", 9) == 0 && wantedKernelCount < (int)KERNEL_COUNT) {
+            wantedKernels[wantedKernelCount++] = argv[i] + 9;
+        } else if (strncmp(argv[i], "--input=", 8) == 0 && wantedInputCount < (int)INPUT_COUNT) {
+            wantedInputs[wantedInputCount++] = argv[i] + 8;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            countEvents = 1;
+        } else if (strcmp(argv[i], "--small-pages") == 0) {
+            smallPages = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (reps <= 0 || warmup < 0 || threads <= 0 || sizeCount == 0 || strideCount == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    vowelStatsSetThreads(stats, threads);
+    // The pointer-bump baseline for the sampling kernels
+    VowelStats* bumpStats = vowelStatsClone(stats);
+    if (bumpStats == NULL) {
+        fprintf(stderr, "Failed to allocate the analysis context\n");
+        return 1;
+    }
+    vowelStatsSetPrefetchDistance(bumpStats, 0);
+
+    // Counters follow the calling thread, so they only see all the work at
+    // one thread
+    PerfCounters counters;
+    if (countEvents) {
+        perfCountersOpen(&counters);
+        if (perfCountersNote(&counters) != NULL) {
+            fprintf(stderr, "perf: %d of %d counters available; %s\n", counters.available,
+                    PERF_COUNTER_COUNT, perfCountersNote(&counters));
+        }
+        if (threads > 1) fprintf(stderr, "perf: counters cover the calling thread only\n");
+    }
+
+    size_t maxSize = 0;
+    for (int s = 0; s < sizeCount; s++) maxSize = sizes[s] > maxSize ? sizes[s] : maxSize;
+    char* buf = smallPages ? (char*)malloc(maxSize) : vowelStatsAllocBuffer(maxSize);
+    double* samples = (double*)malloc(reps * sizeof(double));
+    FILE* json = jsonPath ? fopen(jsonPath, "w") : stdout;
+
+    // Cache kernels: one directory each under a fresh temporary one
+    char cacheRoot[] = "/tmp/vowelbench.XXXXXX";
+    char warmDir[sizeof(cacheRoot) + 8], coldDir[sizeof(cacheRoot) + 8], indexPath[sizeof(cacheRoot) + 8];
+    ResultCache* caches[3] = { NULL, NULL, NULL }; // By CacheMode
+    if (mkdtemp(cacheRoot) != NULL) {
+        snprintf(warmDir, sizeof(warmDir), "%s/warm", cacheRoot);
+        snprintf(coldDir, sizeof(coldDir), "%s/cold", cacheRoot);
+        snprintf(indexPath, sizeof(indexPath), "%s/index", cacheRoot);
+        caches[CACHE_WARM] = resultCacheOpen(warmDir, UINT64_MAX);
+        caches[CACHE_COLD] = resultCacheOpen(coldDir, 0);
+    }
+    if (buf == NULL || samples == NULL || json == NULL || caches[CACHE_WARM] == NULL || caches[CACHE_COLD] == NULL) {
+        fprintf(stderr, "Failed to set up the benchmark\n");
+        return 1;
+    }
+
+    fprintf(json, "{\"label\":\"%s\",\"simd\":\"%s\",\"threads\":%d,\"warmup\":%d,\"reps\":%d,"
+            "\"huge_pages\":%s,\"results\":[",
+            label, vowelStatsSimdLevel(stats), threads, warmup, reps, smallPages ? "false" : "true");
+    fprintf(stderr, "%-22s %-8s %9s %12s %12s %8s %8s %8s\n",
+            "kernel", "input", "KiB", "median us", "p95 us", "stddev%", "ns/B", "GB/s");
+
+    int first = 1;
+    for (size_t in = 0; in < INPUT_COUNT; in++) {
+        if (!selected(inputs[in].name, wantedInputs, wantedInputCount)) continue;
+        rngState = 0x5EED0000 + in; // Same bytes on every run
+        inputs[in].fill(buf, maxSize);
+
+        for (int s = 0; s < sizeCount; s++) {
+            for (size_t k = 0; k < KERNEL_COUNT; k++) {
+                if (!selected(kernels[k].name, wantedKernels, wantedKernelCount)) continue;
+                vowelStatsSetPasses(stats, kernels[k].passes);
+                vowelStatsSetFusedBlock(stats, kernels[k].fusedBlock);
+                vowelStatsSetHammingBackend(stats, kernels[k].hamming ? kernels[k].hamming : "unrolled");
+                vowelStatsSetPrefixEngine(stats, kernels[k].prefix ? kernels[k].prefix : "scan");
+                vowelStatsSetHistogramEngine(stats, kernels[k].histogram ? kernels[k].histogram : "split");
+                vowelStatsSetCache(stats, caches[kernels[k].cache]);
+
+                // The single-stride kernels get one cell per stride
+                int perStride = kernels[k].kind == RUN_SAMPLE_BUMP || kernels[k].kind == RUN_SAMPLE_PREFETCH;
+                for (int c = 0; c < (perStride ? strideCount : 1); c++) {
+                    Cell cell = { kernels[k].kind == RUN_SAMPLE_BUMP ? bumpStats : stats, &kernels[k],
+                                  buf, sizes[s], perStride ? &strides[c] : strides,
+                                  perStride ? 1 : strideCount, caches[kernels[k].cache], indexPath, NULL };
+                    SuffixIndex* index = NULL;
+                    if (kernels[k].kind == RUN_INDEX_QUERY) {
+                        if (vowelStatsBuildIndex(stats, buf, sizes[s], indexPath) == 0) {
+                            index = suffixIndexOpen(indexPath);
+                        }
+                        if (index == NULL) {
+                            perror(indexPath);
+                            return 1;
+                        }
+                        cell.index = index;
+                    }
+                    Summary summary;
+                    PerfSample perRun;
+                    ResultCacheCounters lookups;
+                    if (timeKernel(&cell, warmup, reps, samples, &summary,
+                                   countEvents ? &counters : NULL, &perRun, &lookups) != 0) {
+                        fprintf(stderr, "Analysis failed: out of memory\n");
+                        return 1;
+                    }
+                    double nsPerByte = summary.median / sizes[s];
+                    fprintf(json, "%s\n{\"kernel\":\"%s\",\"input\":\"%s\",\"bytes\":%zu,\"median_ns\":%.0f,"
+                            "\"p95_ns\":%.0f,\"mean_ns\":%.0f,\"stddev_ns\":%.0f,\"min_ns\":%.0f,"
+                            "\"ns_per_byte\":%.4f,\"gb_per_s\":%.4f",
+                            first ? "" : ",", kernels[k].name, inputs[in].name, sizes[s], summary.median,
+                            summary.p95, summary.mean, summary.stddev, summary.min, nsPerByte, 1 / nsPerByte);
+
+                    char name[48];
+                    snprintf(name, sizeof(name), "%s", kernels[k].name);
+                    if (kernels[k].kind >= RUN_SAMPLE_BUMP && kernels[k].kind <= RUN_SAMPLE_BATCH) {
+                        uint64_t positions = 0;
+                        for (int i = 0; i < cell.strideCount; i++) {
+                            positions += (sizes[s] + cell.strides[i].stride - 1) / cell.strides[i].stride;
+                        }
+                        if (perStride) {
+                            fprintf(json, ",\"stride\":%zu", cell.strides[0].stride);
+                            snprintf(name, sizeof(name), "%s/%zu", kernels[k].name, cell.strides[0].stride);
+                        } else {
+                            fprintf(json, ",\"strides\":%d", cell.strideCount);
+                        }
+                        fprintf(json, ",\"ns_per_sample\":%.3f", summary.median / positions);
+                    }
+                    char note[48] = "";
+                    if (cell.cache != NULL) {
+                        double hitRate = (double)lookups.hits / (lookups.hits + lookups.misses);
+                        fprintf(json, ",\"cache_hits\":%llu,\"cache_misses\":%llu,\"cache_hit_rate\":%.3f",
+                                (unsigned long long)lookups.hits, (unsigned long long)lookups.misses, hitRate);
+                        snprintf(note, sizeof(note), "  %.0f%% hits", 100 * hitRate);
+                    }
+                    struct stat st;
+                    if (kernels[k].kind == RUN_INDEX_BUILD && stat(indexPath, &st) == 0) {
+                        fprintf(json, ",\"index_bytes\":%lld", (long long)st.st_size);
+                        snprintf(note, sizeof(note), "  %.2f index B/B", (double)st.st_size / sizes[s]);
+                    }
+                    suffixIndexClose(index);
+                    if (countEvents) {
+                        fprintf(json, ",\"counters\":");
+                        perfSamplePrintJson(json, &perRun);
+                    }
+                    fputc('}', json);
+                    fprintf(stderr, "%-22s %-8s %9zu %12.1f %12.1f %8.1f %8.3f %8.3f%s\n",
+                            name, inputs[in].name, sizes[s] >> 10, summary.median / 1e3,
+                            summary.p95 / 1e3, 100 * summary.stddev / summary.mean, nsPerByte, 1 / nsPerByte,
+                            note);
+                    first = 0;
+                }
+            }
+        }
+    }
+    fprintf(json, "\n]}\n");
+
+    if (countEvents) perfCountersClose(&counters);
+    if (json != stdout) fclose(json);
+    for (int c = CACHE_WARM; c <= CACHE_COLD; c++) {
+        resultCacheClear(caches[c]);
+        resultCacheClose(caches[c]);
+    }
+    unlink(indexPath);
+    rmdir(warmDir);
+    rmdir(coldDir);
+    rmdir(cacheRoot);
+    free(samples);
+    if (smallPages) {
+        free(buf);
+    } else {
+        vowelStatsFreeBuffer(buf, maxSize);
+    }
+    vowelStatsFree(bumpStats);
+    vowelStatsFree(stats);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/* cli.h */
+/* The optimized driver's modes (cli_*.c), run by main.c once options are parsed */
+
+#ifndef CLI_H
+#define CLI_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>       // for clock_gettime()
+#include "vowel_stats.h" // for VowelStats, PatternSet, ResultCache
+
+#define DEFAULT_CHUNK_MIB 16   // --stream chunk size
+#define DEFAULT_FUSED_KIB 256  // --fused block size (about one L2)
+#define DEFAULT_CACHE_KIB (64 << 10) // --cache size limit
+
+// What the options configured, shared by every mode
+typedef struct {
+    VowelStats* stats;        // libvowelstats context, configured from the command line
+    PatternSet* patterns;     // --pattern / --pattern-file references, or NULL
+    unsigned reportPasses;    // VOWEL_STATS_DEFAULT, plus VOWEL_STATS_UTF8 with --utf8
+    int showBytes;            // --bytes: the full byte table after the report
+    ResultCache* cache;       // --cache results by content hash, or NULL
+    size_t topMatches;        // --top: the K best Hamming windows after the report
+    int maxMismatches;        // --mismatches: every window within this many, -1 = off
+} Cli;
+
+// Monotonic wall clock for the timings the modes print to stderr
+static inline double secondsNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// ==========================================
+// REPORT (cli_report.c)
+// ==========================================
+
+void printReport(const Cli* cli, const VowelStatsResult* result);
+// --top and --mismatches: searches of their own after the report. Returns -1 if out of memory.
+int printMatchSearches(const Cli* cli, const char* buf, size_t size);
+
+// ==========================================
+// STREAMING (cli_stream.c)
+// ==========================================
+
+// Analyze stdin-like input in fixed-size chunks; memory use is O(chunk), not O(input)
+int runStreaming(const Cli* cli, FILE* input, size_t chunkSize);
+
+// Streams a file with several chunk reads in flight (io_uring, or pread
+// threads where it is unavailable), analyzing each chunk as soon as it lands
+// so the disk and the CPU overlap. `reportIo` prints the achieved rate and
+// the time spent waiting for data to stderr. With a `checkpoint` only what
+// follows the checkpointed bytes is read, and the checkpoint is then updated.
+int runStreamingFile(const Cli* cli, const char* path, size_t chunkSize, const char* backend, int reportIo,
+                     const char* checkpoint);
+
+// ==========================================
+// BATCH (cli_batch.c)
+// ==========================================
+
+// Analyze every file with a fixed pool of `workers` threads and print one
+// JSON record per file, in input order. A directory contributes its regular
+// files (sorted, dotfiles skipped); any other source is a list with one file
+// per line ("-" reads the list from stdin).
+int runBatch(const Cli* cli, const char* source, int workers);
+
+// ==========================================
+// STAGE COUNTERS (cli_perf.c)
+// ==========================================
+
+enum { PERF_OFF, PERF_TABLE, PERF_JSON };
+
+// Runs each stage alone on this thread between counters, then the whole
+// pipeline, whose result is the report. The counters go to stderr as a
+// table or as JSON lines (`output`).
+int analyzeWithCounters(const Cli* cli, int output, char* buf, size_t size, VowelStatsResult* result);
+
+// ==========================================
+// RESULT CACHE (cli_cache.c)
+// ==========================================
+
+// Opens the cache in `dir`, attaches it to the context and closes it at
+// exit, printing its counters to stderr first with `printStats`
+int openCache(Cli* cli, const char* dir, unsigned long long sizeKiB, int printStats);
+
+// ==========================================
+// SUFFIX INDEX (cli_index.c)
+// ==========================================
+
+int buildIndex(const Cli* cli, const char* indexPath, const char* buf, size_t size);
+
+// Every query against the mapped index: the longest prefix of the sequence
+// that occurs (the report's "Longest ... match" line), where, and how often
+// the whole sequence occurs. `queryStats` times each one against a KMP
+// rescan of the indexed text.
+int runQueries(const char* indexPath, const PatternSet* queries, int queryStats);
+
+#endif
@@ -0,0 +1,286 @@
+/* cli_batch.c */
+/* Batch mode: plans files into pool tasks and prints one JSON record per file */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>     // for strcmp(), strdup()
+#include <ctype.h>      // for isspace()
+#include <dirent.h>     // for opendir()
+#include <stdatomic.h>
+#include <sys/mman.h>   // for munmap()
+#include <sys/stat.h>   // for stat()
+#include "cli.h"
+#include "cli_input.h"
+#include "vowel_pool.h"
+
+#define BATCH_PART_BYTES (4 << 20)   // Larger files are split into parts of this size
+#define BATCH_GROUP_BYTES (1 << 20)  // Smaller files are analyzed in runs of about this much
+
+// What the tasks of one runBatch() call share, reached through their argument
+typedef struct {
+    VowelStats** contexts;  // One single-threaded context per worker
+    WorkPool* pool;
+    int cached;             // Whole files go through the context's cache
+} BatchRun;
+
+typedef struct BatchFile BatchFile;
+
+typedef struct {
+    BatchFile* file;
+    int index;
+    int failed;             // Each part its own, folded into the file's by the merge
+} BatchPart;
+
+struct BatchFile {
+    BatchRun* run;
+    char* path;
+    off_t fileSize;           // stat() size, used for planning only
+    int failed;
+    VowelStatsResult result;
+
+    // Split files: parts land in parts[], the last one to finish merges them
+    char* mapping;
+    size_t mapLength;
+    char* data;
+    size_t size;
+    int partCount;
+    _Atomic int partsLeft;
+    BatchPart* partArgs;
+    VowelStatsResult* parts;
+};
+
+typedef struct {
+    BatchFile* files;
+    size_t count;
+} BatchGroup;
+
+// ==========================================
+// TASKS
+// ==========================================
+
+static void analyzeWholeFile(BatchFile* file, int worker) {
+    VowelStats* context = file->run->contexts[worker];
+    size_t mapLength, size;
+    char* data;
+    char* mapping = mapInputFile(file->path, &mapLength, &data, &size);
+    // Small files are whole buffers to the cache; split ones are not cached
+    int status = -1;
+    if (mapping != NULL) {
+        status = file->run->cached ? vowelStatsAnalyze(context, data, size, &file->result)
+                             : vowelStatsAnalyzePart(context, data, size, 0, size, &file->result);
+    }
+    if (status != 0) file->failed = 1;
+    if (mapping != NULL) munmap(mapping, mapLength);
+}
+
+static void batchGroupTask(void* arg, int worker) {
+    BatchGroup* group = (BatchGroup*)arg;
+    for (size_t i = 0; i < group->count; i++) analyzeWholeFile(&group->files[i], worker);
+}
+
+static void batchPartTask(void* arg, int worker) {
+    BatchPart* part = (BatchPart*)arg;
+    BatchFile* file = part->file;
+    size_t first = (size_t)part->index * BATCH_PART_BYTES;
+    size_t last = file->size - first > BATCH_PART_BYTES ? first + BATCH_PART_BYTES : file->size;
+    part->failed = vowelStatsAnalyzePart(file->run->contexts[worker], file->data, file->size, first, last,
+                                         &file->parts[part->index]) != 0;
+    if (atomic_fetch_sub(&file->partsLeft, 1) != 1) return;
+
+    // Last part done: merge in file order and release the mapping
+    file->result = file->parts[0];
+    for (int i = 1; i < file->partCount; i++) vowelStatsMerge(&file->result, &file->parts[i]);
+    for (int i = 0; i < file->partCount; i++) file->failed |= file->partArgs[i].failed;
+    munmap(file->mapping, file->mapLength);
+    free(file->parts);
+    free(file->partArgs);
+}
+
+// Maps a large file and queues its parts on this worker's deque, where idle
+// workers steal them
+static void batchSplitTask(void* arg, int worker) {
+    BatchFile* file = (BatchFile*)arg;
+    file->mapping = mapInputFile(file->path, &file->mapLength, &file->data, &file->size);
+    if (file->mapping == NULL) {
+        file->failed = 1;
+        return;
+    }
+    file->partCount = file->size > 0 ? (int)((file->size + BATCH_PART_BYTES - 1) / BATCH_PART_BYTES) : 1;
+    file->parts = (VowelStatsResult*)malloc(file->partCount * sizeof(VowelStatsResult));
+    file->partArgs = (BatchPart*)malloc(file->partCount * sizeof(BatchPart));
+    if (file->parts == NULL || file->partArgs == NULL) {
+        free(file->parts);
+        free(file->partArgs);
+        munmap(file->mapping, file->mapLength);
+        file->failed = 1;
+        return;
+    }
+    atomic_init(&file->partsLeft, file->partCount);
+    for (int i = 0; i < file->partCount; i++) {
+        file->partArgs[i].file = file;
+        file->partArgs[i].index = i;
+        file->partArgs[i].failed = 0;
+    }
+    // Part 0 runs here; a part the pool cannot queue runs here too
+    for (int i = file->partCount - 1; i > 0; i--) {
+        if (workPoolSubmit(file->run->pool, batchPartTask, &file->partArgs[i]) != 0) {
+            batchPartTask(&file->partArgs[i], worker);
+        }
+    }
+    batchPartTask(&file->partArgs[0], worker);
+}
+
+// ==========================================
+// FILE LIST
+// ==========================================
+
+static int comparePaths(const void* a, const void* b) {
+    return strcmp(((const BatchFile*)a)->path, ((const BatchFile*)b)->path);
+}
+
+static int addBatchFile(BatchFile** files, size_t* count, size_t* capacity, char* path) {
+    if (path == NULL) return -1;
+    if (*count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 64;
+        BatchFile* resized = (BatchFile*)realloc(*files, grown * sizeof(BatchFile));
+        if (resized == NULL) {
+            free(path);
+            return -1;
+        }
+        *files = resized;
+        *capacity = grown;
+    }
+    memset(&(*files)[*count], 0, sizeof(BatchFile));
+    (*files)[(*count)++].path = path;
+    return 0;
+}
+
+static int collectBatchFiles(const char* source, BatchFile** files, size_t* count) {
+    size_t capacity = 0;
+    struct stat st;
+    if (stat(source, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(source);
+        if (dir == NULL) {
+            perror(source);
+            return -1;
+        }
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] == '.') continue;
+            char* path = (char*)malloc(strlen(source) + strlen(entry->d_name) + 2);
+            if (path != NULL) sprintf(path, "%s/%s", source, entry->d_name);
+            struct stat entrySt;
+            if (path != NULL && (stat(path, &entrySt) != 0 || !S_ISREG(entrySt.st_mode))) {
+                free(path);
+                continue;
+            }
+            if (addBatchFile(files, count, &capacity, path) != 0) {
+                closedir(dir);
+                return -1;
+            }
+        }
+        closedir(dir);
+        qsort(*files, *count, sizeof(BatchFile), comparePaths);
+        return 0;
+    }
+
+    FILE* list = strcmp(source, "-") == 0 ? stdin : fopen(source, "r");
+    if (list == NULL) {
+        perror(source);
+        return -1;
+    }
+    char* line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t length;
+    int status = 0;
+    while (status == 0 && (length = getline(&line, &lineCapacity, list)) >= 0) {
+        while (length > 0 && isspace((unsigned char)line[length - 1])) line[--length] = '\0';
+        if (length == 0 || line[0] == '#') continue;
+        status = addBatchFile(files, count, &capacity, strdup(line));
+    }
+    free(line);
+    if (list != stdin) fclose(list);
+    return status;
+}
+
+// ==========================================
+// PLANNER
+// ==========================================
+
+int runBatch(const Cli* cli, const char* source, int workers) {
+    BatchFile* files = NULL;
+    size_t count = 0;
+    if (collectBatchFiles(source, &files, &count) != 0) {
+        fprintf(stderr, "Failed to read the batch file list\n");
+        return 1;
+    }
+
+    BatchRun run;
+    run.pool = workPoolCreate(workers);
+    BatchGroup* groups = (BatchGroup*)malloc((count ? count : 1) * sizeof(BatchGroup));
+    if (run.pool == NULL || groups == NULL) {
+        fprintf(stderr, "Failed to start the batch workers\n");
+        return 1;
+    }
+    workers = workPoolWorkers(run.pool);
+    run.cached = cli->cache != NULL;
+    run.contexts = (VowelStats**)calloc(workers, sizeof(VowelStats*));
+    for (int w = 0; run.contexts != NULL && w < workers; w++) {
+        run.contexts[w] = vowelStatsClone(cli->stats);
+        if (run.contexts[w] == NULL) {
+            fprintf(stderr, "Failed to allocate the analysis context\n");
+            return 1;
+        }
+        vowelStatsSetThreads(run.contexts[w], 1); // Parallelism comes from the pool
+    }
+    if (run.contexts == NULL) {
+        fprintf(stderr, "Failed to allocate the analysis context\n");
+        return 1;
+    }
+
+    // Plan: large files split into parts, runs of small files grouped into one task
+    for (size_t i = 0; i < count; i++) {
+        struct stat st;
+        files[i].run = &run;
+        files[i].fileSize = stat(files[i].path, &st) == 0 ? st.st_size : 0;
+    }
+    size_t groupCount = 0;
+    int status = 0;
+    for (size_t i = 0; i < count && status == 0; ) {
+        if (files[i].fileSize > BATCH_PART_BYTES) {
+            status = workPoolSubmit(run.pool, batchSplitTask, &files[i]);
+            i++;
+            continue;
+        }
+        BatchGroup* group = &groups[groupCount++];
+        group->files = &files[i];
+        group->count = 0;
+        off_t groupBytes = 0;
+        while (i < count && groupBytes < BATCH_GROUP_BYTES && files[i].fileSize <= BATCH_PART_BYTES) {
+            groupBytes += files[i].fileSize;
+            group->count++;
+            i++;
+        }
+        status = workPoolSubmit(run.pool, batchGroupTask, group);
+    }
+    if (status != 0) {
+        fprintf(stderr, "Failed to queue the batch tasks\n");
+        return 1;
+    }
+
+    workPoolRun(run.pool);
+
+    int failures = 0;
+    for (size_t i = 0; i < count; i++) {
+        vowelStatsPrintJson(stdout, files[i].path, files[i].failed ? NULL : &files[i].result, cli->patterns);
+        failures += files[i].failed;
+        free(files[i].path);
+    }
+
+    for (int w = 0; w < workers; w++) vowelStatsFree(run.contexts[w]);
+    free(run.contexts);
+    workPoolFree(run.pool);
+    free(groups);
+    free(files);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,33 @@
+/* cli_cache.c */
+/* --cache: the result cache a run attaches to its context */
+
+#include <stdio.h>
+#include <stdlib.h>     // for atexit()
+#include "cli.h"
+
+static ResultCache* openedCache = NULL; // For the exit handlers
+
+static void printCacheStats(void) {
+    ResultCacheCounters counters;
+    resultCacheCounters(openedCache, &counters);
+    fprintf(stderr, "cache: %llu hits, %llu misses, %llu stores, %llu evictions\n",
+            (unsigned long long)counters.hits, (unsigned long long)counters.misses,
+            (unsigned long long)counters.stores, (unsigned long long)counters.evictions);
+}
+
+static void closeCache(void) {
+    resultCacheClose(openedCache);
+}
+
+int openCache(Cli* cli, const char* dir, unsigned long long sizeKiB, int printStats) {
+    openedCache = resultCacheOpen(dir, sizeKiB << 10);
+    if (openedCache == NULL) {
+        perror(dir);
+        return -1;
+    }
+    cli->cache = openedCache;
+    vowelStatsSetCache(cli->stats, openedCache);
+    atexit(closeCache);
+    if (printStats) atexit(printCacheStats); // Handlers run last registered first
+    return 0;
+}
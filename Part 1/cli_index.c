@@ -0,0 +1,63 @@
+/* cli_index.c */
+/* --build-index and --query: the suffix index of an input, and prefix queries against it */
+
+#include <stdio.h>
+#include <sys/stat.h>   // for stat()
+#include "cli.h"
+
+int buildIndex(const Cli* cli, const char* indexPath, const char* buf, size_t size) {
+    double start = secondsNow();
+    if (vowelStatsBuildIndex(cli->stats, buf, size, indexPath) != 0) {
+        perror(indexPath);
+        return 1;
+    }
+    double seconds = secondsNow() - start;
+    struct stat st;
+    unsigned long long bytes = stat(indexPath, &st) == 0 ? (unsigned long long)st.st_size : 0;
+    printf("Indexed %zu bytes in %.3f s: %s, %llu bytes (%.2f per input byte)\n", size, seconds, indexPath, bytes,
+           size > 0 ? (double)bytes / size : 0.0);
+    return 0;
+}
+
+int runQueries(const char* indexPath, const PatternSet* queries, int queryStats) {
+    SuffixIndex* index = suffixIndexOpen(indexPath);
+    if (index == NULL) {
+        perror(indexPath);
+        return 1;
+    }
+    for (int q = 0; q < patternSetCount(queries); q++) {
+        const char* name = patternSetName(queries, q);
+        size_t length;
+        const char* pattern = patternSetBytes(queries, q, &length);
+
+        uint64_t occurrences, first;
+        double start = secondsNow();
+        size_t longest = suffixIndexLongestPrefix(index, pattern, length, &occurrences, &first);
+        double indexSeconds = secondsNow() - start;
+        printf("Longest %s %s match found: %zu characters\n", name,
+               patternSetIsBuiltin(queries, q) ? "digit" : "prefix", longest);
+        if (longest > 0) {
+            printf("Longest %s match occurrences: %llu, first at index %llu\n", name,
+                   (unsigned long long)occurrences, (unsigned long long)first);
+        }
+        printf("Whole %s occurrences: %llu\n", name, longest == length ? (unsigned long long)occurrences : 0ULL);
+
+        if (queryStats) {
+            PrefixMatcher* matcher = prefixMatcherCreate(pattern, length);
+            if (matcher == NULL) {
+                fprintf(stderr, "Failed to allocate the rescan matcher\n");
+                suffixIndexClose(index);
+                return 1;
+            }
+            start = secondsNow();
+            prefixMatcherFeed(matcher, suffixIndexText(index), suffixIndexTextBytes(index));
+            double rescanSeconds = secondsNow() - start;
+            prefixMatcherFree(matcher);
+            fprintf(stderr, "query %s: %.1f us from the index, %.1f us rescanning %llu bytes (%.0fx)\n", name,
+                    indexSeconds * 1e6, rescanSeconds * 1e6, (unsigned long long)suffixIndexTextBytes(index),
+                    rescanSeconds / (indexSeconds > 0 ? indexSeconds : 1e-9));
+        }
+    }
+    suffixIndexClose(index);
+    return 0;
+}
@@ -0,0 +1,114 @@
+/* cli_input.c */
+/* Size header parsing and input mapping for the command-line drivers */
+
+#include <stdio.h>
+#include <stdint.h>     // for SIZE_MAX
+#include <ctype.h>      // for isspace(), isdigit()
+#include <errno.h>
+#include <fcntl.h>      // for open()
+#include <unistd.h>     // for close(), pread()
+#include <sys/mman.h>   // for mmap(), madvise()
+#include <sys/stat.h>   // for fstat()
+#include "cli_input.h"
+
+int sizeHeaderFeed(SizeHeader* header, unsigned char c) {
+    if (header->phase != 1 && isspace(c)) return 0;
+    if (header->phase < 2 && isdigit(c)) {
+        size_t digit = c - '0';
+        header->value = header->value > (SIZE_MAX - digit) / 10 ? SIZE_MAX : header->value * 10 + digit;
+        header->phase = 1;
+        return 0;
+    }
+    if (header->phase == 0) return -1;
+    if (header->phase == 1 && isspace(c)) {
+        header->phase = 2;
+        return 0;
+    }
+    return 1;
+}
+
+int readStreamHeader(FILE* input, size_t* size) {
+    SizeHeader header = { 0, 0 };
+    int c;
+    while ((c = getc(input)) != EOF) {
+        int status = sizeHeaderFeed(&header, (unsigned char)c);
+        if (status < 0) return -1;
+        if (status > 0) {
+            ungetc(c, input);
+            break;
+        }
+    }
+    *size = header.value;
+    return header.phase > 0 ? 0 : -1; // Input ending inside the header: empty payload
+}
+
+int readSizeHeader(int fd, size_t* size, off_t* payload) {
+    char probe[4096];
+    SizeHeader header = { 0, 0 };
+    for (off_t offset = 0; ; ) {
+        ssize_t got = pread(fd, probe, sizeof(probe), offset);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        for (ssize_t i = 0; i < got; i++) {
+            int status = sizeHeaderFeed(&header, (unsigned char)probe[i]);
+            if (status < 0) return -1;
+            if (status > 0) {
+                *size = header.value;
+                *payload = offset + i;
+                return 0;
+            }
+        }
+        offset += got;
+    }
+    // Input ended inside the header: empty payload
+    if (header.phase == 0) return -1;
+    *size = header.value;
+    *payload = lseek(fd, 0, SEEK_END);
+    return 0;
+}
+
+char* mapInputFile(const char* path, size_t* mapLength, char** data, size_t* dataSize) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "Error reading buffer size\n");
+        close(fd);
+        return NULL;
+    }
+
+    char* base = (char*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps its own reference
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+
+    // The whole file is consumed front to back exactly once
+    madvise(base, st.st_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(base, st.st_size, MADV_HUGEPAGE); // Best effort, ignored where unsupported
+#endif
+
+    char* ptr = base;
+    char* end = base + st.st_size;
+    SizeHeader header = { 0, 0 };
+    int status = 0;
+    while (ptr < end && (status = sizeHeaderFeed(&header, (unsigned char)*ptr)) == 0) ptr++;
+    if (status < 0 || header.phase == 0) {
+        fprintf(stderr, "Error reading buffer size\n");
+        munmap(base, st.st_size);
+        return NULL;
+    }
+
+    // Same truncation rule as the stdin path
+    size_t available = end - ptr;
+    *data = ptr;
+    *dataSize = header.value < available ? header.value : available;
+    *mapLength = st.st_size;
+    return base;
+}
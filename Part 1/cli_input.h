@@ -0,0 +1,36 @@
+/* cli_input.h */
+/* The "<size>\n<payload>" input format, shared by the baseline and optimized drivers */
+
+#ifndef CLI_INPUT_H
+#define CLI_INPUT_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+// The size header as scanf("%zu\n") reads it - optional whitespace, decimal
+// digits, whitespace - fed one byte at a time, so the stdin, mapped and
+// pread paths all parse it alike. Like scanf, values past SIZE_MAX saturate
+// there instead of wrapping.
+typedef struct {
+    int phase;      // 0: leading whitespace, 1: digits, 2: trailing whitespace
+    size_t value;
+} SizeHeader;
+
+// 1 once c is the first payload byte, 0 while the header goes on, -1 if malformed
+int sizeHeaderFeed(SizeHeader* header, unsigned char c);
+
+// The header of a stream, leaving it at the first payload byte. Returns -1 if malformed.
+int readStreamHeader(FILE* input, size_t* size);
+
+// The header through pread, so the file offset of the first payload byte is
+// known. Returns -1 if malformed.
+int readSizeHeader(int fd, size_t* size, off_t* payload);
+
+// Map the input file read-only (zero-copy path). Parses the size header,
+// then points *data at the first payload byte and sets *dataSize with the
+// same truncation rule as the stdin path. Returns the mapping base (to
+// munmap with *mapLength) or NULL on failure, with the error on stderr.
+char* mapInputFile(const char* path, size_t* mapLength, char** data, size_t* dataSize);
+
+#endif
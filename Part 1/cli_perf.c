@@ -0,0 +1,81 @@
+/* cli_perf.c */
+/* --perf: each stage of the analysis alone between hardware counters */
+
+#include <stdio.h>
+#include "cli.h"
+#include "vowel_perf.h"
+
+static const struct {
+    const char* name;
+    unsigned passes;
+} perfStages[] = {
+    { "histogram", VOWEL_STATS_HISTOGRAM },
+    { "pi_prefix", VOWEL_STATS_PI_PREFIX },
+    { "hamming", VOWEL_STATS_HAMMING },
+    { "sparse", VOWEL_STATS_SPARSE },
+    { "patterns", VOWEL_STATS_PATTERNS },
+    { "utf8", VOWEL_STATS_UTF8 },
+    { "pipeline", 0 }, // The passes of the report
+};
+#define PERF_STAGE_COUNT (sizeof(perfStages) / sizeof(perfStages[0]))
+
+static void printCounterCell(const PerfSample* sample, PerfCounterId id) {
+    if (sample->valid[id]) {
+        fprintf(stderr, " %12llu", (unsigned long long)sample->values[id]);
+    } else {
+        fprintf(stderr, " %12s", "-");
+    }
+}
+
+// One thread, so the counters (which follow the calling thread) see all of the work
+int analyzeWithCounters(const Cli* cli, int output, char* buf, size_t size, VowelStatsResult* result) {
+    PerfCounters counters;
+    perfCountersOpen(&counters);
+    const char* note = perfCountersNote(&counters);
+    vowelStatsSetThreads(cli->stats, 1);
+
+    if (output == PERF_TABLE) {
+        fprintf(stderr, "%-10s %9s", "stage", "wall ms");
+        for (int id = 0; id < PERF_COUNTER_COUNT; id++) fprintf(stderr, " %12s", perfCounterName(id));
+        fprintf(stderr, " %6s\n", "ipc");
+    }
+    for (size_t stage = 0; stage < PERF_STAGE_COUNT; stage++) {
+        unsigned passes = perfStages[stage].passes ? perfStages[stage].passes : cli->reportPasses;
+        if ((passes & cli->reportPasses) == 0) continue;
+        if (passes == VOWEL_STATS_PATTERNS && cli->patterns == NULL) continue;
+        vowelStatsSetPasses(cli->stats, passes);
+
+        PerfSample sample;
+        double started = secondsNow();
+        perfCountersStart(&counters);
+        int status = vowelStatsAnalyze(cli->stats, buf, size, result);
+        perfCountersStop(&counters, &sample);
+        double wallNs = (secondsNow() - started) * 1e9;
+        if (status != 0) {
+            perfCountersClose(&counters);
+            return status;
+        }
+
+        if (output == PERF_JSON) {
+            fprintf(stderr, "{\"stage\":\"%s\",\"bytes\":%zu,\"wall_ns\":%.0f,\"counters\":",
+                    perfStages[stage].name, size, wallNs);
+            perfSamplePrintJson(stderr, &sample);
+            fprintf(stderr, "}\n");
+            continue;
+        }
+        fprintf(stderr, "%-10s %9.2f", perfStages[stage].name, wallNs / 1e6);
+        for (int id = 0; id < PERF_COUNTER_COUNT; id++) printCounterCell(&sample, id);
+        if (sample.valid[PERF_CYCLES] && sample.valid[PERF_INSTRUCTIONS] && sample.values[PERF_CYCLES] > 0) {
+            fprintf(stderr, " %6.2f\n", (double)sample.values[PERF_INSTRUCTIONS] / sample.values[PERF_CYCLES]);
+        } else {
+            fprintf(stderr, " %6s\n", "-");
+        }
+    }
+    if (note != NULL && output == PERF_TABLE) {
+        fprintf(stderr, "note: %d of %d counters available; %s\n", counters.available, PERF_COUNTER_COUNT, note);
+    } else if (note != NULL) {
+        fprintf(stderr, "{\"note\":\"%s\",\"available\":%d}\n", note, counters.available);
+    }
+    perfCountersClose(&counters);
+    return 0;
+}
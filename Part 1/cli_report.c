@@ -0,0 +1,42 @@
+/* cli_report.c */
+/* The report every mode of the optimized driver prints */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "cli.h"
+
+void printReport(const Cli* cli, const VowelStatsResult* result) {
+    vowelStatsPrint(stdout, result, cli->patterns);
+    if (cli->showBytes) vowelStatsPrintBytes(stdout, result);
+}
+
+int printMatchSearches(const Cli* cli, const char* buf, size_t size) {
+    if (cli->topMatches > 0) {
+        MismatchHit* hits = (MismatchHit*)malloc(cli->topMatches * sizeof(MismatchHit));
+        size_t count;
+        if (hits == NULL || vowelStatsTopMatches(cli->stats, buf, size, cli->topMatches, hits, &count) != 0) {
+            free(hits);
+            return -1;
+        }
+        for (size_t i = 0; i < count; i++) {
+            printf("Hamming match #%zu: index %llu, score %d/100\n", i + 1,
+                   (unsigned long long)hits[i].index, hits[i].score);
+        }
+        free(hits);
+    }
+    if (cli->maxMismatches >= 0) {
+        MismatchList hits;
+        mismatchListInit(&hits);
+        if (vowelStatsFindMismatches(cli->stats, buf, size, cli->maxMismatches, &hits) != 0) {
+            mismatchListFree(&hits);
+            return -1;
+        }
+        printf("Windows within %d mismatches: %zu\n", cli->maxMismatches, hits.count);
+        for (size_t i = 0; i < hits.count; i++) {
+            printf("Within %d mismatches: index %llu, score %d/100\n", cli->maxMismatches,
+                   (unsigned long long)hits.hits[i].index, hits.hits[i].score);
+        }
+        mismatchListFree(&hits);
+    }
+    return 0;
+}
@@ -0,0 +1,257 @@
+/* cli_stream.c */
+/* Streaming modes: stdin through a double buffer, files through the block reader */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>     // for memcpy()
+#include <fcntl.h>      // for open(), posix_fadvise()
+#include <unistd.h>     // for close(), pread(), access()
+#include <pthread.h>
+#include <sys/stat.h>   // for fstat()
+#include "cli.h"
+#include "cli_input.h"
+#include "vowel_reader.h"
+
+#define STREAM_READ_DEPTH 4    // Chunks in flight when streaming a file
+#define PREFIX_HASH_BLOCK (1 << 20) // Bytes per read when rehashing a checkpointed prefix
+
+// Prepends the tail of the previous window to the `length` fresh bytes (which
+// have STREAM_OVERLAP bytes of headroom in front), analyzes the window, and
+// saves its tail as the next carry
+static void streamWithCarry(VowelStats* stats, char* fresh, size_t length, char* carry, size_t* carryLength) {
+    char* window = fresh - *carryLength;
+    memcpy(window, carry, *carryLength);
+    vowelStatsStreamProcess(stats, window, *carryLength, length);
+
+    size_t windowLength = *carryLength + length;
+    *carryLength = windowLength < STREAM_OVERLAP ? windowLength : STREAM_OVERLAP;
+    memcpy(carry, window + windowLength - *carryLength, *carryLength);
+}
+
+// ==========================================
+// STDIN (Double Buffer)
+// ==========================================
+
+// One half of the double buffer: STREAM_OVERLAP bytes of headroom for the
+// carry from the previous chunk, followed by the chunk itself
+typedef struct {
+    char* data;
+    size_t length;  // Fresh bytes in this slot, 0 marks end of input
+    int full;       // Set by the reader, cleared once analyzed
+} StreamSlot;
+
+typedef struct {
+    FILE* input;
+    size_t remaining;   // Bytes still allowed by the size header
+    size_t chunkSize;
+    StreamSlot slots[2];
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} StreamRing;
+
+// Reader thread: fills the free slot while the main thread analyzes the other
+static void* streamReader(void* arg) {
+    StreamRing* ring = (StreamRing*)arg;
+    for (int i = 0; ; i ^= 1) {
+        StreamSlot* slot = &ring->slots[i];
+
+        pthread_mutex_lock(&ring->lock);
+        while (slot->full) pthread_cond_wait(&ring->changed, &ring->lock);
+        pthread_mutex_unlock(&ring->lock);
+
+        size_t want = ring->remaining < ring->chunkSize ? ring->remaining : ring->chunkSize;
+        size_t got = want > 0 ? fread(slot->data + STREAM_OVERLAP, 1, want, ring->input) : 0;
+        ring->remaining -= got;
+
+        pthread_mutex_lock(&ring->lock);
+        slot->length = got;
+        slot->full = 1;
+        pthread_cond_broadcast(&ring->changed);
+        pthread_mutex_unlock(&ring->lock);
+
+        if (got == 0) return NULL;
+    }
+}
+
+int runStreaming(const Cli* cli, FILE* input, size_t chunkSize) {
+    StreamRing ring;
+    if (readStreamHeader(input, &ring.remaining) != 0) {
+        fprintf(stderr, "Error reading buffer size\n");
+        return 1;
+    }
+    ring.input = input;
+    ring.chunkSize = chunkSize;
+    for (int i = 0; i < 2; i++) {
+        ring.slots[i].data = (char*)malloc(STREAM_OVERLAP + chunkSize);
+        ring.slots[i].full = 0;
+        if (ring.slots[i].data == NULL) {
+            fprintf(stderr, "Failed to allocate buffer of size %zu\n", chunkSize);
+            return 1;
+        }
+    }
+    pthread_mutex_init(&ring.lock, NULL);
+    pthread_cond_init(&ring.changed, NULL);
+
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, streamReader, &ring) != 0) {
+        fprintf(stderr, "Failed to start reader thread\n");
+        return 1;
+    }
+
+    if (vowelStatsStreamBegin(cli->stats) != 0) {
+        fprintf(stderr, "Failed to allocate the stream matchers\n");
+        return 1;
+    }
+    char carry[STREAM_OVERLAP];
+    size_t carryLength = 0;
+    for (int i = 0; ; i ^= 1) {
+        StreamSlot* slot = &ring.slots[i];
+
+        pthread_mutex_lock(&ring.lock);
+        while (!slot->full) pthread_cond_wait(&ring.changed, &ring.lock);
+        pthread_mutex_unlock(&ring.lock);
+        if (slot->length == 0) break;
+
+        // The new tail is saved before the slot goes back to the reader
+        streamWithCarry(cli->stats, slot->data + STREAM_OVERLAP, slot->length, carry, &carryLength);
+
+        pthread_mutex_lock(&ring.lock);
+        slot->full = 0;
+        pthread_cond_broadcast(&ring.changed);
+        pthread_mutex_unlock(&ring.lock);
+    }
+    pthread_join(reader, NULL);
+
+    VowelStatsResult result;
+    vowelStatsStreamEnd(cli->stats, &result);
+    printReport(cli, &result);
+
+    free(ring.slots[0].data);
+    free(ring.slots[1].data);
+    pthread_mutex_destroy(&ring.lock);
+    pthread_cond_destroy(&ring.changed);
+    return 0;
+}
+
+// ==========================================
+// FILES (Block Reader, Checkpoints)
+// ==========================================
+
+// Content hash of payload bytes [0, size), as the hash pass gives for them alone
+static int hashPrefix(int fd, off_t payload, uint64_t size, uint64_t* hash) {
+    char* block = (char*)malloc(PREFIX_HASH_BLOCK);
+    if (block == NULL) return -1;
+    int status = 0;
+    uint64_t done = 0;
+    *hash = 0;
+    while (status == 0 && done < size) {
+        size_t want = size - done < PREFIX_HASH_BLOCK ? (size_t)(size - done) : PREFIX_HASH_BLOCK;
+        ssize_t got = pread(fd, block, want, payload + (off_t)done);
+        size_t words = got > 0 ? (size_t)got / 8 : 0;
+        if (got > 0 && done + (uint64_t)got == size) {
+            *hash += contentHashWords(block, done / 8, words) + contentHashEnd(block + got, size);
+            done = size;
+        } else if (words > 0) {
+            // Whole words only, so the next read starts on a word boundary
+            *hash += contentHashWords(block, done / 8, words);
+            done += 8 * words;
+        } else {
+            status = -1;
+        }
+    }
+    free(block);
+    return status;
+}
+
+// Starts the stream from `checkpoint` when it still describes the front of
+// this input: same options, no longer than the payload, and the payload up
+// to that point hashing as it did (the input only grew at the end). That
+// rereads the old bytes but only hashes them. Otherwise starts over.
+// Returns the payload bytes already analyzed, or -1.
+static long long resumeStream(VowelStats* stats, int fd, off_t payload, size_t size, const char* checkpoint) {
+    uint64_t done;
+    uint64_t prefixHash;
+    if (checkpoint != NULL && vowelStatsStreamResume(stats, checkpoint, &done, &prefixHash) == 0) {
+        uint64_t onDisk;
+        if (done <= size && hashPrefix(fd, payload, done, &onDisk) == 0 && onDisk == prefixHash) {
+            return (long long)done;
+        }
+        fprintf(stderr, "%s: input changed before the checkpointed end, analyzing it all\n", checkpoint);
+    } else if (checkpoint != NULL && access(checkpoint, F_OK) == 0) {
+        fprintf(stderr, "%s: unreadable or written with other options, analyzing it all\n", checkpoint);
+    }
+    return vowelStatsStreamBegin(stats) == 0 ? 0 : -1;
+}
+
+int runStreamingFile(const Cli* cli, const char* path, size_t chunkSize, const char* backend, int reportIo,
+                     const char* checkpoint) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    size_t header;
+    off_t payload;
+    struct stat st;
+    if (readSizeHeader(fd, &header, &payload) != 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "Error reading buffer size\n");
+        close(fd);
+        return 1;
+    }
+    posix_fadvise(fd, payload, 0, POSIX_FADV_SEQUENTIAL);
+
+    // Same truncation rule as the stdin path
+    unsigned long long available = st.st_size > payload ? (unsigned long long)(st.st_size - payload) : 0;
+    size_t size = (size_t)(header < available ? header : available);
+    // The checkpoint records the content hash of what it covers
+    if (checkpoint != NULL) vowelStatsSetPasses(cli->stats, cli->reportPasses | VOWEL_STATS_HASH);
+    long long done = resumeStream(cli->stats, fd, payload, size, checkpoint);
+    if (done < 0) {
+        fprintf(stderr, "Failed to allocate the stream matchers\n");
+        close(fd);
+        return 1;
+    }
+    double started = secondsNow();
+    BlockReader* reader = blockReaderOpen(fd, payload + (off_t)done, size - (size_t)done, chunkSize,
+                                          STREAM_READ_DEPTH, STREAM_OVERLAP, backend);
+    if (reader == NULL) {
+        fprintf(stderr, "Failed to start the %s reader\n", backend ? backend : "block");
+        close(fd);
+        return 1;
+    }
+
+    char carry[STREAM_OVERLAP];
+    size_t carryLength = vowelStatsStreamTail(cli->stats, carry);
+    double waited = 0;
+    ssize_t length;
+    for (;;) {
+        char* data;
+        double asked = secondsNow();
+        length = blockReaderNext(reader, &data);
+        waited += secondsNow() - asked;
+        if (length <= 0) break;
+        streamWithCarry(cli->stats, data, (size_t)length, carry, &carryLength);
+        blockReaderRelease(reader);
+    }
+    double elapsed = secondsNow() - started;
+    const char* used = blockReaderBackend(reader);
+    blockReaderClose(reader);
+    close(fd);
+    if (length < 0) {
+        fprintf(stderr, "Error reading %s\n", path);
+        return 1;
+    }
+
+    if (checkpoint != NULL && vowelStatsStreamSave(cli->stats, checkpoint) != 0) {
+        fprintf(stderr, "%s: failed to write the checkpoint\n", checkpoint);
+    }
+    VowelStatsResult result;
+    vowelStatsStreamEnd(cli->stats, &result);
+    printReport(cli, &result);
+    if (reportIo) {
+        double read = (double)(size - (size_t)done);
+        fprintf(stderr, "read: %s, %.1f MiB in %.3f s = %.2f GB/s, %.3f s waiting for data\n",
+                used, read / 1048576.0, elapsed, elapsed > 0 ? read / elapsed / 1e9 : 0.0, waited);
+    }
+    return 0;
+}
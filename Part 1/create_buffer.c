@@ -0,0 +1,276 @@
+/* create_buffer.c */
+/* Test data generator: "<size>\n" then `size` random characters */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>      // for open()
+#include <unistd.h>     // for write(), ftruncate()
+#include <sys/mman.h>   // for mmap()
+#include <sys/random.h> // for getrandom()
+#include <time.h>       // for time(), the seed fallback
+#include "vowel_patterns.h"
+#include "vowel_pool.h"
+
+// Same distribution as the original create-buffer.py, which indexed its
+// 1052-character pool (vowels, consonants, then the digits 100 times) with
+// one random byte: only the first 256 entries were reachable, so every
+// output byte is pool[random byte] over those 256.
+//
+// The output is cut into fixed blocks, each with its own xoshiro256** stream
+// seeded from (seed, block index), so a seed gives the same bytes whatever
+// the thread count. With --output the blocks are generated straight into a
+// shared mapping of the file; on stdout they go out in large writes.
+
+#define GEN_BLOCK_BYTES (1 << 20)
+#define BLOCKS_PER_WRITE 16        // Per thread, for the stdout path
+#define MAX_PLANTS 64
+#define PI_DIGITS 100
+
+static char charTable[256];
+
+static void initCharTable(void) {
+    const char* vowels = "aeiouAEIOU";
+    const char* consonants = "bcdfghjklmnpqrstvwxyzBCDFGHJKLMNPQRSTVWXYZ";
+    int n = 0;
+    for (const char* c = vowels; *c; c++) charTable[n++] = *c;
+    for (const char* c = consonants; *c; c++) charTable[n++] = *c;
+    for (int d = 0; n < 256; n++, d = (d + 1) % 10) charTable[n] = (char)('0' + d);
+}
+
+// ==========================================
+// PRNG (xoshiro256**, splitmix64 seeding)
+// ==========================================
+
+typedef struct {
+    uint64_t s[4];
+} Xoshiro;
+
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void xoshiroSeed(Xoshiro* rng, uint64_t seed, uint64_t stream) {
+    uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+    for (int i = 0; i < 4; i++) rng->s[i] = splitmix64(&state);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t xoshiroNext(Xoshiro* rng) {
+    uint64_t* s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// ==========================================
+// BLOCKS
+// ==========================================
+
+typedef struct {
+    uint64_t offset; // Payload offset of the first planted digit
+    size_t length;   // Leading digits of pi
+} Plant;
+
+static uint64_t seed;
+static Plant plants[MAX_PLANTS];
+static int plantCount = 0;
+
+typedef struct {
+    char* out;
+    uint64_t index; // Block number within the payload
+    size_t length;
+} BlockJob;
+
+// One block, then any planted digits that fall inside it
+static void generateBlock(void* arg) {
+    BlockJob* job = (BlockJob*)arg;
+    Xoshiro rng;
+    xoshiroSeed(&rng, seed, job->index);
+
+    // Eight output bytes per draw
+    size_t i = 0;
+    for (; i + 8 <= job->length; i += 8) {
+        uint64_t bits = xoshiroNext(&rng);
+        for (int b = 0; b < 8; b++, bits >>= 8) job->out[i + b] = charTable[bits & 0xFF];
+    }
+    for (uint64_t bits = xoshiroNext(&rng); i < job->length; i++, bits >>= 8) {
+        job->out[i] = charTable[bits & 0xFF];
+    }
+
+    uint64_t start = job->index * GEN_BLOCK_BYTES;
+    uint64_t end = start + job->length;
+    for (int p = 0; p < plantCount; p++) {
+        uint64_t first = plants[p].offset > start ? plants[p].offset : start;
+        uint64_t last = plants[p].offset + plants[p].length < end ? plants[p].offset + plants[p].length : end;
+        if (first < last) memcpy(job->out + (first - start), piDigits + (first - plants[p].offset), last - first);
+    }
+}
+
+// Fills out[0..length) with the payload bytes starting at block `firstBlock`
+static void generateRange(JobPool* pool, BlockJob* jobs, char* out, uint64_t firstBlock, size_t length) {
+    size_t count = (length + GEN_BLOCK_BYTES - 1) / GEN_BLOCK_BYTES;
+    JobGroup group;
+    if (pool != NULL) jobGroupInit(&group);
+    for (size_t b = 0; b < count; b++) {
+        jobs[b].out = out + b * GEN_BLOCK_BYTES;
+        jobs[b].index = firstBlock + b;
+        jobs[b].length = b == count - 1 ? length - b * GEN_BLOCK_BYTES : GEN_BLOCK_BYTES;
+        if (pool != NULL) {
+            jobPoolSubmit(pool, &group, generateBlock, &jobs[b]);
+        } else {
+            generateBlock(&jobs[b]);
+        }
+    }
+    if (pool != NULL) {
+        jobPoolWait(pool, &group);
+        jobGroupDestroy(&group);
+    }
+}
+
+static int writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t wrote = write(fd, data, length);
+        if (wrote < 0 && errno == EINTR) continue;
+        if (wrote <= 0) return -1;
+        data += wrote;
+        length -= (size_t)wrote;
+    }
+    return 0;
+}
+
+// ==========================================
+// MAIN
+// ==========================================
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [options] [size]\n", program);
+    fprintf(stderr, "  size                    payload bytes (default 10000000)\n");
+    fprintf(stderr, "  --seed=N                reproducible output (default: random, printed to stderr)\n");
+    fprintf(stderr, "  --threads=N             generator threads (default: online CPUs)\n");
+    fprintf(stderr, "  --output=PATH           write PATH through a shared mapping instead of stdout\n");
+    fprintf(stderr, "  --plant=OFFSET[:LEN]    put the first LEN (default %d) digits of pi at payload\n", PI_DIGITS);
+    fprintf(stderr, "                          OFFSET; repeatable, later plants overwrite earlier ones\n");
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t size = 10000000;
+    const char* outputPath = NULL;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int seeded = 0;
+
+    for (int i = 1; i < argc; i++) {
+        char* end;
+        if (strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = strtoull(argv[i] + 7, &end, 10);
+            if (*end != '\0') {
+                usage(argv[0]);
+                return 1;
+            }
+            seeded = 1;
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = atoi(argv[i] + 10);
+            if (threads <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--output=", 9) == 0) {
+            outputPath = argv[i] + 9;
+        } else if (strncmp(argv[i], "--plant=", 8) == 0 && plantCount < MAX_PLANTS) {
+            Plant* plant = &plants[plantCount++];
+            plant->offset = strtoull(argv[i] + 8, &end, 10);
+            plant->length = *end == ':' ? strtoul(end + 1, &end, 10) : PI_DIGITS;
+            if (*end != '\0' || plant->length == 0 || plant->length > PI_DIGITS) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (argv[i][0] != '-') {
+            size = strtoull(argv[i], &end, 10);
+            if (*end != '\0') {
+                usage(argv[0]);
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    for (int p = 0; p < plantCount; p++) {
+        if (plants[p].offset + plants[p].length > size) {
+            fprintf(stderr, "Plant at %llu does not fit in %llu bytes\n",
+                    (unsigned long long)plants[p].offset, (unsigned long long)size);
+            return 1;
+        }
+    }
+    if (!seeded) {
+        if (getrandom(&seed, sizeof(seed), 0) != sizeof(seed)) seed = (uint64_t)time(NULL) ^ (uint64_t)getpid();
+        fprintf(stderr, "seed: %llu\n", (unsigned long long)seed);
+    }
+    initCharTable();
+
+    // The calling thread helps, so threads - 1 workers
+    JobPool* pool = threads > 1 ? jobPoolCreate(threads - 1) : NULL;
+    char header[32];
+    int headerLength = snprintf(header, sizeof(header), "%llu\n", (unsigned long long)size);
+
+    if (outputPath != NULL) {
+        int fd = open(outputPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, (off_t)(headerLength + size)) != 0) {
+            perror(outputPath);
+            return 1;
+        }
+        char* base = (char*)mmap(NULL, headerLength + size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            perror("mmap");
+            return 1;
+        }
+        size_t blocks = (size + GEN_BLOCK_BYTES - 1) / GEN_BLOCK_BYTES;
+        BlockJob* jobs = (BlockJob*)malloc((blocks ? blocks : 1) * sizeof(BlockJob));
+        if (jobs == NULL) {
+            fprintf(stderr, "Failed to allocate the block table\n");
+            return 1;
+        }
+        memcpy(base, header, headerLength);
+        generateRange(pool, jobs, base + headerLength, 0, size);
+        munmap(base, headerLength + size);
+        free(jobs);
+    } else {
+        size_t batchBlocks = (size_t)threads * BLOCKS_PER_WRITE;
+        char* batch = (char*)malloc(batchBlocks * GEN_BLOCK_BYTES);
+        BlockJob* jobs = (BlockJob*)malloc(batchBlocks * sizeof(BlockJob));
+        if (batch == NULL || jobs == NULL) {
+            fprintf(stderr, "Failed to allocate the output buffer\n");
+            return 1;
+        }
+        int status = writeAll(STDOUT_FILENO, header, headerLength);
+        for (uint64_t done = 0; status == 0 && done < size; ) {
+            size_t length = size - done < batchBlocks * GEN_BLOCK_BYTES ? size - done : batchBlocks * GEN_BLOCK_BYTES;
+            generateRange(pool, jobs, batch, done / GEN_BLOCK_BYTES, length);
+            status = writeAll(STDOUT_FILENO, batch, length);
+            done += length;
+        }
+        free(batch);
+        free(jobs);
+        if (status != 0) {
+            perror("write");
+            return 1;
+        }
+    }
+    jobPoolFree(pool);
+    return 0;
+}
@@ -1,44 +1,365 @@
 /* main.c */
-/* Vowel Counter - Main Program */
+/* Vowel Counter - Main Program (optimized.out): options in, then the mode in cli_*.c */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <ctype.h>      // for isspace()
+#include <sys/mman.h>   // for munmap()
+#include <string.h>     // for strcmp(), memcpy()
+#include "cli.h"
+#include "cli_input.h"
 
-int buffer_size;
+size_t buffer_size;
 
-// External function from vowel_counting.c
-int countVowels(char* buf, int size);
-void printAllStats(int vowelCount);
+// "pi" always names the built-in reference, whose result is the report's own pi line
+static int addCustomPattern(PatternSet* set, const char* name, const char* sequence) {
+    if (strcmp(name, "pi") == 0) return -1;
+    return patternSetAdd(set, name, sequence, strlen(sequence)) < 0 ? -1 : 0;
+}
+
+// --pattern=NAME adds a built-in reference, --pattern=NAME:SEQUENCE a custom one
+static int addPatternArg(PatternSet* set, const char* spec) {
+    const char* colon = strchr(spec, ':');
+    if (colon == NULL) return patternSetAddBuiltin(set, spec) < 0 ? -1 : 0;
+
+    char name[64];
+    size_t nameLength = colon - spec;
+    if (nameLength == 0 || nameLength >= sizeof(name)) return -1;
+    memcpy(name, spec, nameLength);
+    name[nameLength] = '\0';
+    return addCustomPattern(set, name, colon + 1);
+}
+
+// One "NAME SEQUENCE" per line; blank lines and '#' comments are skipped
+static int addPatternFile(PatternSet* set, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return -1;
+    }
+    char* line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    int status = 0;
+    while (status == 0 && (length = getline(&line, &capacity, file)) >= 0) {
+        while (length > 0 && isspace((unsigned char)line[length - 1])) line[--length] = '\0';
+        char* name = line;
+        while (isspace((unsigned char)*name)) name++;
+        if (*name == '\0' || *name == '#') continue;
 
-int main() {
-    // Read buffer size
-    if (scanf("%d\n", &buffer_size) != 1) {
-        fprintf(stderr, "Error reading buffer size\n");
+        char* sequence = name;
+        while (*sequence && !isspace((unsigned char)*sequence)) sequence++;
+        if (*sequence == '\0') {
+            status = -1;
+            break;
+        }
+        *sequence++ = '\0';
+        while (isspace((unsigned char)*sequence)) sequence++;
+        if (addCustomPattern(set, name, sequence) != 0) status = -1;
+    }
+    free(line);
+    fclose(file);
+    return status;
+}
+
+static int analyzeBuffer(const Cli* cli, int perfOutput, char* buf, size_t size) {
+    VowelStatsResult result;
+    int status = perfOutput != PERF_OFF ? analyzeWithCounters(cli, perfOutput, buf, size, &result)
+                                        : vowelStatsAnalyze(cli->stats, buf, size, &result);
+    if (status != 0) {
+        fprintf(stderr, "Failed to allocate analysis scratch memory\n");
         return 1;
     }
+    printReport(cli, &result);
+    if (printMatchSearches(cli, buf, size) != 0) {
+        fprintf(stderr, "Failed to allocate analysis scratch memory\n");
+        return 1;
+    }
+    return 0;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [options] [input-file]\n", program);
+    fprintf(stderr, "  input-file              map the file instead of reading stdin\n");
+    fprintf(stderr, "  --stream[=MiB]          analyze in chunks (default %d MiB) with bounded memory\n", DEFAULT_CHUNK_MIB);
+    fprintf(stderr, "  --reader=BACKEND        stream an input file with io_uring or pread threads\n");
+    fprintf(stderr, "                          (default: io_uring where available)\n");
+    fprintf(stderr, "  --io-stats              print the streaming read rate to stderr\n");
+    fprintf(stderr, "  --checkpoint=PATH       resume from PATH if it covers the start of the input, then\n");
+    fprintf(stderr, "                          save the state there (append-only inputs; implies --stream)\n");
+    fprintf(stderr, "  --fused[=KiB]           one pass over the input in cache-sized blocks (default %d KiB)\n", DEFAULT_FUSED_KIB);
+    fprintf(stderr, "  --batch=DIR|LIST        analyze every file in DIR, or listed one per line in LIST (- = stdin);\n");
+    fprintf(stderr, "                          prints one JSON record per file\n");
+    fprintf(stderr, "  --perf[=json]           time each stage alone on one thread with hardware counters\n");
+    fprintf(stderr, "                          (cycles, IPC, cache/branch/dTLB misses) on stderr\n");
+    fprintf(stderr, "  --threads=N             worker threads for the histogram and Hamming passes, or the batch\n");
+    fprintf(stderr, "                          workers (default: online CPUs)\n");
+    fprintf(stderr, "  --simd=LEVEL            scalar, sse2, avx2 or avx512 kernels (default: best supported)\n");
+    fprintf(stderr, "  --hamming=ENGINE        unrolled (default), bitset, template or qgram Hamming search\n");
+    fprintf(stderr, "  --top=K                 also list the K best Hamming windows (the report's match is #1)\n");
+    fprintf(stderr, "  --mismatches=K          also list every window within K mismatches of pi\n");
+    fprintf(stderr, "  --prefix=ENGINE         scan (default), kmp or template longest pi prefix search\n");
+    fprintf(stderr, "  --histogram=ENGINE      split (default) or unrolled byte histogram\n");
+    fprintf(stderr, "  --pattern=NAME[:SEQ]    also report the longest match of pi, e, sqrt2 or a custom sequence\n");
+    fprintf(stderr, "  --pattern-file=PATH     add \"NAME SEQUENCE\" lines from PATH\n");
+    fprintf(stderr, "  --utf8                  also decode the input as UTF-8: code points, invalid sequences,\n");
+    fprintf(stderr, "                          scripts and accented vowels\n");
+    fprintf(stderr, "  --bytes                 also print the count of every byte value and byte class\n");
+    fprintf(stderr, "  --cache=DIR             reuse results of identical inputs, stored in DIR (whole-buffer\n");
+    fprintf(stderr, "                          and batch modes)\n");
+    fprintf(stderr, "  --cache-size=KiB        evict least recently used results past this size (default %d KiB)\n", DEFAULT_CACHE_KIB);
+    fprintf(stderr, "  --cache-stats           print cache hits, misses and evictions to stderr\n");
+    fprintf(stderr, "  --build-index=PATH      write a suffix array of the input to PATH instead of the report\n");
+    fprintf(stderr, "                          (inputs under 2 GiB)\n");
+    fprintf(stderr, "  --index=PATH            answer --query from an index built earlier, without an input\n");
+    fprintf(stderr, "  --query=NAME[:SEQ]      longest prefix and occurrences of pi, e, sqrt2 or a custom\n");
+    fprintf(stderr, "                          sequence in the index (repeatable)\n");
+    fprintf(stderr, "  --query-stats           print each query's latency against a rescan to stderr\n");
+}
 
-    // Dynamically allocate buffer
-    char* buffer = (char*)malloc(buffer_size);
-    if (buffer == NULL) {
-        fprintf(stderr, "Failed to allocate buffer of size %d\n", buffer_size);
+int main(int argc, char* argv[]) {
+    Cli cli = { 0 };
+    cli.reportPasses = VOWEL_STATS_DEFAULT;
+    cli.maxMismatches = -1;
+    const char* path = NULL;
+    const char* batchSource = NULL;
+    size_t chunkMiB = 0; // 0 = whole-buffer mode
+    const char* readerBackend = NULL; // NULL = io_uring, falling back to pread
+    int reportIo = 0;
+    const char* checkpoint = NULL;
+    int perfOutput = PERF_OFF;
+    const char* cacheDir = NULL;
+    unsigned long long cacheKiB = DEFAULT_CACHE_KIB;
+    int cacheStats = 0;
+    int searchOptions = 0; // --top or --mismatches
+    const char* indexPath = NULL; // --build-index writes it, --index opens it
+    int buildsIndex = 0;
+    PatternSet* queries = NULL;   // --query sequences answered from the index
+    int queryStats = 0;
+    int threads = 0;     // 0 = online CPUs
+    cli.stats = vowelStatsCreate();
+    if (cli.stats == NULL) {
+        fprintf(stderr, "Failed to allocate the analysis context\n");
         return 1;
     }
 
-    // Read the buffer content
-    int bytesRead = fread(buffer, 1, buffer_size, stdin);
-    if (bytesRead < buffer_size) {
-        // Fill remaining with what we got
-        buffer_size = bytesRead;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream") == 0) {
+            chunkMiB = DEFAULT_CHUNK_MIB;
+        } else if (strncmp(argv[i], "--stream=", 9) == 0) {
+            chunkMiB = strtoul(argv[i] + 9, NULL, 10);
+            if (chunkMiB == 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--reader=", 9) == 0) {
+            readerBackend = argv[i] + 9;
+            if (strcmp(readerBackend, "io_uring") != 0 && strcmp(readerBackend, "pread") != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--io-stats") == 0) {
+            reportIo = 1;
+        } else if (strncmp(argv[i], "--checkpoint=", 13) == 0 && argv[i][13] != '\0') {
+            checkpoint = argv[i] + 13;
+        } else if (strcmp(argv[i], "--fused") == 0 || strncmp(argv[i], "--fused=", 8) == 0) {
+            size_t blockKiB = argv[i][7] == '=' ? strtoul(argv[i] + 8, NULL, 10) : DEFAULT_FUSED_KIB;
+            if (blockKiB == 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            vowelStatsSetFusedBlock(cli.stats, blockKiB << 10);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            threads = atoi(argv[i] + 10);
+            if (threads <= 0) {
+                usage(argv[0]);
+                return 1;
+            }
+            vowelStatsSetThreads(cli.stats, threads);
+        } else if (strcmp(argv[i], "--perf") == 0 || strcmp(argv[i], "--perf=json") == 0) {
+            perfOutput = argv[i][6] == '=' ? PERF_JSON : PERF_TABLE;
+        } else if (strncmp(argv[i], "--batch=", 8) == 0) {
+            batchSource = argv[i] + 8;
+        } else if (strncmp(argv[i], "--simd=", 7) == 0) {
+            if (vowelStatsSetSimdLevel(cli.stats, argv[i] + 7) != 0) {
+                fprintf(stderr, "SIMD level '%s' is unknown or not supported by this CPU\n", argv[i] + 7);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--hamming=", 10) == 0) {
+            if (vowelStatsSetHammingBackend(cli.stats, argv[i] + 10) != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--prefix=", 9) == 0) {
+            if (vowelStatsSetPrefixEngine(cli.stats, argv[i] + 9) != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--histogram=", 12) == 0) {
+            if (vowelStatsSetHistogramEngine(cli.stats, argv[i] + 12) != 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--pattern=", 10) == 0 || strncmp(argv[i], "--pattern-file=", 15) == 0) {
+            if (cli.patterns == NULL) cli.patterns = patternSetCreate();
+            int status = argv[i][9] == '='
+                ? addPatternArg(cli.patterns, argv[i] + 10)
+                : addPatternFile(cli.patterns, argv[i] + 15);
+            if (status != 0) {
+                fprintf(stderr, "Invalid pattern: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--utf8") == 0) {
+            cli.reportPasses |= VOWEL_STATS_UTF8;
+            vowelStatsSetPasses(cli.stats, cli.reportPasses);
+        } else if (strcmp(argv[i], "--bytes") == 0) {
+            cli.showBytes = 1;
+        } else if (strncmp(argv[i], "--top=", 6) == 0 || strncmp(argv[i], "--mismatches=", 13) == 0) {
+            int top = argv[i][5] == '=';
+            char* end;
+            long long value = strtoll(argv[i] + (top ? 6 : 13), &end, 10);
+            if (end == argv[i] + (top ? 6 : 13) || *end != '\0' || value < (top ? 1 : 0)) {
+                usage(argv[0]);
+                return 1;
+            }
+            searchOptions = 1;
+            if (top) {
+                cli.topMatches = (size_t)value;
+            } else {
+                cli.maxMismatches = value < VOWEL_STATS_PI_LENGTH ? (int)value : VOWEL_STATS_PI_LENGTH - 1;
+            }
+        } else if (strncmp(argv[i], "--cache=", 8) == 0 && argv[i][8] != '\0') {
+            cacheDir = argv[i] + 8;
+        } else if (strncmp(argv[i], "--cache-size=", 13) == 0) {
+            char* end;
+            cacheKiB = strtoull(argv[i] + 13, &end, 10);
+            if (end == argv[i] + 13 || *end != '\0') {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cache-stats") == 0) {
+            cacheStats = 1;
+        } else if ((strncmp(argv[i], "--build-index=", 14) == 0 && argv[i][14] != '\0') ||
+                   (strncmp(argv[i], "--index=", 8) == 0 && argv[i][8] != '\0')) {
+            buildsIndex = argv[i][2] == 'b';
+            indexPath = strchr(argv[i], '=') + 1;
+        } else if (strncmp(argv[i], "--query=", 8) == 0) {
+            if (queries == NULL) queries = patternSetCreate();
+            if (addPatternArg(queries, argv[i] + 8) != 0) {
+                fprintf(stderr, "Invalid query: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--query-stats") == 0) {
+            queryStats = 1;
+        } else if (argv[i][0] == '-' || path != NULL) {
+            usage(argv[0]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
     }
 
-    // Count vowels
-    int count = countVowels(buffer, buffer_size);
+    if (cli.patterns != NULL) {
+        if (patternSetBuild(cli.patterns) != 0) {
+            fprintf(stderr, "Failed to build the pattern automaton\n");
+            return 1;
+        }
+        if (vowelStatsSetPatternSet(cli.stats, cli.patterns) != 0) {
+            fprintf(stderr, "At most %d patterns are supported\n", VOWEL_STATS_MAX_PATTERNS);
+            return 1;
+        }
+    }
 
-    // Print all statistics
-    printAllStats(count);
-    
-    // Free buffer
-    free(buffer);
+    if ((readerBackend != NULL || reportIo || checkpoint != NULL) && chunkMiB == 0) chunkMiB = DEFAULT_CHUNK_MIB;
+    if (perfOutput != PERF_OFF && chunkMiB > 0) {
+        fprintf(stderr, "--perf measures whole-buffer analysis; drop --stream\n");
+        return 1;
+    }
 
-    return 0;
+    if (searchOptions && (chunkMiB > 0 || batchSource != NULL)) {
+        fprintf(stderr, "--top and --mismatches search a whole buffer; drop --stream and --batch\n");
+        return 1;
+    }
+
+    if (indexPath != NULL || queries != NULL || queryStats) {
+        if (indexPath == NULL || (!buildsIndex && (queries == NULL || path != NULL))) {
+            fprintf(stderr, "--query needs --index=PATH (and no input) or --build-index=PATH\n");
+            return 1;
+        }
+        if (chunkMiB > 0 || batchSource != NULL || cacheDir != NULL || searchOptions || perfOutput != PERF_OFF) {
+            fprintf(stderr, "--build-index indexes a whole buffer; drop --stream, --batch, --cache, --perf, "
+                            "--top and --mismatches\n");
+            return 1;
+        }
+        if (!buildsIndex) return runQueries(indexPath, queries, queryStats);
+    }
+
+    if (cacheDir != NULL) {
+        if (chunkMiB > 0 || perfOutput != PERF_OFF) {
+            fprintf(stderr, "--cache applies to whole-buffer and batch analysis; drop --stream and --perf\n");
+            return 1;
+        }
+        if (openCache(&cli, cacheDir, cacheKiB, cacheStats) != 0) return 1;
+    }
+
+    if (batchSource != NULL) {
+        if (path != NULL || chunkMiB > 0 || perfOutput != PERF_OFF || cli.showBytes || checkpoint != NULL) {
+            usage(argv[0]);
+            return 1;
+        }
+        return runBatch(&cli, batchSource, threads);
+    }
+
+    if (chunkMiB > 0) {
+        if (path != NULL) return runStreamingFile(&cli, path, chunkMiB << 20, readerBackend, reportIo, checkpoint);
+        if (checkpoint != NULL) {
+            fprintf(stderr, "--checkpoint needs an input file, not stdin\n");
+            return 1;
+        }
+        return runStreaming(&cli, stdin, chunkMiB << 20);
+    }
+
+    // File argument: map the input instead of copying it to the heap
+    char* buffer;
+    char* mapping = NULL;
+    size_t mapLength = 0;
+    size_t allocated = 0;
+    if (path != NULL) {
+        mapping = mapInputFile(path, &mapLength, &buffer, &buffer_size);
+        if (mapping == NULL) return 1;
+    } else {
+        // Read buffer size
+        if (readStreamHeader(stdin, &buffer_size) != 0) {
+            fprintf(stderr, "Error reading buffer size\n");
+            return 1;
+        }
+
+        // Dynamically allocate buffer (huge pages where the input spans them)
+        allocated = buffer_size;
+        buffer = vowelStatsAllocBuffer(allocated);
+        if (buffer == NULL) {
+            fprintf(stderr, "Failed to allocate buffer of size %zu\n", buffer_size);
+            return 1;
+        }
+
+        // Read the buffer content
+        size_t bytesRead = fread(buffer, 1, buffer_size, stdin);
+        if (bytesRead < buffer_size) {
+            // Fill remaining with what we got
+            buffer_size = bytesRead;
+        }
+    }
+
+    // Count vowels and print all statistics (or index them)
+    int status = buildsIndex ? buildIndex(&cli, indexPath, buffer, buffer_size)
+                             : analyzeBuffer(&cli, perfOutput, buffer, buffer_size);
+    if (status == 0 && queries != NULL) status = runQueries(indexPath, queries, queryStats);
+
+    // Free buffer
+    if (mapping != NULL) {
+        munmap(mapping, mapLength);
+    } else {
+        vowelStatsFreeBuffer(buffer, allocated);
+    }
+    return status;
 }
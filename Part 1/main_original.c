@@ -0,0 +1,60 @@
+/* main_original.c */
+/* Vowel Counter - Baseline Driver (original.out, with vowel_counting_original.c) */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>   // for munmap()
+#include "vowel_counting.h"
+#include "cli_input.h"
+
+size_t buffer_size;
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "Usage: %s [input-file]\n", argv[0]);
+        fprintf(stderr, "  The options of optimized.out are not available in the baseline build\n");
+        return 1;
+    }
+
+    // File argument: map the input instead of copying it to the heap
+    if (argc == 2) {
+        size_t mapLength;
+        char* data;
+        char* mapping = mapInputFile(argv[1], &mapLength, &data, &buffer_size);
+        if (mapping == NULL) return 1;
+        printAllStats(countVowels(data, buffer_size));
+        munmap(mapping, mapLength);
+        return 0;
+    }
+
+    // Read buffer size
+    if (readStreamHeader(stdin, &buffer_size) != 0) {
+        fprintf(stderr, "Error reading buffer size\n");
+        return 1;
+    }
+
+    // Dynamically allocate buffer
+    char* buffer = (char*)malloc(buffer_size);
+    if (buffer == NULL) {
+        fprintf(stderr, "Failed to allocate buffer of size %zu\n", buffer_size);
+        return 1;
+    }
+
+    // Read the buffer content
+    size_t bytesRead = fread(buffer, 1, buffer_size, stdin);
+    if (bytesRead < buffer_size) {
+        // Fill remaining with what we got
+        buffer_size = bytesRead;
+    }
+
+    // Count vowels (the original prints from inside countVowels() too)
+    uint64_t count = countVowels(buffer, buffer_size);
+
+    // Print all statistics
+    printAllStats(count);
+
+    // Free buffer
+    free(buffer);
+
+    return 0;
+}
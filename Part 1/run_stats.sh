@@ -1,12 +1,13 @@
 #!/bin/bash
 
 # run_stats.sh - Compare original vs optimized vowel counting
+# (one end-to-end run each; `make bench` has the repeated per-kernel timings)
 
 # 1. Check if the user provided the mode (optional)
 if [ "$#" -gt 1 ]; then
     echo "Usage: ./run_stats.sh [mode]"
     echo "  mode: 'optimized' (run optimized only) or 'both' (default: both)"
-    echo "  Always runs on input.txt"
+    echo "  Always runs on input.txt (./create_buffer.out SIZE > input.txt makes one)"
     exit 1
 fi
 
@@ -27,7 +28,7 @@ if [ "$MODE" = "both" ]; then
     echo "Compiling with vowel_counting_original.c..."
 
     # 3. Compile original version
-    gcc -O0 main.c vowel_counting_original.c -o original.out
+    make original
 
     # 4. Run with nanosecond precision timing
     START_ORIG=$(date +%s%N)
@@ -49,7 +50,7 @@ fi
 echo "Compiling with vowel_counting.c..."
 
 # 8. Compile optimized version
-gcc -O0 main.c vowel_counting.c -o optimized.out
+make optimized
 
 # 9. Run with nanosecond precision timing
 START_OPT=$(date +%s%N)
@@ -187,4 +188,4 @@ fi
 rm -f original.out optimized.out
 
 
-cd "/Users/mayerunterberg/Documents/Tirgul CA/hw5/vowel_count" && python3 create-buffer.py 1000000 > input_1mb.txt && ./run_stats.sh input_1mb.txt
\ No newline at end of file
+# Example: make create_buffer.out && ./create_buffer.out 1000000 > input.txt && ./run_stats.sh
\ No newline at end of file
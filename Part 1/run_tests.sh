@@ -0,0 +1,317 @@
+#!/bin/bash
+
+# run_tests.sh - Correctness checks for the optimized vowel counter
+#
+# Usage: ./run_tests.sh [large]
+#   (default) compare every optimized.out mode against original.out on a small input
+#   large     additionally run a > 2 GiB input through optimized.out
+
+set -e
+
+MODE=${1:-quick}
+SMALL_SIZE=1500000          # Spans two 1 MiB stream chunks; original.out needs ~1s per MiB
+LARGE_REPEATS=1440          # 1440 x 1.5 MB = ~2.01 GiB, past INT_MAX
+SMALL="temp_test_small.txt"
+TIE="temp_test_tie.txt"
+LARGE="temp_test_large.txt"
+FAILED=0
+
+check() {
+    # check <description> <expected> <actual>
+    if [ "$2" == "$3" ]; then
+        echo "✓ $1"
+    else
+        echo "✗ $1"
+        echo "  expected: $2"
+        echo "  actual:   $3"
+        FAILED=1
+    fi
+}
+
+# 1. Small input: optimized must match the baseline byte for byte
+./create_buffer.out $SMALL_SIZE --seed=20240501 > "$SMALL"
+EXPECTED=$(./original.out < "$SMALL")
+check "stdin path matches original" "$EXPECTED" "$(./optimized.out < "$SMALL")"
+check "mmap path matches original" "$EXPECTED" "$(./optimized.out "$SMALL")"
+check "stream path matches original" "$EXPECTED" "$(./optimized.out --stream=1 < "$SMALL")"
+check "io_uring stream reader matches original" "$EXPECTED" "$(./optimized.out --stream=1 --reader=io_uring "$SMALL")"
+check "pread stream reader matches original" "$EXPECTED" "$(./optimized.out --stream=1 --reader=pread "$SMALL")"
+check "fused pipeline matches original" "$EXPECTED" "$(./optimized.out --fused "$SMALL")"
+check "fused pipeline with tiny blocks" "$EXPECTED" "$(./optimized.out --fused=1 "$SMALL")"
+check "threaded histogram matches original" "$EXPECTED" "$(./optimized.out --threads=3 "$SMALL")"
+check "per-stage counters leave the report unchanged" "$EXPECTED" "$(./optimized.out --perf "$SMALL" 2>/dev/null)"
+for LEVEL in scalar sse2 avx2 avx512; do
+    if ./optimized.out --simd=$LEVEL "$SMALL" > temp_simd_output.txt 2> /dev/null; then
+        check "$LEVEL kernels match original" "$EXPECTED" "$(cat temp_simd_output.txt)"
+    else
+        echo "- $LEVEL kernels not supported on this CPU, skipped"
+    fi
+done
+rm -f temp_simd_output.txt
+check "bitset Hamming backend matches original" "$EXPECTED" "$(./optimized.out --hamming=bitset "$SMALL")"
+check "unrolled histogram engine matches original" "$EXPECTED" "$(./optimized.out --histogram=unrolled "$SMALL")"
+# One byte value far past the 16-bit split counters, then a ragged tail
+RUNS_COUNTS=$(python3 -c 'import sys; d = "a" * 700001 + "7" * 300000 + "xE"; sys.stdout.write("%d\n%s" % (len(d), d))' |
+    ./optimized.out --threads=1 | grep "^Vowel count:")
+check "split histogram counts long runs" "Vowel count: 700002, Letters: [(a,700001), (e,1), (x,1)], Digits: [(7,300000)]" \
+    "$RUNS_COUNTS"
+check "KMP prefix engine matches original" "$EXPECTED" "$(./optimized.out --prefix=kmp "$SMALL")"
+check "template engines match original" "$EXPECTED" \
+    "$(./optimized.out --hamming=template --prefix=template --threads=3 "$SMALL")"
+check "KMP prefix engine while streaming" "$EXPECTED" "$(./optimized.out --prefix=kmp --stream=1 "$SMALL")"
+# Starts within 99 bytes of the end: the baseline counts the prefix cut short
+# there, on an input shorter than pi and on one whose best prefix is in its tail
+for PAYLOAD in "ab31415926535897932384626433832795028841971" \
+               "$(printf 'x%.0s' $(seq 90))314159265358979323846264338327950288419716939937510582097494459230781640"; do
+    (echo ${#PAYLOAD}; echo -n "$PAYLOAD") > temp_short.txt
+    SHORT_EXPECTED=$(./original.out < temp_short.txt)
+    for ENGINE in "--prefix=scan" "--prefix=kmp" "--prefix=template" "--prefix=template --threads=3" \
+                  "--prefix=template --stream=1" "--stream=1" "--fused=1" "--pattern=pi"; do
+        check "tail prefix, ${#PAYLOAD} bytes, $ENGINE" "$SHORT_EXPECTED" "$(./optimized.out $ENGINE temp_short.txt)"
+    done
+done
+rm -f temp_short.txt
+# The pi reference is the report's own line, not a second copy of it
+PI_LINE=$(echo "$EXPECTED" | grep "^Longest pi")
+check "pattern set agrees on pi" "$PI_LINE" \
+    "$(./optimized.out --pattern=pi --pattern=e --pattern=custom:0123 "$SMALL" | grep "^Longest pi")"
+check "only the built-in references are digit matches" "Longest e digit match found
+Longest custom prefix match found" \
+    "$(./optimized.out --pattern=e --pattern=custom:0123 "$SMALL" | grep -E "^Longest (e|custom)" | cut -d: -f1)"
+check "custom pattern cannot be named pi" "Invalid pattern: --pattern=pi:0123" \
+    "$(./optimized.out --pattern=pi:0123 "$SMALL" 2>&1)"
+
+# A size header past SIZE_MAX - 4 MiB cannot be rounded up to huge pages
+check "oversized stdin header refused" "Failed to allocate buffer of size 18446744073709551615" \
+    "$(printf '18446744073709551615\nabc' | ./optimized.out 2>&1)"
+
+# A header past SIZE_MAX saturates as scanf's does: a mapped or streamed file
+# is analyzed in full rather than wrapping to a few bytes
+printf '36893488147419103235\n1234567890aeiou' > temp_header.txt
+check "saturated header, mapped" "Vowel count: 5" "$(./optimized.out temp_header.txt | grep -o "^Vowel count: [0-9]*")"
+check "saturated header, streamed" "Vowel count: 5" \
+    "$(./optimized.out --stream temp_header.txt | grep -o "^Vowel count: [0-9]*")"
+rm -f temp_header.txt
+# UTF-8 statistics: a mix of scripts plus a stray byte, a truncated 3-byte
+# sequence and a lead byte cut off by the end (3 U+FFFD, as Python's decoder gives)
+printf 'caf\xc3\xa9 na\xc3\xafve \xc3\x9cnter \xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xe4\xb8\xad\xe6\x96\x87 \xf0\x9f\x98\x80 \xff\xe2\x82 ok\xc3' > temp_utf8_payload.txt
+(stat -c %s temp_utf8_payload.txt; cat temp_utf8_payload.txt) > temp_utf8.txt
+check "UTF-8 code points and scripts" "UTF-8 code points: 32, Invalid sequences: 3, By length: [(1,20), (2,9), (3,2), (4,1)]
+Scripts: [(ascii,20), (latin,3), (cyrillic,6), (cjk,2), (symbol,1)], Accented vowels: [(e,1), (i,1), (u,1)]" \
+    "$(./optimized.out --utf8 temp_utf8.txt | grep -A1 "^UTF-8")"
+UTF8_EXPECTED=$(./optimized.out --utf8 --bytes temp_utf8.txt)
+check "UTF-8 split across threads" "$UTF8_EXPECTED" "$(./optimized.out --utf8 --bytes --threads=4 temp_utf8.txt)"
+check "UTF-8 split across stream chunks" "$UTF8_EXPECTED" "$(./optimized.out --utf8 --bytes --stream=1 < temp_utf8.txt)"
+check "byte table adds up to the input" "$(stat -c %s temp_utf8_payload.txt)" \
+    "$(./optimized.out --bytes temp_utf8.txt | awk '/^Bytes 0x/ { for (i = 3; i <= NF; i++) n += $i } END { print n }')"
+rm -f temp_utf8.txt temp_utf8_payload.txt
+SMALL_UTF8=$(./optimized.out --utf8 "$SMALL")
+check "UTF-8 pass leaves the default report unchanged" "$EXPECTED" "$(echo "$SMALL_UTF8" | grep -v -E "^(UTF-8|Scripts)")"
+check "UTF-8 pass in the fused pipeline" "$SMALL_UTF8" "$(./optimized.out --utf8 --fused=1 --threads=3 "$SMALL")"
+
+# Checkpoints: the input grows at the end between runs, and each run reads
+# only the new bytes yet reports what a full run over the file so far would
+rm -f temp_checkpoint temp_growing.txt
+head -n 1 "$SMALL" > temp_growing.txt
+tail -c $SMALL_SIZE "$SMALL" > temp_payload.txt
+GROWN=0
+for CUT in 600000 600050 1100000 $SMALL_SIZE; do
+    head -c $CUT temp_payload.txt | tail -c $((CUT - GROWN)) >> temp_growing.txt
+    GROWN=$CUT
+    CHECKPOINTED=$(./optimized.out --checkpoint=temp_checkpoint --utf8 temp_growing.txt)
+done
+check "checkpointed runs match a full run" "$(./optimized.out --utf8 "$SMALL")" "$CHECKPOINTED"
+check "rerun with nothing appended" "$CHECKPOINTED" \
+    "$(./optimized.out --checkpoint=temp_checkpoint --utf8 temp_growing.txt 2>&1)"
+# A byte rewritten far before the checkpointed end, with the tail unchanged
+{ head -n 1 "$SMALL"; printf 'X'; tail -c $((SMALL_SIZE - 1)) "$SMALL"; } > temp_growing.txt
+check "rewritten front is analyzed in full" "$(./optimized.out --utf8 temp_growing.txt)" \
+    "$(./optimized.out --checkpoint=temp_checkpoint --utf8 temp_growing.txt 2>/dev/null)"
+printf 'VSTATCK1' > temp_checkpoint
+check "checkpoint of an older format is refused" \
+    "temp_checkpoint: unreadable or written with other options, analyzing it all" \
+    "$(./optimized.out --checkpoint=temp_checkpoint temp_growing.txt 2>&1 >/dev/null)"
+rm -f temp_checkpoint temp_growing.txt temp_payload.txt
+
+# Result cache: a rerun on the same bytes is served from the cache, with the
+# same report however the input arrives. Entries are 3000 bytes, so 7 KiB
+# holds two and a third evicts the least recently used.
+rm -rf temp_cache
+./optimized.out --cache=temp_cache "$SMALL" > /dev/null
+check "cached rerun matches a full run" "$EXPECTED" \
+    "$(./optimized.out --cache=temp_cache --cache-stats --threads=3 < "$SMALL" 2> temp_cache_stats.txt)"
+check "cached rerun is a hit" "cache: 1 hits, 0 misses, 0 stores, 0 evictions" "$(cat temp_cache_stats.txt)"
+check "other options miss" "cache: 0 hits, 1 misses, 1 stores, 0 evictions" \
+    "$(./optimized.out --cache=temp_cache --cache-stats --utf8 "$SMALL" 2>&1 >/dev/null)"
+check "other engines miss" "cache: 0 hits, 1 misses, 1 stores, 0 evictions" \
+    "$(./optimized.out --cache=temp_cache --cache-stats --prefix=kmp "$SMALL" 2>&1 >/dev/null)"
+rm -rf temp_cache
+check "fused miss matches a full run" "$EXPECTED" \
+    "$(./optimized.out --cache=temp_cache --cache-stats --fused=1 "$SMALL" 2> temp_cache_stats.txt)"
+check "fused miss runs and stores" "cache: 0 hits, 1 misses, 1 stores, 0 evictions" "$(cat temp_cache_stats.txt)"
+check "fused rerun is a hit" "$EXPECTED" "$(./optimized.out --cache=temp_cache --fused=1 "$SMALL")"
+rm -f temp_cache_stats.txt
+rm -rf temp_cache
+for SEED in 1 2 3; do ./create_buffer.out 5000 --seed=$SEED > temp_cache_$SEED.txt; done
+CACHE_LOG=$(for SEED in 1 2 1 3 1 2; do
+    ./optimized.out --cache=temp_cache --cache-size=7 --cache-stats temp_cache_$SEED.txt 2>&1 >/dev/null
+done)
+check "cache evicts the least recently used" "cache: 0 hits, 1 misses, 1 stores, 0 evictions
+cache: 0 hits, 1 misses, 1 stores, 0 evictions
+cache: 1 hits, 0 misses, 0 stores, 0 evictions
+cache: 0 hits, 1 misses, 1 stores, 1 evictions
+cache: 1 hits, 0 misses, 0 stores, 0 evictions
+cache: 0 hits, 1 misses, 1 stores, 1 evictions" "$CACHE_LOG"
+rm -rf temp_cache temp_cache_*.txt
+
+# Generated data is a function of the seed alone, and planted digits land where asked
+check "generator output independent of threads" "$(./create_buffer.out 3000000 --seed=5 --threads=1 | cksum)" \
+    "$(./create_buffer.out 3000000 --seed=5 --threads=4 | cksum)"
+check "planted pi found at its offset" "Longest pi digit match found: 100 characters
+Best index: 654321" "$(./create_buffer.out 1000000 --seed=9 --plant=654321 --plant=900000:60 | ./optimized.out |
+    grep -E "^(Longest pi|Best index)")"
+
+# 2. Equal Hamming scores planted in different shards: the lowest index must win
+python3 - "$SMALL" > "$TIE" <<'PY'
+import sys
+size, data = open(sys.argv[1]).read().split("\n", 1)
+window = "31415926535897932384626433832795028841971693993751" + "x" * 50
+for offset in (1200000, 700000, 300):
+    data = data[:offset] + window + data[offset + 100:]
+print(size)
+sys.stdout.write(data)
+PY
+TIE_EXPECTED=$(./original.out < "$TIE" | grep "^Best index")
+check "sharded Hamming tie-break" "$TIE_EXPECTED" "$(./optimized.out --threads=4 "$TIE" | grep "^Best index")"
+check "sharded bitset tie-break" "$TIE_EXPECTED" \
+    "$(./optimized.out --threads=4 --hamming=bitset "$TIE" | grep "^Best index")"
+check "sharded template tie-break" "$TIE_EXPECTED" \
+    "$(./optimized.out --threads=4 --hamming=template "$TIE" | grep "^Best index")"
+check "sharded q-gram tie-break" "$TIE_EXPECTED" \
+    "$(./optimized.out --threads=4 --hamming=qgram "$TIE" | grep "^Best index")"
+check "top-1 match is the best match" "$(./original.out < "$TIE" | grep "^Best index" | sed 's/Best index: //')" \
+    "$(./optimized.out --threads=4 --top=1 "$TIE" | grep "^Hamming match #1" | sed 's/.*index \([0-9]*\),.*/\1/')"
+
+# Near copies of pi with 1, 3, 3 and 6 digits changed: top-K and threshold
+# searches must list them in score then index order, whatever the threads
+NEAR="temp_near.txt"
+python3 - "$SMALL" > "$NEAR" <<'PY'
+import sys
+size, data = open(sys.argv[1]).read().split("\n", 1)
+pi = "3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067"
+for offset, changes in ((1200000, (5, 50, 95)), (700000, (0, 1, 2)), (300, (9, 19, 29, 39, 49, 59)), (50000, (70,))):
+    window = "".join("x" if i in changes else c for i, c in enumerate(pi))
+    data = data[:offset] + window + data[offset + 100:]
+print(size)
+sys.stdout.write(data)
+PY
+NEAR_EXPECTED="Hamming match #1: index 50000, score 99/100
+Hamming match #2: index 700000, score 97/100
+Hamming match #3: index 1200000, score 97/100
+Hamming match #4: index 300, score 94/100
+Windows within 3 mismatches: 3
+Within 3 mismatches: index 50000, score 99/100
+Within 3 mismatches: index 700000, score 97/100
+Within 3 mismatches: index 1200000, score 97/100"
+for THREADS in 1 4; do
+    check "top-K and k-mismatch search ($THREADS threads)" "$NEAR_EXPECTED" \
+        "$(./optimized.out --threads=$THREADS --top=4 --mismatches=3 "$NEAR" | grep -E "^(Hamming match|Within|Windows)")"
+done
+check "k-mismatch search past the q-gram filter" "Windows within 20 mismatches: 4" \
+    "$(./optimized.out --mismatches=20 "$NEAR" | grep "^Windows")"
+check "q-gram engine finds the near match" "Best index: 50000
+Hamming score: 99/100 matches" "$(./optimized.out --hamming=qgram "$NEAR" | grep -E "^(Best index|Hamming score)")"
+
+# Suffix index: the same file whatever the threads, and queries that answer
+# what a rescan of the input reports
+PI_DIGITS=3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067
+./optimized.out --threads=1 --build-index=temp_index_1.idx "$SMALL" > /dev/null
+./optimized.out --threads=4 --build-index=temp_index_4.idx "$SMALL" > /dev/null
+check "suffix index independent of threads" "$(cksum < temp_index_1.idx)" "$(cksum < temp_index_4.idx)"
+check "index pi query matches the report" "$PI_LINE" \
+    "$(./optimized.out --index=temp_index_4.idx --query=pi | grep "^Longest pi digit")"
+check "index queries match the pattern set" \
+    "$(./optimized.out --pattern=e --pattern=sqrt2 "$SMALL" | grep -E "^Longest (e|sqrt2) digit")" \
+    "$(./optimized.out --index=temp_index_4.idx --query=e --query=sqrt2 | grep "^Longest [a-z0-9]* digit")"
+# Its best pi prefix is cut short by the end of the input
+(echo 162; printf 'x%.0s' $(seq 90); echo -n "${PI_DIGITS:0:72}") > temp_short.txt
+./optimized.out --build-index=temp_index_short.idx temp_short.txt > /dev/null
+check "index pi query on a tail prefix" "$(./original.out < temp_short.txt | grep "^Longest pi")" \
+    "$(./optimized.out --index=temp_index_short.idx --query=pi | grep "^Longest pi digit")"
+rm -f temp_short.txt
+./optimized.out --build-index=temp_index_near.idx "$NEAR" > /dev/null
+check "index finds every occurrence" "Longest head prefix match found: 30 characters
+Longest head match occurrences: 1, first at index 50000
+Whole head occurrences: 1
+Longest copy prefix match found: 100 characters
+Longest copy match occurrences: 1, first at index 700000
+Whole copy occurrences: 1" "$(./optimized.out --index=temp_index_near.idx --query=head:$(cut -c 1-30 <<< "$PI_DIGITS") \
+    --query=copy:xxx$(cut -c 4-100 <<< "$PI_DIGITS"))"
+check "--index takes no input file" "--query needs --index=PATH (and no input) or --build-index=PATH" \
+    "$(./optimized.out --index=temp_index_near.idx --query=pi "$NEAR" 2>&1)"
+rm -f temp_index_*.idx
+
+# 3. Batch mode: one JSON record per file with the numbers a single run prints.
+#    The third file is over 4 MiB, so its parts are spread across the workers.
+BATCH_DIR="temp_batch"
+mkdir -p "$BATCH_DIR"
+cp "$SMALL" "$BATCH_DIR/a.txt"
+cp "$TIE" "$BATCH_DIR/b.txt"
+python3 - "$SMALL" > "$BATCH_DIR/c.txt" <<'PY'
+import sys
+size, data = open(sys.argv[1]).read().split("\n", 1)
+print(len(data) * 3)
+sys.stdout.write(data * 3)
+PY
+summary() {
+    grep -E "^(Longest pi|Best index|Hamming score|Positions checked|Count of|Vowels at|Digits at|Vowel count)"
+}
+BATCH_EXPECTED=$(for FILE in "$BATCH_DIR"/*.txt; do ./optimized.out "$FILE" | summary; done)
+BATCH_ACTUAL=$(./optimized.out --threads=4 --batch="$BATCH_DIR" | python3 -c '
+import json, sys
+for line in sys.stdin:
+    r = json.loads(line)
+    s = r["sparse"]
+    print("Longest pi digit match found: %d characters" % r["longest_pi"])
+    print("Best index: %d" % r["hamming_index"])
+    print("Hamming score: %d/100 matches" % r["hamming_score"])
+    print("Positions checked: %d" % s["positions"])
+    print("Count of \x273\x27 at addresses divisible by 1000: %d" % s["count3"])
+    print("Vowels at sparse addresses: %d" % s["vowels"])
+    print("Digits at sparse addresses: %d" % s["digits"])
+    letters = ", ".join("(%s,%d)" % (chr(97 + i), n) for i, n in enumerate(r["letters"]) if n)
+    digits = ", ".join("(%d,%d)" % (i, n) for i, n in enumerate(r["digits"]) if n)
+    print("Vowel count: %d, Letters: [%s], Digits: [%s]" % (r["vowels"], letters, digits))
+')
+check "batch records match single runs" "$BATCH_EXPECTED" "$BATCH_ACTUAL"
+rm -rf temp_cache
+./optimized.out --threads=4 --batch="$BATCH_DIR" --cache=temp_cache > /dev/null
+check "cached batch rerun" "$(./optimized.out --threads=4 --batch="$BATCH_DIR")" \
+    "$(./optimized.out --threads=4 --batch="$BATCH_DIR" --cache=temp_cache --cache-stats 2> temp_cache_stats.txt)"
+check "batch hits all but the split file" "cache: 2 hits, 0 misses, 0 stores, 0 evictions" \
+    "$(cat temp_cache_stats.txt)"
+rm -rf temp_cache temp_cache_stats.txt
+rm -rf "$BATCH_DIR" "$TIE" "$NEAR"
+
+# 4. Large input: the small payload repeated until the size no longer fits an int.
+#    Every histogram count must scale by exactly LARGE_REPEATS.
+if [ "$MODE" = "large" ]; then
+    LARGE_SIZE=$((SMALL_SIZE * LARGE_REPEATS))
+    echo "$LARGE_SIZE" > "$LARGE"
+    tail -c $SMALL_SIZE "$SMALL" > temp_payload.txt
+    for ((i = 0; i < LARGE_REPEATS; i++)); do cat temp_payload.txt; done >> "$LARGE"
+    rm -f temp_payload.txt
+
+    OUTPUT=$(./optimized.out "$LARGE")
+
+    SMALL_STATS=$(echo "$EXPECTED" | grep "^Vowel count:")
+    SCALED=$(echo "$SMALL_STATS" | python3 -c "import re, sys; print(re.sub(r'(count: |,)(\d+)(?=[,)])',
+        lambda m: m.group(1) + str(int(m.group(2)) * $LARGE_REPEATS), sys.stdin.read().strip()))")
+    check "large histogram scales with repeats" "$SCALED" "$(echo "$OUTPUT" | grep "^Vowel count:")"
+    check "large sparse positions" "Positions checked: $(( (LARGE_SIZE + 999) / 1000 ))" \
+        "$(echo "$OUTPUT" | grep "^Positions checked:")"
+    rm -f "$LARGE"
+fi
+
+rm -f "$SMALL"
+exit $FAILED
@@ -0,0 +1,130 @@
+/* vowel_bitset.c */
+/* Hamming scores as a cross-correlation of per-symbol bitmaps */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vowel_bitset.h"
+
+// For every distinct symbol of the pattern we build a bitmap of the buffer
+// (bit i set when buf[first + i] is that symbol). The matches of pattern
+// position k for 64 consecutive starts are then one shifted word of the
+// bitmap of pattern[k], so a block of 64 starts is scored by adding
+// `length` words into bit-sliced counters: plane j holds bit j of all 64
+// scores. Comparing the counters against the bound is also bit-sliced, so
+// a block is only unpacked when some lane actually beats it.
+
+#define MAX_PLANES 32
+
+struct BitsetScanner {
+    const char* pattern;
+    size_t length;
+    int planes;                 // Bits needed to hold a score of `length`
+    int symbols;                // Distinct bytes in the pattern
+    int16_t slotOf[256];        // Bitmap index per byte value, -1 if unused
+    size_t words;               // Words per bitmap
+    uint64_t* bitmaps;          // symbols x words
+    const uint64_t** rowOf;     // Bitmap of pattern[k], for k < length
+};
+
+BitsetScanner* bitsetScannerCreate(const char* pattern, size_t length) {
+    BitsetScanner* scanner = (BitsetScanner*)calloc(1, sizeof(BitsetScanner));
+    if (scanner == NULL) return NULL;
+
+    scanner->pattern = pattern;
+    scanner->length = length;
+    while (scanner->planes < MAX_PLANES && (length >> scanner->planes) != 0) scanner->planes++;
+
+    for (int c = 0; c < 256; c++) scanner->slotOf[c] = -1;
+    for (size_t k = 0; k < length; k++) {
+        unsigned char c = (unsigned char)pattern[k];
+        if (scanner->slotOf[c] < 0) scanner->slotOf[c] = (int16_t)scanner->symbols++;
+    }
+
+    // One spare word so a shifted read at the last bit never runs off the end
+    scanner->words = (BITSET_MAX_SPAN + length + 63) / 64 + 1;
+    scanner->bitmaps = (uint64_t*)malloc(scanner->symbols * scanner->words * sizeof(uint64_t));
+    scanner->rowOf = (const uint64_t**)malloc(length * sizeof(uint64_t*));
+    if (scanner->bitmaps == NULL || scanner->rowOf == NULL) {
+        bitsetScannerFree(scanner);
+        return NULL;
+    }
+    for (size_t k = 0; k < length; k++) {
+        scanner->rowOf[k] = scanner->bitmaps + scanner->slotOf[(unsigned char)pattern[k]] * scanner->words;
+    }
+    return scanner;
+}
+
+void bitsetScannerFree(BitsetScanner* scanner) {
+    if (scanner == NULL) return;
+    free(scanner->bitmaps);
+    free(scanner->rowOf);
+    free(scanner);
+}
+
+// 64 bits of `row` starting at bit `bit`
+static uint64_t bitsAt(const uint64_t* row, size_t bit) {
+    size_t word = bit >> 6;
+    unsigned shift = bit & 63;
+    if (shift == 0) return row[word];
+    return (row[word] >> shift) | (row[word + 1] << (64 - shift));
+}
+
+// Lanes whose bit-sliced counter is strictly greater than `bound`
+static uint64_t lanesAbove(const uint64_t* plane, int planes, int bound) {
+    if (bound >= (1 << planes)) return 0;
+    uint64_t greater = 0;
+    uint64_t equal = ~0ULL;
+    for (int j = planes - 1; j >= 0; j--) {
+        if ((bound >> j) & 1) {
+            equal &= plane[j];
+        } else {
+            greater |= equal & plane[j];
+            equal &= ~plane[j];
+        }
+    }
+    return greater;
+}
+
+int bitsetBestScore(BitsetScanner* scanner, const char* buf, size_t first, size_t last,
+                    int bound, size_t* offset) {
+    size_t span = last - first;
+    size_t bytes = span + scanner->length - 1;
+    int planes = scanner->planes;
+
+    // 1. Bitmaps of the bytes these starts can touch
+    memset(scanner->bitmaps, 0, scanner->symbols * scanner->words * sizeof(uint64_t));
+    for (size_t i = 0; i < bytes; i++) {
+        int slot = scanner->slotOf[(unsigned char)buf[first + i]];
+        if (slot >= 0) scanner->bitmaps[slot * scanner->words + (i >> 6)] |= 1ULL << (i & 63);
+    }
+
+    // 2. Score 64 starts at a time
+    for (size_t lane0 = 0; lane0 < span; lane0 += 64) {
+        uint64_t plane[MAX_PLANES] = {0};
+        for (size_t k = 0; k < scanner->length; k++) {
+            uint64_t carry = bitsAt(scanner->rowOf[k], lane0 + k);
+            for (int j = 0; carry != 0 && j < planes; j++) {
+                uint64_t next = plane[j] & carry;
+                plane[j] ^= carry;
+                carry = next;
+            }
+        }
+
+        uint64_t valid = (span - lane0 >= 64) ? ~0ULL : (1ULL << (span - lane0)) - 1;
+        uint64_t above = lanesAbove(plane, planes, bound) & valid;
+
+        // 3. Unpack only the lanes that beat the bound, lowest offset first
+        while (above != 0) {
+            int lane = __builtin_ctzll(above);
+            above &= above - 1;
+            int score = 0;
+            for (int j = 0; j < planes; j++) score |= (int)((plane[j] >> lane) & 1) << j;
+            if (score > bound) {
+                bound = score;
+                *offset = first + lane0 + lane;
+            }
+        }
+    }
+    return bound;
+}
@@ -0,0 +1,23 @@
+/* vowel_bitset.h */
+/* Bit-parallel Hamming backend: scores 64 start offsets per word operation */
+
+#ifndef VOWEL_BITSET_H
+#define VOWEL_BITSET_H
+
+#include <stddef.h>
+
+#define BITSET_MAX_SPAN 4096 // Start offsets one call may score
+
+typedef struct BitsetScanner BitsetScanner;
+
+// Scanner for one pattern; holds its scratch bitmaps, so use one per thread
+BitsetScanner* bitsetScannerCreate(const char* pattern, size_t length);
+void bitsetScannerFree(BitsetScanner* scanner);
+
+// Scores start offsets [first, last) of buf (last - first <= BITSET_MAX_SPAN,
+// each start reads `length` bytes). Returns the highest score above `bound`
+// and stores its lowest offset in *offset; returns `bound` if nothing beats it.
+int bitsetBestScore(BitsetScanner* scanner, const char* buf, size_t first, size_t last,
+                    int bound, size_t* offset);
+
+#endif
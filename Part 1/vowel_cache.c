@@ -0,0 +1,288 @@
+/* vowel_cache.c */
+/* Content hash of an input, and an on-disk cache of results keyed by it */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>   // for memcpy, memcmp
+#include <errno.h>
+#include <fcntl.h>    // for open()
+#include <unistd.h>   // for read(), write(), unlink()
+#include <dirent.h>   // for opendir()
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>     // for clock_gettime()
+#include <sys/stat.h> // for mkdir(), futimens()
+#include "vowel_cache.h"
+
+// ==========================================
+// CONTENT HASH
+// ==========================================
+
+uint64_t contentHashWords(const char* words, uint64_t firstWord, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t word;
+        memcpy(&word, words + 8 * i, 8);
+        sum += CONTENT_HASH_TERM(word, firstWord + i);
+    }
+    return sum;
+}
+
+uint64_t contentHashRange(const char* buf, uint64_t offset, size_t size) {
+    uint64_t firstWord = offset / 8;
+    return contentHashWords(buf - offset % 8, firstWord, (offset + size) / 8 - firstWord);
+}
+
+uint64_t contentHashEnd(const char* end, uint64_t size) {
+    size_t partial = size % 8;
+    if (partial == 0) return 0;
+    uint64_t word = 0;
+    memcpy(&word, end - partial, partial);
+    return CONTENT_HASH_TERM(word, size / 8);
+}
+
+// ==========================================
+// RESULT CACHE
+// ==========================================
+
+// Entry file: "<16 hex digits>.vsr" holding a header and the value. The name
+// is a mix of the key, the header the key itself, so two keys that share a
+// name only cost each other a miss.
+#define CACHE_MAGIC "VSCACHE1"
+#define CACHE_SUFFIX ".vsr"
+#define CACHE_NAME_LENGTH (16 + sizeof(CACHE_SUFFIX) - 1)
+
+typedef struct {
+    char magic[8];
+    ResultCacheKey key;
+    uint64_t valueBytes;
+} CacheHeader;
+
+struct ResultCache {
+    char* dir;
+    uint64_t maxBytes;
+    pthread_mutex_t lock;   // Guards bytes and the eviction scan
+    uint64_t bytes;         // Entry bytes in the directory, as of the last scan plus stores since
+    _Atomic uint64_t hits;
+    _Atomic uint64_t misses;
+    _Atomic uint64_t stores;
+    _Atomic uint64_t evictions;
+    _Atomic uint64_t temporaries; // Names for entries being written
+};
+
+// splitmix64 finalizer over the key fields
+static uint64_t mixKey(const ResultCacheKey* key) {
+    uint64_t z = key->contentHash ^ (key->size * 0x9E3779B97F4A7C15ULL) ^ (key->options << 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// dir/<name>; the caller frees it
+static char* entryPath(const ResultCache* cache, const char* name) {
+    size_t dirLength = strlen(cache->dir);
+    size_t nameLength = strlen(name);
+    char* path = (char*)malloc(dirLength + nameLength + 2);
+    if (path == NULL) return NULL;
+    memcpy(path, cache->dir, dirLength);
+    path[dirLength] = '/';
+    memcpy(path + dirLength + 1, name, nameLength + 1);
+    return path;
+}
+
+static char* keyPath(const ResultCache* cache, const ResultCacheKey* key) {
+    char name[CACHE_NAME_LENGTH + 1];
+    snprintf(name, sizeof(name), "%016llx" CACHE_SUFFIX, (unsigned long long)mixKey(key));
+    return entryPath(cache, name);
+}
+
+static int isEntryName(const char* name) {
+    size_t length = strlen(name);
+    return length == CACHE_NAME_LENGTH && strcmp(name + 16, CACHE_SUFFIX) == 0;
+}
+
+// Stamps the file as used now. Explicit times keep the nanoseconds (the
+// kernel's own stamps move in timer ticks), so uses a moment apart still
+// order correctly.
+static void touchEntry(int fd) {
+    struct timespec times[2];
+    clock_gettime(CLOCK_REALTIME, &times[0]);
+    times[1] = times[0];
+    futimens(fd, times);
+}
+
+typedef struct {
+    char name[CACHE_NAME_LENGTH + 1];
+    struct timespec used;
+    uint64_t bytes;
+} CacheEntry;
+
+static int compareEntries(const void* a, const void* b) {
+    const struct timespec* x = &((const CacheEntry*)a)->used;
+    const struct timespec* y = &((const CacheEntry*)b)->used;
+    if (x->tv_sec != y->tv_sec) return x->tv_sec < y->tv_sec ? -1 : 1;
+    return (x->tv_nsec > y->tv_nsec) - (x->tv_nsec < y->tv_nsec);
+}
+
+// Lists the entries, then unlinks the least recently used until the rest
+// fit in maxBytes. Sets cache->bytes to what is left. Caller holds the lock.
+static void evictEntries(ResultCache* cache, uint64_t maxBytes) {
+    DIR* dir = opendir(cache->dir);
+    if (dir == NULL) return;
+
+    CacheEntry* entries = NULL;
+    size_t count = 0, capacity = 0;
+    uint64_t total = 0;
+    struct dirent* dirent;
+    while ((dirent = readdir(dir)) != NULL) {
+        if (!isEntryName(dirent->d_name)) continue;
+        char* path = entryPath(cache, dirent->d_name);
+        struct stat st;
+        int found = path != NULL && stat(path, &st) == 0;
+        free(path);
+        if (!found) continue; // Evicted by someone else meanwhile
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            CacheEntry* grown = (CacheEntry*)realloc(entries, capacity * sizeof(CacheEntry));
+            if (grown == NULL) break;
+            entries = grown;
+        }
+        memcpy(entries[count].name, dirent->d_name, CACHE_NAME_LENGTH + 1);
+        entries[count].used = st.st_mtim;
+        entries[count].bytes = st.st_size;
+        total += st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    qsort(entries, count, sizeof(CacheEntry), compareEntries);
+    for (size_t i = 0; i < count && total > maxBytes; i++) {
+        char* path = entryPath(cache, entries[i].name);
+        if (path != NULL && unlink(path) == 0) atomic_fetch_add(&cache->evictions, 1);
+        free(path);
+        total -= entries[i].bytes;
+    }
+    free(entries);
+    cache->bytes = total;
+}
+
+ResultCache* resultCacheOpen(const char* dir, uint64_t maxBytes) {
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) return NULL;
+    ResultCache* cache = (ResultCache*)calloc(1, sizeof(ResultCache));
+    if (cache == NULL) return NULL;
+    cache->dir = strdup(dir);
+    if (cache->dir == NULL) {
+        free(cache);
+        return NULL;
+    }
+    cache->maxBytes = maxBytes;
+    pthread_mutex_init(&cache->lock, NULL);
+
+    // Learn the size already there, trimming it if the limit shrank
+    pthread_mutex_lock(&cache->lock);
+    evictEntries(cache, maxBytes);
+    pthread_mutex_unlock(&cache->lock);
+    atomic_store(&cache->evictions, 0);
+    return cache;
+}
+
+void resultCacheClose(ResultCache* cache) {
+    if (cache == NULL) return;
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->dir);
+    free(cache);
+}
+
+static int readFully(int fd, void* buf, size_t size) {
+    for (size_t done = 0; done < size; ) {
+        ssize_t got = read(fd, (char*)buf + done, size - done);
+        if (got <= 0) return -1;
+        done += got;
+    }
+    return 0;
+}
+
+static int writeFully(int fd, const void* buf, size_t size) {
+    for (size_t done = 0; done < size; ) {
+        ssize_t put = write(fd, (const char*)buf + done, size - done);
+        if (put <= 0) return -1;
+        done += put;
+    }
+    return 0;
+}
+
+int resultCacheLoad(ResultCache* cache, const ResultCacheKey* key, void* value, size_t size) {
+    char* path = keyPath(cache, key);
+    int fd = path != NULL ? open(path, O_RDONLY) : -1;
+    free(path);
+
+    // Read into scratch first, so a damaged entry never reaches `value`
+    CacheHeader header;
+    void* scratch = fd >= 0 ? malloc(size) : NULL;
+    int status = scratch != NULL && readFully(fd, &header, sizeof(header)) == 0 ? 0 : -1;
+    if (status == 0 && (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+                        memcmp(&header.key, key, sizeof(*key)) != 0 || header.valueBytes != size ||
+                        readFully(fd, scratch, size) != 0)) {
+        status = -1;
+    }
+    if (status == 0) {
+        memcpy(value, scratch, size);
+        touchEntry(fd);
+    }
+    free(scratch);
+    if (fd >= 0) close(fd);
+    atomic_fetch_add(status == 0 ? &cache->hits : &cache->misses, 1);
+    return status;
+}
+
+int resultCacheStore(ResultCache* cache, const ResultCacheKey* key, const void* value, size_t size) {
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.key = *key;
+    header.valueBytes = size;
+
+    // Written under a name no other writer uses (or that eviction would
+    // touch), then renamed into place
+    char temporary[64];
+    snprintf(temporary, sizeof(temporary), ".tmp-%ld-%llu", (long)getpid(),
+             (unsigned long long)atomic_fetch_add(&cache->temporaries, 1));
+    char* temporaryPath = entryPath(cache, temporary);
+    char* path = keyPath(cache, key);
+    int fd = temporaryPath != NULL && path != NULL ? open(temporaryPath, O_WRONLY | O_CREAT | O_TRUNC, 0666)
+                                                  : -1;
+    int status = fd >= 0 ? 0 : -1;
+    if (status == 0) {
+        if (writeFully(fd, &header, sizeof(header)) != 0 || writeFully(fd, value, size) != 0) status = -1;
+        touchEntry(fd);
+        if (close(fd) != 0) status = -1;
+    }
+    if (status == 0 && rename(temporaryPath, path) != 0) status = -1;
+    if (status != 0 && fd >= 0) unlink(temporaryPath);
+    free(temporaryPath);
+    free(path);
+    if (status != 0) return -1;
+
+    atomic_fetch_add(&cache->stores, 1);
+    pthread_mutex_lock(&cache->lock);
+    cache->bytes += sizeof(header) + size;
+    if (cache->bytes > cache->maxBytes) evictEntries(cache, cache->maxBytes);
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+}
+
+void resultCacheClear(ResultCache* cache) {
+    pthread_mutex_lock(&cache->lock);
+    uint64_t evictions = atomic_load(&cache->evictions);
+    evictEntries(cache, 0);
+    atomic_store(&cache->evictions, evictions); // Not evictions: nothing was over the limit
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void resultCacheCounters(const ResultCache* cache, ResultCacheCounters* counters) {
+    counters->hits = atomic_load(&cache->hits);
+    counters->misses = atomic_load(&cache->misses);
+    counters->stores = atomic_load(&cache->stores);
+    counters->evictions = atomic_load(&cache->evictions);
+}
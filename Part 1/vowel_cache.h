@@ -0,0 +1,84 @@
+/* vowel_cache.h */
+/* Content hash of an input, and an on-disk cache of results keyed by it */
+
+#ifndef VOWEL_CACHE_H
+#define VOWEL_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================
+// CONTENT HASH
+// ==========================================
+
+// Word k of the input (bytes 8k..8k+7, the last one zero-padded) adds
+// mum(word ^ S0, k ^ S1) to the hash: the 64x64->128 multiply folded to 64
+// bits that wyhash and XXH3 mix with. The terms do not depend on each other,
+// so pieces of an input hash separately and their sums add up to the hash of
+// the whole - the histogram workers, stream chunks and batch parts each hash
+// the bytes they count, in the same loop. Not a cryptographic hash.
+#define CONTENT_HASH_SECRET0 0xa0761d6478bd642fULL // wyhash's first two secrets
+#define CONTENT_HASH_SECRET1 0xe7037ed1a0b428dbULL
+
+// A macro, so the histogram loop pays no call per word at -O0
+#define CONTENT_HASH_TERM(word, index)                                                        \
+    __extension__({                                                                           \
+        __uint128_t product_ = (__uint128_t)((word) ^ CONTENT_HASH_SECRET0) *                 \
+                               ((index) ^ CONTENT_HASH_SECRET1);                              \
+        (uint64_t)product_ ^ (uint64_t)(product_ >> 64);                                      \
+    })
+
+// Terms of the `count` whole words at `words`, the first being word `firstWord`
+uint64_t contentHashWords(const char* words, uint64_t firstWord, size_t count);
+
+// Terms of the whole words that end inside buf[0..size), where buf is the
+// input from byte `offset` on. The first word may start up to 7 bytes
+// before buf, which must be readable (a carry or an earlier part).
+uint64_t contentHashRange(const char* buf, uint64_t offset, size_t size);
+
+// Term of the zero-padded last word of a `size`-byte input that ends at
+// `end` (0 if size is a multiple of 8). Added once, by whoever sees the end.
+uint64_t contentHashEnd(const char* end, uint64_t size);
+
+// ==========================================
+// RESULT CACHE
+// ==========================================
+
+// What a result depends on: the bytes (their hash and length) and the
+// options that change what an analysis reports
+typedef struct {
+    uint64_t contentHash;
+    uint64_t size;
+    uint64_t options;
+} ResultCacheKey;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t evictions;
+} ResultCacheCounters;
+
+// A directory of results, one file per key. Entries over `maxBytes` in total
+// are evicted least recently used first: a hit stamps its file's mtime, and
+// eviction removes the oldest stamps. Processes and threads may share a
+// directory; entries appear by rename, so readers never see half of one.
+typedef struct ResultCache ResultCache;
+
+// Opens `dir`, creating it if missing. NULL if it cannot be created.
+ResultCache* resultCacheOpen(const char* dir, uint64_t maxBytes);
+void resultCacheClose(ResultCache* cache);
+
+// Copies the value stored under `key` to value[0..size). Returns 0 on a hit,
+// -1 on a miss (no entry, another key or size behind the same file name, or
+// a damaged file); value is left alone on a miss.
+int resultCacheLoad(ResultCache* cache, const ResultCacheKey* key, void* value, size_t size);
+// Stores value[0..size) under `key`, then evicts down to the size limit.
+// Returns -1 if the entry could not be written.
+int resultCacheStore(ResultCache* cache, const ResultCacheKey* key, const void* value, size_t size);
+// Removes every entry
+void resultCacheClear(ResultCache* cache);
+
+void resultCacheCounters(const ResultCache* cache, ResultCacheCounters* counters);
+
+#endif
@@ -1,228 +1,1094 @@
 /* vowel_counting.c */
 /* not gonna put my ID on Github :), Roy carmelli  */
+/* libvowelstats (vowel_stats.h) plus the baseline countVowels interface */
 
 #include <stdbool.h>
 #include <stdio.h>
-#include <unistd.h> // for fork()
-#include <sys/wait.h> // for wait()
-#include <stdlib.h> // for exit()
-#include <string.h> // for memchr, memset
+#include <stdint.h> // for uint64_t
+#include <inttypes.h> // for PRIu64
+#include <unistd.h> // for sysconf()
+#include <stdlib.h> // for malloc()
+#include <string.h> // for memchr, memset, memcmp
+#include <stdatomic.h> // for the shared Hamming bound
+#include <errno.h> // for EFBIG, ENOMEM
+#include <sys/mman.h> // for mmap(), madvise()
+#include "vowel_counting.h"
+#include "vowel_stats.h"
+#include "vowel_simd.h"
+#include "vowel_bitset.h"
+#include "vowel_patterns.h"
+#include "vowel_pool.h"
+#include "vowel_utf8.h"
+#include "vowel_templates.h"
+#include "vowel_cache.h"
+#include "vowel_mismatch.h"
+#include "vowel_index.h"
 
 // ==========================================
 // DATA & LUT SETUP
 // ==========================================
-unsigned char charProps[256] = {0}; 
-bool tableInitialized = false;
-
-// Global Histogram
-int globalCounts[256];
-
-// Legacy counters
-int letterCounts[26];  
-int digitCounts[10];   
-
-// Flags  
-#define FLAG_DIGIT  4   
-#define FLAG_VOWEL  8 
-
-void initCharTable() {
-    if (tableInitialized) return;
-    // Unrolled digit initialization
-    charProps['0'] = FLAG_DIGIT; charProps['1'] = FLAG_DIGIT;
-    charProps['2'] = FLAG_DIGIT; charProps['3'] = FLAG_DIGIT;
-    charProps['4'] = FLAG_DIGIT; charProps['5'] = FLAG_DIGIT;
-    charProps['6'] = FLAG_DIGIT; charProps['7'] = FLAG_DIGIT;
-    charProps['8'] = FLAG_DIGIT; charProps['9'] = FLAG_DIGIT;
-    
-    // Unrolled vowel initialization
-    charProps['a'] = FLAG_VOWEL; charProps['e'] = FLAG_VOWEL;
-    charProps['i'] = FLAG_VOWEL; charProps['o'] = FLAG_VOWEL;
-    charProps['u'] = FLAG_VOWEL; charProps['A'] = FLAG_VOWEL;
-    charProps['E'] = FLAG_VOWEL; charProps['I'] = FLAG_VOWEL;
-    charProps['O'] = FLAG_VOWEL; charProps['U'] = FLAG_VOWEL;
-    
-    tableInitialized = true;
+
+// Flags
+#define FLAG_DIGIT  4
+#define FLAG_VOWEL  8
+
+// Read-only once compiled, so every context and thread shares it
+static const unsigned char charProps[256] = {
+    ['0'] = FLAG_DIGIT, ['1'] = FLAG_DIGIT, ['2'] = FLAG_DIGIT, ['3'] = FLAG_DIGIT,
+    ['4'] = FLAG_DIGIT, ['5'] = FLAG_DIGIT, ['6'] = FLAG_DIGIT, ['7'] = FLAG_DIGIT,
+    ['8'] = FLAG_DIGIT, ['9'] = FLAG_DIGIT,
+    ['a'] = FLAG_VOWEL, ['e'] = FLAG_VOWEL, ['i'] = FLAG_VOWEL, ['o'] = FLAG_VOWEL,
+    ['u'] = FLAG_VOWEL, ['A'] = FLAG_VOWEL, ['E'] = FLAG_VOWEL, ['I'] = FLAG_VOWEL,
+    ['O'] = FLAG_VOWEL, ['U'] = FLAG_VOWEL,
+};
+
+#define PI_LENGTH VOWEL_STATS_PI_LENGTH // piDigits lives in vowel_patterns.c with the other references
+#define DEFAULT_PREFETCH_STRIDES 16     // Misses a strided walk keeps in flight
+
+struct VowelStats {
+    // Options
+    const SimdKernels* simd;      // Vector kernels in use
+    int workerThreads;            // 0 = one per online CPU
+    bool useKmpPrefix;
+    bool useBitsetBackend;
+    bool useQgramBackend;
+    bool useUnrolledHistogram;
+    const PatternKernels* templatePrefix;  // Template engines (vowel_templates.cpp), or NULL
+    const PatternKernels* templateHamming;
+    const PatternSet* patternSet; // Extra reference sequences, or NULL
+    ResultCache* cache;           // Results by content hash, or NULL
+    size_t fusedBlock;            // 0 = multi-pass
+    unsigned passes;              // VOWEL_STATS_* passes to run
+    size_t prefetchStrides;       // Strided sampling lookahead, 0 = none
+    JobPool* pool;                // Parked worker threads, started on first use
+
+    // Streaming state: running totals of everything an analysis derives from
+    // the whole buffer. stream.size is the global index of the next fresh byte.
+    VowelStatsResult stream;
+    PrefixMatcher* streamPiMatcher; // KMP engine only
+    PatternMatch* streamPatterns;
+    Utf8Decoder streamUtf8;
+    char* streamTail;               // Last bytes seen, for checkpoints
+    size_t streamTailLength;
+    size_t streamTailCapacity;      // Enough to rebuild every matcher's state
+};
+
+VowelStats* vowelStatsCreate(void) {
+    VowelStats* stats = (VowelStats*)calloc(1, sizeof(VowelStats));
+    if (stats == NULL) return NULL;
+    stats->simd = simdKernelsFor(NULL);
+    stats->passes = VOWEL_STATS_DEFAULT;
+    stats->prefetchStrides = DEFAULT_PREFETCH_STRIDES;
+    return stats;
+}
+
+VowelStats* vowelStatsClone(const VowelStats* stats) {
+    VowelStats* clone = vowelStatsCreate();
+    if (clone == NULL) return NULL;
+    clone->simd = stats->simd;
+    clone->workerThreads = stats->workerThreads;
+    clone->useKmpPrefix = stats->useKmpPrefix;
+    clone->useBitsetBackend = stats->useBitsetBackend;
+    clone->useQgramBackend = stats->useQgramBackend;
+    clone->useUnrolledHistogram = stats->useUnrolledHistogram;
+    clone->templatePrefix = stats->templatePrefix;
+    clone->templateHamming = stats->templateHamming;
+    clone->patternSet = stats->patternSet;
+    clone->cache = stats->cache;
+    clone->fusedBlock = stats->fusedBlock;
+    clone->passes = stats->passes;
+    clone->prefetchStrides = stats->prefetchStrides;
+    return clone;
+}
+
+void vowelStatsFree(VowelStats* stats) {
+    if (stats == NULL) return;
+    jobPoolFree(stats->pool);
+    prefixMatcherFree(stats->streamPiMatcher);
+    patternMatchFree(stats->streamPatterns);
+    free(stats->streamTail);
+    free(stats);
+}
+
+int vowelStatsSetSimdLevel(VowelStats* stats, const char* level) {
+    const SimdKernels* kernels = simdKernelsFor(level);
+    if (kernels == NULL) return -1;
+    stats->simd = kernels;
+    return 0;
+}
+
+const char* vowelStatsSimdLevel(const VowelStats* stats) {
+    return stats->simd->name;
+}
+
+void vowelStatsSetPasses(VowelStats* stats, unsigned passes) {
+    stats->passes = passes & VOWEL_STATS_ALL;
+}
+
+static bool runsPass(const VowelStats* stats, unsigned pass) {
+    return (stats->passes & pass) != 0;
 }
 
 // ==========================================
-// HEAVY ANALYSIS (Child Process)
+// WORKER THREADS
 // ==========================================
 
-int findLongestPiMatch(char* buf, int size) {
-    static const char piDigits[] = "3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067";
-    register int longestMatch = 0;
-    register char* ptr = buf;
-    char* endPtr = buf + size - 100; // Subtract piLength directly
-    
+#define MIN_BYTES_PER_WORKER (256 << 10) // Smaller slices cost more to hand off than to scan
+
+static long configuredThreads(const VowelStats* stats) {
+    long threads = stats->workerThreads > 0 ? stats->workerThreads : sysconf(_SC_NPROCESSORS_ONLN);
+    return threads > 1 ? threads : 1;
+}
+
+void vowelStatsSetThreads(VowelStats* stats, int threads) {
+    stats->workerThreads = threads;
+    // The pool is sized for the old count; the next call starts a new one
+    jobPoolFree(stats->pool);
+    stats->pool = NULL;
+}
+
+// Starts the worker threads the first time a call can use them. They stay
+// parked between calls, so a call pays a queue push and a wakeup per job
+// instead of a thread (or process) creation. No pool - one thread - means
+// every job runs inline.
+static void ensurePool(VowelStats* stats) {
+    long threads = configuredThreads(stats);
+    if (stats->pool == NULL && threads > 1) stats->pool = jobPoolCreate((int)(threads - 1));
+}
+
+// How many workers to split `units` bytes (or start offsets) across
+static long workerCount(const VowelStats* stats, size_t units) {
+    long workers = configuredThreads(stats);
+    if (workers > (long)(units / MIN_BYTES_PER_WORKER)) workers = units / MIN_BYTES_PER_WORKER;
+    return workers > 1 ? workers : 1;
+}
+
+// Runs fn on each of the `workers` argument structs laid out `stride` bytes
+// apart. Worker 0 runs on the calling thread, which then helps with the rest;
+// all have finished on return.
+static void runWorkers(const VowelStats* stats, long workers, JobFn fn, void* args, size_t stride) {
+    if (stats->pool == NULL) {
+        for (long w = 0; w < workers; w++) fn((char*)args + w * stride);
+        return;
+    }
+    JobGroup group;
+    jobGroupInit(&group);
+    for (long w = 1; w < workers; w++) jobPoolSubmit(stats->pool, &group, fn, (char*)args + w * stride);
+    fn(args);
+    jobPoolWait(stats->pool, &group);
+    jobGroupDestroy(&group);
+}
+
+// ==========================================
+// HEAVY ANALYSIS (Side Job)
+// ==========================================
+
+// Range kernels: every start offset in [first, last) may read PI_LENGTH bytes,
+// so callers must keep buf[last - 1 + 99] in bounds. Streaming mode uses the
+// same kernels on each chunk, carrying STREAM_OVERLAP bytes between windows.
+
+static size_t piMatchRange(const VowelStats* stats, const char* buf, size_t first, size_t last,
+                           size_t longestMatch) {
+    register const char* ptr = buf + first;
+    const char* endPtr = buf + last;
+
     while(ptr < endPtr){
-        ptr = (char*)memchr(ptr, '3', endPtr - ptr + 100);
+        ptr = (const char*)memchr(ptr, '3', endPtr - ptr);
         if (ptr == NULL) break;
-        if (ptr > endPtr) break; // Guard against overflow
-
-        register int currentMatch = 0;
-        register char* scanBuf = ptr;
-        register const char* scanPi = piDigits;
-
-        // Unrolled comparison loop (10x unroll for 100 digits)
-        while (scanPi < piDigits + 100) {
-            if (*scanBuf++ != *scanPi++) break;
-            currentMatch++;
-            if (*scanBuf++ != *scanPi++) break;
-            currentMatch++;
-            if (*scanBuf++ != *scanPi++) break;
-            currentMatch++;
-            if (*scanBuf++ != *scanPi++) break;
-            currentMatch++;
-            if (*scanBuf++ != *scanPi++) break;
-            currentMatch++;
+
+        register size_t currentMatch = 0;
+        if (stats->templatePrefix != NULL) {
+            currentMatch = stats->templatePrefix->prefixLength(ptr);
+        } else if (stats->simd->prefixLength != NULL) {
+            currentMatch = stats->simd->prefixLength(ptr, piDigits, PI_LENGTH);
+        } else {
+            register const char* scanBuf = ptr;
+            register const char* scanPi = piDigits;
+
+            // Unrolled comparison loop (10x unroll for 100 digits)
+            while (scanPi < piDigits + PI_LENGTH) {
+                if (*scanBuf++ != *scanPi++) break;
+                currentMatch++;
+                if (*scanBuf++ != *scanPi++) break;
+                currentMatch++;
+                if (*scanBuf++ != *scanPi++) break;
+                currentMatch++;
+                if (*scanBuf++ != *scanPi++) break;
+                currentMatch++;
+                if (*scanBuf++ != *scanPi++) break;
+                currentMatch++;
+            }
         }
-        
+
         if(currentMatch > longestMatch) longestMatch = currentMatch;
-        ptr++; 
+        ptr++;
+    }
+    return longestMatch;
+}
+
+// Starts in [first, last) closer than PI_LENGTH to the end of the input at
+// buf[end]: their prefixes are cut short there, as in the baseline and the
+// KMP engine. At most 99 starts, so the scan engine uses a plain bounded
+// compare and the template engine its bounded kernel.
+static size_t piMatchTail(const VowelStats* stats, const char* buf, size_t first, size_t last, size_t end,
+                          size_t longestMatch) {
+    for (size_t start = first; start < last; start++) {
+        size_t limit = end - start < PI_LENGTH ? end - start : PI_LENGTH;
+        size_t currentMatch = 0;
+        if (stats->templatePrefix != NULL) {
+            currentMatch = stats->templatePrefix->prefixLengthUpTo(buf + start, limit);
+        } else {
+            while (currentMatch < limit && buf[start + currentMatch] == piDigits[currentMatch]) currentMatch++;
+        }
+        if (currentMatch > longestMatch) longestMatch = currentMatch;
     }
     return longestMatch;
 }
-void findBestHammingMatch(char* buf, int size) {
-    static const char piDigits[] = "3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067";
-    int piLength = 100;
-    int bestIndex = -1;
-    int bestHammingScore = 0;
-
-    char* p = buf;
-    char* endPtr = buf + size - piLength;
-    int i = 0;
-
-    // Iterate through each possible starting position
-    for (; p <= endPtr; p++, i++) {
-        int s = 0;
-
-        // --- BLOCK 1: 0-19 (Manual unroll in groups of 4) ---
-        s += (p[0] == piDigits[0]) + (p[1] == piDigits[1]) + (p[2] == piDigits[2]) + (p[3] == piDigits[3]) + (p[4] == piDigits[4]);
-        s += (p[5] == piDigits[5]) + (p[6] == piDigits[6]) + (p[7] == piDigits[7]) + (p[8] == piDigits[8]) + (p[9] == piDigits[9]);
-        s += (p[10] == piDigits[10]) + (p[11] == piDigits[11]) + (p[12] == piDigits[12]) + (p[13] == piDigits[13]) + (p[14] == piDigits[14]);
-        s += (p[15] == piDigits[15]) + (p[16] == piDigits[16]) + (p[17] == piDigits[17]) + (p[18] == piDigits[18]) + (p[19] == piDigits[19]);
-
-        // ORIGINAL PRUNING LOGIC (Must be kept for output compatibility)
-        if (s + 80 <= bestHammingScore) continue;
-
-        // --- BLOCK 2: 20-39 ---
-        s += (p[20] == piDigits[20]) + (p[21] == piDigits[21]) + (p[22] == piDigits[22]) + (p[23] == piDigits[23]) + (p[24] == piDigits[24]);
-        s += (p[25] == piDigits[25]) + (p[26] == piDigits[26]) + (p[27] == piDigits[27]) + (p[28] == piDigits[28]) + (p[29] == piDigits[29]);
-        s += (p[30] == piDigits[30]) + (p[31] == piDigits[31]) + (p[32] == piDigits[32]) + (p[33] == piDigits[33]) + (p[34] == piDigits[34]);
-        s += (p[35] == piDigits[35]) + (p[36] == piDigits[36]) + (p[37] == piDigits[37]) + (p[38] == piDigits[38]) + (p[39] == piDigits[39]);
+
+// First start with fewer than PI_LENGTH bytes left in a `size`-byte input
+static size_t piTailStart(size_t size) {
+    return size >= PI_LENGTH ? size - PI_LENGTH + 1 : 0;
+}
+
+// "scan" compares at every '3' (fast on typical input, but O(n * 100) on
+// text built from pi prefixes); "kmp" is O(n) whatever the input. "template"
+// is the scan with the compare instantiated for pi's digits. All of them
+// count prefixes cut short by the end of the buffer, as the baseline does,
+// so the engine never changes a result.
+int vowelStatsSetPrefixEngine(VowelStats* stats, const char* engine) {
+    if (strcmp(engine, "scan") == 0) {
+        stats->useKmpPrefix = false;
+        stats->templatePrefix = NULL;
+    } else if (strcmp(engine, "kmp") == 0) {
+        stats->useKmpPrefix = true;
+        stats->templatePrefix = NULL;
+    } else if (strcmp(engine, "template") == 0) {
+        const PatternKernels* kernels = patternKernelsFor(piDigits, PI_LENGTH);
+        if (kernels == NULL) return -1;
+        stats->useKmpPrefix = false;
+        stats->templatePrefix = kernels;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static size_t findLongestPiMatch(const VowelStats* stats, const char* buf, size_t size) {
+    if (stats->useKmpPrefix) {
+        PrefixMatcher* matcher = prefixMatcherCreate(piDigits, PI_LENGTH);
+        if (matcher != NULL) {
+            prefixMatcherFeed(matcher, buf, size);
+            size_t longest = prefixMatcherLongest(matcher);
+            prefixMatcherFree(matcher);
+            return longest;
+        }
+    }
+    size_t tail = piTailStart(size);
+    return piMatchTail(stats, buf, tail, size, size, piMatchRange(stats, buf, 0, tail, 0));
+}
+
+// Shards share their best match as one packed key: score in the high bits,
+// inverted index in the low bits, so a larger key is always the better match
+// (higher score, then lower index - the tie-break of the sequential scan).
+#define KEY_INDEX_BITS 40
+#define KEY_INDEX_MASK ((1ULL << KEY_INDEX_BITS) - 1)
+#define HAMMING_REFRESH BITSET_MAX_SPAN // Positions scanned between reads of the shared key
+
+static uint64_t hammingKey(int score, uint64_t index) {
+    return ((uint64_t)score << KEY_INDEX_BITS) | (KEY_INDEX_MASK - index);
+}
+
+static void publishHammingKey(_Atomic uint64_t* sharedKey, uint64_t key) {
+    uint64_t current = atomic_load_explicit(sharedKey, memory_order_relaxed);
+    while (key > current &&
+           !atomic_compare_exchange_weak_explicit(sharedKey, &current, key,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+// Scans start offsets [first, last). `base` is the global index of buf[0].
+static void hammingShard(const SimdKernels* simd, const PatternKernels* kernels, const char* buf,
+                         size_t first, size_t last, uint64_t base, _Atomic uint64_t* sharedKey,
+                         BitsetScanner* scanner) {
+    int bestHammingScore = 0; // Score a position has to beat
+    const char* p = buf + first;
+    const char* endPtr = buf + last;
+
+    while (p < endPtr) {
+        // Tighten the bound with the best match any shard has found so far.
+        // A tie only goes to us when that match lies after our position.
+        uint64_t key = atomic_load_explicit(sharedKey, memory_order_relaxed);
+        int sharedScore = (int)(key >> KEY_INDEX_BITS);
+        uint64_t sharedIndex = KEY_INDEX_MASK - (key & KEY_INDEX_MASK);
+        int sharedBound = sharedScore - (sharedIndex > base + (p - buf));
+        if (sharedBound > bestHammingScore) bestHammingScore = sharedBound;
+        if (bestHammingScore >= PI_LENGTH) return;
+
+        const char* blockEnd = (endPtr - p > HAMMING_REFRESH) ? p + HAMMING_REFRESH : endPtr;
+
+        if (scanner != NULL) {
+            // Bit-parallel backend: the best start of the whole block at once
+            size_t offset;
+            int s = bitsetBestScore(scanner, buf, p - buf, blockEnd - buf, bestHammingScore, &offset);
+            if (s > bestHammingScore) {
+                bestHammingScore = s;
+                publishHammingKey(sharedKey, hammingKey(s, base + offset));
+                if (bestHammingScore == 100) return;
+            }
+            p = blockEnd;
+            continue;
+        }
+
+        if (kernels != NULL) {
+            // Template engine: the unrolled blocks below, generated for pi
+            for (; p < blockEnd; p++) {
+                int s = kernels->hammingScore(p, bestHammingScore);
+                if (s > bestHammingScore) {
+                    bestHammingScore = s;
+                    publishHammingKey(sharedKey, hammingKey(s, base + (p - buf)));
+                    if (bestHammingScore == 100) return;
+                }
+            }
+            continue;
+        }
+
+        if (simd->hammingScore != NULL) {
+            // One vector pass over all 100 bytes beats the pruned scalar blocks
+            for (; p < blockEnd; p++) {
+                int s = simd->hammingScore(p, piDigits, PI_LENGTH);
+                if (s > bestHammingScore) {
+                    bestHammingScore = s;
+                    publishHammingKey(sharedKey, hammingKey(s, base + (p - buf)));
+                    if (bestHammingScore == 100) return;
+                }
+            }
+            continue;
+        }
+
+        // Iterate through each possible starting position
+        for (; p < blockEnd; p++) {
+            int s = 0;
+
+            // --- BLOCK 1: 0-19 (Manual unroll in groups of 4) ---
+            s += (p[0] == piDigits[0]) + (p[1] == piDigits[1]) + (p[2] == piDigits[2]) + (p[3] == piDigits[3]) + (p[4] == piDigits[4]);
+            s += (p[5] == piDigits[5]) + (p[6] == piDigits[6]) + (p[7] == piDigits[7]) + (p[8] == piDigits[8]) + (p[9] == piDigits[9]);
+            s += (p[10] == piDigits[10]) + (p[11] == piDigits[11]) + (p[12] == piDigits[12]) + (p[13] == piDigits[13]) + (p[14] == piDigits[14]);
+            s += (p[15] == piDigits[15]) + (p[16] == piDigits[16]) + (p[17] == piDigits[17]) + (p[18] == piDigits[18]) + (p[19] == piDigits[19]);
+
+            // ORIGINAL PRUNING LOGIC (Must be kept for output compatibility)
+            if (s + 80 <= bestHammingScore) continue;
+
+            // --- BLOCK 2: 20-39 ---
+            s += (p[20] == piDigits[20]) + (p[21] == piDigits[21]) + (p[22] == piDigits[22]) + (p[23] == piDigits[23]) + (p[24] == piDigits[24]);
+            s += (p[25] == piDigits[25]) + (p[26] == piDigits[26]) + (p[27] == piDigits[27]) + (p[28] == piDigits[28]) + (p[29] == piDigits[29]);
+            s += (p[30] == piDigits[30]) + (p[31] == piDigits[31]) + (p[32] == piDigits[32]) + (p[33] == piDigits[33]) + (p[34] == piDigits[34]);
+            s += (p[35] == piDigits[35]) + (p[36] == piDigits[36]) + (p[37] == piDigits[37]) + (p[38] == piDigits[38]) + (p[39] == piDigits[39]);
         
-        if (s + 60 <= bestHammingScore) continue;
-
-        // --- BLOCK 3: 40-59 ---
-        s += (p[40] == piDigits[40]) + (p[41] == piDigits[41]) + (p[42] == piDigits[42]) + (p[43] == piDigits[43]) + (p[44] == piDigits[44]);
-        s += (p[45] == piDigits[45]) + (p[46] == piDigits[46]) + (p[47] == piDigits[47]) + (p[48] == piDigits[48]) + (p[49] == piDigits[49]);
-        s += (p[50] == piDigits[50]) + (p[51] == piDigits[51]) + (p[52] == piDigits[52]) + (p[53] == piDigits[53]) + (p[54] == piDigits[54]);
-        s += (p[55] == piDigits[55]) + (p[56] == piDigits[56]) + (p[57] == piDigits[57]) + (p[58] == piDigits[58]) + (p[59] == piDigits[59]);
-        if (s + 40 <= bestHammingScore) continue;
-
-        // --- BLOCK 4: 60-79 ---
-        s += (p[60] == piDigits[60]) + (p[61] == piDigits[61]) + (p[62] == piDigits[62]) + (p[63] == piDigits[63]) + (p[64] == piDigits[64]);
-        s += (p[65] == piDigits[65]) + (p[66] == piDigits[66]) + (p[67] == piDigits[67]) + (p[68] == piDigits[68]) + (p[69] == piDigits[69]);
-        s += (p[70] == piDigits[70]) + (p[71] == piDigits[71]) + (p[72] == piDigits[72]) + (p[73] == piDigits[73]) + (p[74] == piDigits[74]);
-        s += (p[75] == piDigits[75]) + (p[76] == piDigits[76]) + (p[77] == piDigits[77]) + (p[78] == piDigits[78]) + (p[79] == piDigits[79]);
-        if (s + 20 <= bestHammingScore) continue;
-
-        // --- BLOCK 5: 80-99 ---
-        s += (p[80] == piDigits[80]) + (p[81] == piDigits[81]) + (p[82] == piDigits[82]) + (p[83] == piDigits[83]) + (p[84] == piDigits[84]);
-        s += (p[85] == piDigits[85]) + (p[86] == piDigits[86]) + (p[87] == piDigits[87]) + (p[88] == piDigits[88]) + (p[89] == piDigits[89]);
-        s += (p[90] == piDigits[90]) + (p[91] == piDigits[91]) + (p[92] == piDigits[92]) + (p[93] == piDigits[93]) + (p[94] == piDigits[94]);
-        s += (p[95] == piDigits[95]) + (p[96] == piDigits[96]) + (p[97] == piDigits[97]) + (p[98] == piDigits[98]) + (p[99] == piDigits[99]);
-        if (s > bestHammingScore) {
-            bestHammingScore = s;
-            bestIndex = i;
-            if (bestHammingScore == 100) break;
+            if (s + 60 <= bestHammingScore) continue;
+
+            // --- BLOCK 3: 40-59 ---
+            s += (p[40] == piDigits[40]) + (p[41] == piDigits[41]) + (p[42] == piDigits[42]) + (p[43] == piDigits[43]) + (p[44] == piDigits[44]);
+            s += (p[45] == piDigits[45]) + (p[46] == piDigits[46]) + (p[47] == piDigits[47]) + (p[48] == piDigits[48]) + (p[49] == piDigits[49]);
+            s += (p[50] == piDigits[50]) + (p[51] == piDigits[51]) + (p[52] == piDigits[52]) + (p[53] == piDigits[53]) + (p[54] == piDigits[54]);
+            s += (p[55] == piDigits[55]) + (p[56] == piDigits[56]) + (p[57] == piDigits[57]) + (p[58] == piDigits[58]) + (p[59] == piDigits[59]);
+            if (s + 40 <= bestHammingScore) continue;
+
+            // --- BLOCK 4: 60-79 ---
+            s += (p[60] == piDigits[60]) + (p[61] == piDigits[61]) + (p[62] == piDigits[62]) + (p[63] == piDigits[63]) + (p[64] == piDigits[64]);
+            s += (p[65] == piDigits[65]) + (p[66] == piDigits[66]) + (p[67] == piDigits[67]) + (p[68] == piDigits[68]) + (p[69] == piDigits[69]);
+            s += (p[70] == piDigits[70]) + (p[71] == piDigits[71]) + (p[72] == piDigits[72]) + (p[73] == piDigits[73]) + (p[74] == piDigits[74]);
+            s += (p[75] == piDigits[75]) + (p[76] == piDigits[76]) + (p[77] == piDigits[77]) + (p[78] == piDigits[78]) + (p[79] == piDigits[79]);
+            if (s + 20 <= bestHammingScore) continue;
+
+            // --- BLOCK 5: 80-99 ---
+            s += (p[80] == piDigits[80]) + (p[81] == piDigits[81]) + (p[82] == piDigits[82]) + (p[83] == piDigits[83]) + (p[84] == piDigits[84]);
+            s += (p[85] == piDigits[85]) + (p[86] == piDigits[86]) + (p[87] == piDigits[87]) + (p[88] == piDigits[88]) + (p[89] == piDigits[89]);
+            s += (p[90] == piDigits[90]) + (p[91] == piDigits[91]) + (p[92] == piDigits[92]) + (p[93] == piDigits[93]) + (p[94] == piDigits[94]);
+            s += (p[95] == piDigits[95]) + (p[96] == piDigits[96]) + (p[97] == piDigits[97]) + (p[98] == piDigits[98]) + (p[99] == piDigits[99]);
+            if (s > bestHammingScore) {
+                bestHammingScore = s;
+                publishHammingKey(sharedKey, hammingKey(s, base + (p - buf)));
+                if (bestHammingScore == 100) return;
+            }
         }
     }
+}
+
+typedef struct {
+    const SimdKernels* simd;
+    const PatternKernels* kernels; // Template engine, or NULL
+    const char* buf;
+    size_t first;
+    size_t last;
+    uint64_t base;
+    _Atomic uint64_t* sharedKey;
+    BitsetScanner* scanner; // NULL unless the bitset backend is selected
+} __attribute__((aligned(64))) HammingWorker;
+
+static void hammingWorker(void* arg) {
+    HammingWorker* worker = (HammingWorker*)arg;
+    hammingShard(worker->simd, worker->kernels, worker->buf, worker->first, worker->last, worker->base,
+                 worker->sharedKey, worker->scanner);
+}
+
+int vowelStatsSetHammingBackend(VowelStats* stats, const char* backend) {
+    if (strcmp(backend, "unrolled") == 0) {
+        stats->useBitsetBackend = false;
+        stats->useQgramBackend = false;
+        stats->templateHamming = NULL;
+    } else if (strcmp(backend, "bitset") == 0) {
+        stats->useBitsetBackend = true;
+        stats->useQgramBackend = false;
+        stats->templateHamming = NULL;
+    } else if (strcmp(backend, "template") == 0) {
+        const PatternKernels* kernels = patternKernelsFor(piDigits, PI_LENGTH);
+        if (kernels == NULL) return -1;
+        stats->useBitsetBackend = false;
+        stats->useQgramBackend = false;
+        stats->templateHamming = kernels;
+    } else if (strcmp(backend, "qgram") == 0) {
+        stats->useBitsetBackend = false;
+        stats->useQgramBackend = true;
+        stats->templateHamming = NULL;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// One worker's share of a k-mismatch scan
+typedef struct {
+    MismatchList list;
+    const MismatchFilter* filter; // NULL = count every start
+    int maxMismatches;
+    const char* buf;
+    size_t first;
+    size_t last;
+    uint64_t base;
+    int status;
+} __attribute__((aligned(64))) MismatchWorker;
+
+static void mismatchWorker(void* arg) {
+    MismatchWorker* worker = (MismatchWorker*)arg;
+    if (worker->filter != NULL) {
+        worker->status = mismatchFilterScan(worker->filter, worker->buf, worker->first, worker->last,
+                                            worker->base, &worker->list);
+    } else {
+        worker->status = mismatchScanAll(piDigits, PI_LENGTH, worker->maxMismatches, worker->buf,
+                                         worker->first, worker->last, worker->base, &worker->list);
+    }
+}
 
-    printf("=== Best Hamming Match to Pi (100 digits) ===\n");
-    printf("Best index: %d\n", bestIndex);
-    printf("Hamming score: %d/100 matches\n", bestHammingScore);
-
-    if (bestIndex >= 0) {
-        const char *bestPtr = buf + bestIndex;
-        printf("Character-by-character comparison:\n");
-        printf("Pi:  ");
-        for (int j = 0; j < piLength; j++) printf("%c", piDigits[j]);
-        printf("\nBuf: ");
-        for (int j = 0; j < piLength; j++) printf("%c", bestPtr[j]);
-        printf("\n     ");
-        for (int j = 0; j < piLength; j++) {
-            printf("%c", (bestPtr[j] == piDigits[j]) ? '^' : ' ');
+// Appends the starts in [first, last) within maxMismatches of pi, in index
+// order, split across the workers. The q-gram filter runs whenever the
+// threshold is low enough for it. Returns -1 if out of memory.
+static int parallelMismatchScan(const VowelStats* stats, const char* buf, size_t first, size_t last,
+                                uint64_t base, int maxMismatches, MismatchList* list) {
+    MismatchFilter* filter = mismatchFilterCreate(piDigits, PI_LENGTH, maxMismatches);
+    long workers = workerCount(stats, last - first);
+    MismatchWorker* pool = (MismatchWorker*)aligned_alloc(64, workers * sizeof(MismatchWorker));
+    if (pool == NULL) {
+        mismatchFilterFree(filter);
+        return -1;
+    }
+
+    size_t slice = (last - first) / workers;
+    for (long w = 0; w < workers; w++) {
+        mismatchListInit(&pool[w].list);
+        pool[w].filter = filter;
+        pool[w].maxMismatches = maxMismatches;
+        pool[w].buf = buf;
+        pool[w].first = first + w * slice;
+        pool[w].last = (w == workers - 1) ? last : first + (w + 1) * slice;
+        pool[w].base = base;
+        pool[w].status = 0;
+    }
+    runWorkers(stats, workers, mismatchWorker, pool, sizeof(MismatchWorker));
+
+    int status = 0;
+    for (long w = 0; w < workers; w++) {
+        if (pool[w].status != 0) status = -1;
+        for (size_t i = 0; i < pool[w].list.count && status == 0; i++) {
+            status = mismatchListAppend(list, pool[w].list.hits[i]);
         }
-        printf("\n");
+        mismatchListFree(&pool[w].list);
     }
+    free(pool);
+    mismatchFilterFree(filter);
+    return status;
 }
 
-void analyzeAtSparseAddresses(char* buf, int size) {
-    register int count3 = 0;        
-    register int vowelCount = 0;    
-    register int digitCount = 0;    
-    register int positionsChecked = 0;
-    
-    register char* ptr = buf;
-    char* end = buf + size;
-    
-    // Calculate directly addresses divisible by 1000
+// Scores start offsets [first, last) across the worker threads. The best
+// score/index are carried in and out so a search can resume where the
+// previous range stopped (streaming mode).
+static void hammingRange(const VowelStats* stats, const char* buf, size_t first, size_t last,
+                         uint64_t base, int* bestScore, int64_t* bestIndex) {
+    if (*bestScore == PI_LENGTH) return; // Nothing can beat a perfect match
+
+    if (stats->useQgramBackend) {
+        // Every window the widest filter passes outscores every window it
+        // rejects, so if it passes any, the best of them is the range's best
+        MismatchList list;
+        mismatchListInit(&list);
+        int status = parallelMismatchScan(stats, buf, first, last, base,
+                                          mismatchFilterMaxMismatches(PI_LENGTH), &list);
+        bool found = status == 0 && list.count > 0;
+        for (size_t i = 0; found && i < list.count; i++) {
+            // Index order, so only a higher score displaces the best so far
+            if (list.hits[i].score > *bestScore) {
+                *bestScore = list.hits[i].score;
+                *bestIndex = (int64_t)list.hits[i].index;
+            }
+        }
+        mismatchListFree(&list);
+        if (found) return;
+        // Nothing that close: score every start like the unrolled engine
+    }
+
+    // No match yet encodes as score 0 at index 0: a zero score never wins
+    _Atomic uint64_t sharedKey = *bestIndex >= 0 ? hammingKey(*bestScore, *bestIndex)
+                                                 : hammingKey(0, 0);
+
+    long workers = workerCount(stats, last - first);
+    HammingWorker* pool = (HammingWorker*)aligned_alloc(64, workers * sizeof(HammingWorker));
+    if (pool == NULL) {
+        hammingShard(stats->simd, stats->templateHamming, buf, first, last, base, &sharedKey, NULL);
+    } else {
+        size_t slice = (last - first) / workers;
+        for (long w = 0; w < workers; w++) {
+            pool[w].simd = stats->simd;
+            pool[w].kernels = stats->templateHamming;
+            pool[w].buf = buf;
+            pool[w].first = first + w * slice;
+            pool[w].last = (w == workers - 1) ? last : first + (w + 1) * slice;
+            pool[w].base = base;
+            pool[w].sharedKey = &sharedKey;
+            pool[w].scanner = stats->useBitsetBackend ? bitsetScannerCreate(piDigits, PI_LENGTH) : NULL;
+        }
+        runWorkers(stats, workers, hammingWorker, pool, sizeof(HammingWorker));
+        for (long w = 0; w < workers; w++) bitsetScannerFree(pool[w].scanner);
+        free(pool);
+    }
+
+    uint64_t key = atomic_load(&sharedKey);
+    int score = (int)(key >> KEY_INDEX_BITS);
+    if (score > *bestScore) {
+        *bestScore = score;
+        *bestIndex = (int64_t)(KEY_INDEX_MASK - (key & KEY_INDEX_MASK));
+    }
+}
+
+static void findBestHammingMatch(const VowelStats* stats, const char* buf, size_t size,
+                                 VowelStatsResult* result) {
+    result->bestHammingIndex = -1;
+    result->bestHammingScore = 0;
+
+    if (size >= PI_LENGTH) {
+        hammingRange(stats, buf, 0, size - PI_LENGTH + 1, 0,
+                     &result->bestHammingScore, &result->bestHammingIndex);
+    }
+    if (result->bestHammingIndex >= 0) {
+        memcpy(result->bestHammingWindow, buf + result->bestHammingIndex, PI_LENGTH);
+    }
+}
+
+// ==========================================
+// K-MISMATCH SEARCH (Thresholds and Top-K)
+// ==========================================
+
+int vowelStatsFindMismatches(VowelStats* stats, const char* buf, size_t size, int maxMismatches,
+                             MismatchList* hits) {
+    ensurePool(stats);
+    if (maxMismatches < 0) return -1;
+    if (maxMismatches > PI_LENGTH - 1) maxMismatches = PI_LENGTH - 1;
+    if (size < PI_LENGTH) return 0;
+    return parallelMismatchScan(stats, buf, 0, size - PI_LENGTH + 1, 0, maxMismatches, hits);
+}
+
+// Score of the window at p, or any score <= bound once it cannot beat bound
+static int scoreWindow(const VowelStats* stats, const char* p, int bound) {
+    if (stats->templateHamming != NULL) return stats->templateHamming->hammingScore(p, bound);
+    if (stats->simd->hammingScore != NULL) return stats->simd->hammingScore(p, piDigits, PI_LENGTH);
+    int score = 0;
+    for (int block = 0; block < PI_LENGTH; block += 20) {
+        for (int i = block; i < block + 20; i++) score += p[i] == piDigits[i];
+        if (score + (PI_LENGTH - block - 20) <= bound) break;
+    }
+    return score;
+}
+
+// One worker's best windows, in a heap of its own
+typedef struct {
+    MatchHeap heap;
+    const VowelStats* stats;
+    const char* buf;
+    size_t first;
+    size_t last;
+} __attribute__((aligned(64))) TopWorker;
+
+static void topWorker(void* arg) {
+    TopWorker* worker = (TopWorker*)arg;
+    for (size_t start = worker->first; start < worker->last; start++) {
+        int bound = matchHeapBound(&worker->heap);
+        int score = scoreWindow(worker->stats, worker->buf + start, bound);
+        if (score > bound) matchHeapPush(&worker->heap, (MismatchHit){ start, score });
+    }
+}
+
+// Every start scored, each worker keeping its own best `heap->capacity`
+static int topMatchesExhaustive(const VowelStats* stats, const char* buf, size_t last, MatchHeap* heap) {
+    long workers = workerCount(stats, last);
+    TopWorker* pool = (TopWorker*)aligned_alloc(64, workers * sizeof(TopWorker));
+    if (pool == NULL) return -1;
+    int status = 0;
+    size_t slice = last / workers;
+    for (long w = 0; w < workers; w++) {
+        if (matchHeapInit(&pool[w].heap, heap->capacity) != 0) status = -1;
+        pool[w].stats = stats;
+        pool[w].buf = buf;
+        pool[w].first = w * slice;
+        pool[w].last = (w == workers - 1) ? last : (w + 1) * slice;
+    }
+    if (status == 0) runWorkers(stats, workers, topWorker, pool, sizeof(TopWorker));
+    for (long w = 0; w < workers; w++) {
+        for (size_t i = 0; status == 0 && i < pool[w].heap.count; i++) matchHeapPush(heap, pool[w].heap.hits[i]);
+        matchHeapFree(&pool[w].heap);
+    }
+    free(pool);
+    return status;
+}
+
+int vowelStatsTopMatches(VowelStats* stats, const char* buf, size_t size, size_t k, MismatchHit* hits,
+                         size_t* count) {
+    ensurePool(stats);
+    *count = 0;
+    if (k == 0 || size < PI_LENGTH) return 0;
+    size_t last = size - PI_LENGTH + 1;
+    MatchHeap heap;
+    if (matchHeapInit(&heap, k) != 0) return -1;
+
+    // At least k windows inside the widest filter's reach are the top k:
+    // every window outside it scores lower. Otherwise score them all.
+    MismatchList list;
+    mismatchListInit(&list);
+    int status = parallelMismatchScan(stats, buf, 0, last, 0, mismatchFilterMaxMismatches(PI_LENGTH), &list);
+    if (status == 0 && list.count >= k) {
+        for (size_t i = 0; i < list.count; i++) matchHeapPush(&heap, list.hits[i]);
+    } else if (status == 0) {
+        status = topMatchesExhaustive(stats, buf, last, &heap);
+    }
+    mismatchListFree(&list);
+
+    if (status == 0) {
+        matchHeapSort(&heap);
+        memcpy(hits, heap.hits, heap.count * sizeof(MismatchHit));
+        *count = heap.count;
+    }
+    matchHeapFree(&heap);
+    return status;
+}
+
+// ==========================================
+// SUFFIX INDEX (Build)
+// ==========================================
+
+// One block's suffix types and pair counts
+typedef struct {
+    const char* buf;
+    size_t size;
+    uint8_t* types;
+    size_t first;
+    size_t last;
+    uint64_t* pairs; // SUFFIX_INDEX_PAIRS counters of its own
+} __attribute__((aligned(64))) IndexWorker;
+
+static void indexWorker(void* arg) {
+    IndexWorker* worker = (IndexWorker*)arg;
+    suffixTypesRange(worker->buf, worker->size, worker->types, worker->first, worker->last);
+    suffixPairCounts(worker->buf, worker->size, worker->first, worker->last, worker->pairs);
+}
+
+int vowelStatsBuildIndex(VowelStats* stats, const char* buf, size_t size, const char* path) {
+    ensurePool(stats);
+    if (size > SUFFIX_INDEX_MAX_BYTES) {
+        errno = EFBIG;
+        return -1;
+    }
+    long workers = workerCount(stats, size);
+    IndexWorker* pool = (IndexWorker*)aligned_alloc(64, workers * sizeof(IndexWorker));
+    uint64_t* pairs = (uint64_t*)calloc((size_t)workers * SUFFIX_INDEX_PAIRS, sizeof(uint64_t));
+    uint8_t* types = (uint8_t*)malloc(size + 1);
+    if (pool == NULL || pairs == NULL || types == NULL) {
+        free(pool);
+        free(pairs);
+        free(types);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    size_t slice = size / workers;
+    for (long w = 0; w < workers; w++) {
+        pool[w].buf = buf;
+        pool[w].size = size;
+        pool[w].types = types;
+        pool[w].first = w * slice;
+        pool[w].last = (w == workers - 1) ? size : (w + 1) * slice;
+        pool[w].pairs = pairs + w * SUFFIX_INDEX_PAIRS;
+    }
+    runWorkers(stats, workers, indexWorker, pool, sizeof(IndexWorker));
+
+    // Settle the runs across block ends, last block first, and fold the counts
+    for (long w = workers - 1; w >= 0; w--) suffixTypesJoin(buf, size, types, pool[w].first, pool[w].last);
+    for (long w = 1; w < workers; w++) {
+        for (int key = 0; key < SUFFIX_INDEX_PAIRS; key++) pairs[key] += pool[w].pairs[key];
+    }
+    free(pool);
+
+    int status = suffixIndexWrite(buf, size, types, pairs, path);
+    free(pairs);
+    free(types);
+    return status;
+}
+
+// ==========================================
+// STRIDED SAMPLING
+// ==========================================
+
+#define SPARSE_STRIDE 1000              // The sparse report: offsets divisible by 1000
+#define SAMPLE_BLOCK_BYTES (256 << 10)  // Batched sampling walks the buffer this much at a time
+#define CACHE_LINE_BYTES 64
+#define HUGE_PAGE_BYTES (2 << 20)
+
+void vowelStatsSetPrefetchDistance(VowelStats* stats, unsigned strides) {
+    stats->prefetchStrides = strides;
+}
+
+#define TALLY_SAMPLE(ptr)                                   \
+    do {                                                    \
+        register unsigned char c = (unsigned char)*(ptr);   \
+        register unsigned char props = charProps[c];        \
+        positionsChecked++;                                 \
+        count3 += (c == '3');                               \
+        vowelCount += ((props & FLAG_VOWEL) >> 3);          \
+        digitCount += ((props & FLAG_DIGIT) >> 2);          \
+    } while (0)
+
+// Visits buf[first], buf[first + stride], ... below `last`. Past one stride
+// per cache line every visit is a miss (and on a large buffer a TLB miss),
+// and the plain loop waits for each in turn; prefetching `prefetchStrides`
+// ahead overlaps that many. Prefetches stay inside buf[0..size).
+static void sampleRange(const VowelStats* stats, const char* buf, size_t first, size_t last, size_t size,
+                        size_t stride, VowelStatsSparse* sample) {
+    register uint64_t count3 = 0;
+    register uint64_t vowelCount = 0;
+    register uint64_t digitCount = 0;
+    register uint64_t positionsChecked = 0;
+
+    register const char* ptr = buf + first;
+    const char* end = buf + last;
+
+    // Hardware prefetchers already follow walks within a line or two
+    size_t ahead = stride >= CACHE_LINE_BYTES ? stats->prefetchStrides * stride : 0;
+    if (ahead > 0 && ahead < size && first < last) {
+        const char* prefetchEnd = last < size - ahead ? end : buf + (size - ahead);
+        while (ptr < prefetchEnd) {
+            __builtin_prefetch(ptr + ahead);
+            TALLY_SAMPLE(ptr);
+            ptr += stride;
+        }
+    }
+
+    // The plain pointer-bump walk, and the tail whose prefetches would leave the buffer
     while (ptr < end) {
-        register unsigned char c = (unsigned char)*ptr;
-        register unsigned char props = charProps[c]; 
-        
-        positionsChecked++;
-        count3 += (c == '3');
-        vowelCount += ((props & FLAG_VOWEL) >> 3);
-        digitCount += ((props & FLAG_DIGIT) >> 2);
-        
-        ptr += 1000; 
+        TALLY_SAMPLE(ptr);
+        ptr += stride;
     }
-    
-    printf("Positions checked: %d\n", positionsChecked);
-    printf("Count of '3' at addresses divisible by 1000: %d\n", count3);
-    printf("Vowels at sparse addresses: %d\n", vowelCount);
-    printf("Digits at sparse addresses: %d\n", digitCount);
+
+    sample->positionsChecked += positionsChecked;
+    sample->count3 += count3;
+    sample->vowelCount += vowelCount;
+    sample->digitCount += digitCount;
+}
+
+#undef TALLY_SAMPLE
+
+// The sparse report's part of buf[first..size): first is a multiple of 1000
+static void sparseRange(const VowelStats* stats, const char* buf, size_t first, size_t size,
+                        VowelStatsSparse* sparse) {
+    sampleRange(stats, buf, first, size, size, SPARSE_STRIDE, sparse);
+}
+
+int vowelStatsSample(const VowelStats* stats, const char* buf, size_t size, size_t offset, size_t stride,
+                     VowelStatsSparse* sample) {
+    memset(sample, 0, sizeof(VowelStatsSparse));
+    if (stride == 0) return -1;
+    if (offset < size) sampleRange(stats, buf, offset, size, size, stride, sample);
+    return 0;
+}
+
+// One walk over the buffer for every stride: each block is visited by all of
+// them while it is still in cache (and its pages in the TLB), instead of one
+// full walk - and one round of misses - per stride
+int vowelStatsSampleStrides(const VowelStats* stats, const char* buf, size_t size,
+                            const VowelStatsStride* strides, int count, VowelStatsSparse* samples) {
+    for (int s = 0; s < count; s++) {
+        if (strides[s].stride == 0) return -1;
+    }
+    size_t* next = (size_t*)malloc((count > 0 ? count : 1) * sizeof(size_t));
+    if (next == NULL) return -1;
+    for (int s = 0; s < count; s++) {
+        memset(&samples[s], 0, sizeof(VowelStatsSparse));
+        next[s] = strides[s].offset;
+    }
+
+    for (size_t blockStart = 0; blockStart < size; blockStart += SAMPLE_BLOCK_BYTES) {
+        size_t blockEnd = size - blockStart < SAMPLE_BLOCK_BYTES ? size : blockStart + SAMPLE_BLOCK_BYTES;
+        for (int s = 0; s < count; s++) {
+            if (next[s] >= blockEnd) continue;
+            size_t stride = strides[s].stride;
+            sampleRange(stats, buf, next[s], blockEnd, size, stride, &samples[s]);
+            // First position at or past the block end
+            next[s] += (blockEnd - next[s] + stride - 1) / stride * stride;
+        }
+    }
+    free(next);
+    return 0;
+}
+
+// Mapping length of a huge-page buffer: size rounded up to 2 MiB
+static size_t hugeBufferLength(size_t size) {
+    return (size + HUGE_PAGE_BYTES - 1) & ~(size_t)(HUGE_PAGE_BYTES - 1);
+}
+
+// Smaller buffers stay on the heap: they cannot fill a huge page
+char* vowelStatsAllocBuffer(size_t size) {
+    if (size < HUGE_PAGE_BYTES) return (char*)malloc(size > 0 ? size : 1);
+    // The rounding and the extra page below must not wrap (a size header near SIZE_MAX)
+    if (size > SIZE_MAX - 2 * (size_t)HUGE_PAGE_BYTES) return NULL;
+    size_t length = hugeBufferLength(size);
+
+    // Map one huge page extra and trim both ends to a 2 MiB boundary
+    char* raw = (char*)mmap(NULL, length + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char* base = (char*)(((uintptr_t)raw + HUGE_PAGE_BYTES - 1) & ~(uintptr_t)(HUGE_PAGE_BYTES - 1));
+    if (base > raw) munmap(raw, base - raw);
+    if (raw + HUGE_PAGE_BYTES > base) munmap(base + length, raw + HUGE_PAGE_BYTES - base);
+#ifdef MADV_HUGEPAGE
+    madvise(base, length, MADV_HUGEPAGE); // Best effort, ignored where unsupported
+#endif
+    return base;
+}
+
+void vowelStatsFreeBuffer(char* buf, size_t size) {
+    if (size < HUGE_PAGE_BYTES) {
+        free(buf);
+    } else if (buf != NULL) {
+        munmap(buf, hugeBufferLength(size));
+    }
+}
+
+// Extra reference sequences, all matched in one automaton pass
+int vowelStatsSetPatternSet(VowelStats* stats, const PatternSet* set) {
+    if (set != NULL && patternSetCount(set) > VOWEL_STATS_MAX_PATTERNS) return -1;
+    stats->patternSet = set;
+    return 0;
+}
+
+static void collectPatternMatches(const PatternMatch* match, VowelStatsResult* result) {
+    for (int i = 0; i < result->patternCount; i++) {
+        result->patternLongest[i] = patternMatchLongest(match, i);
+    }
+}
+
+static int findLongestPatternMatches(const VowelStats* stats, const char* buf, size_t size,
+                                     VowelStatsResult* result) {
+    if (stats->patternSet == NULL || !runsPass(stats, VOWEL_STATS_PATTERNS)) return 0;
+    PatternMatch* match = patternMatchCreate(stats->patternSet);
+    if (match == NULL) return -1;
+    patternMatchFeed(match, buf, size);
+    collectPatternMatches(match, result);
+    patternMatchFree(match);
+    return 0;
 }
 
 // ==========================================
-// CORE OPTIMIZATION: Main Entry + Fork
+// HISTOGRAM (Calling Thread)
 // ==========================================
 
-int countVowels(char* buf, int size) {
-    initCharTable();
+// Adds buf[0..size) to counts, leaving vowels to the vector kernel
+static void byteCountRange(const char* buf, size_t size, uint64_t* counts) {
+    register const char* ptr = buf;
+    register const char* endPtr = buf + size;
+
+// 16x Unrolled Loop
+while (endPtr - ptr >= 16) {
+    register unsigned char c0  = ptr[0],  c1  = ptr[1],  c2  = ptr[2],  c3  = ptr[3];
+    register unsigned char c4  = ptr[4],  c5  = ptr[5],  c6  = ptr[6],  c7  = ptr[7];
+    register unsigned char c8  = ptr[8],  c9  = ptr[9],  c10 = ptr[10], c11 = ptr[11];
+    register unsigned char c12 = ptr[12], c13 = ptr[13], c14 = ptr[14], c15 = ptr[15];
     
-    // Clear Histogram
-    memset(globalCounts, 0, 256 * sizeof(int));
+    counts[c0]++; counts[c1]++; counts[c2]++; counts[c3]++;
+    counts[c4]++; counts[c5]++; counts[c6]++; counts[c7]++;
+    counts[c8]++; counts[c9]++; counts[c10]++; counts[c11]++;
+    counts[c12]++; counts[c13]++; counts[c14]++; counts[c15]++;
     
-    // PARALLELISM: Fork to handle Pi logic on a separate CPU core
-    pid_t pid = fork();
-    if (pid == 0) {
-        // Child Process: Do heavy lifting
-        int longestPiMatch = findLongestPiMatch(buf, size);
-        printf("Longest pi digit match found: %d characters\n", longestPiMatch);
-        findBestHammingMatch(buf, size);
-        analyzeAtSparseAddresses(buf, size);
-        exit(0); 
-    }
-
-    // Parent Process: Count vowels (CPU Bound)
-    int vowelCount = 0;
-    register char* ptr = buf;
-    register char* endPtr = buf + size;
+    ptr += 16;
+}
+
+    // Handle tail
+    while (ptr < endPtr) {
+        unsigned char c = (unsigned char)(*ptr);
+        counts[c]++;
+        ptr++;
+    }
+}
+
+// Split tables: byte i of each 8 goes to table i, so a run of one byte value
+// increments 8 different counters instead of waiting on the store of the
+// previous increment to the same one. The counters are 16-bit (8 tables in
+// 4 KiB, well inside L1) and are flushed into 64-bit totals every
+// SPLIT_BLOCK bytes, before any can reach 65536.
+#define SPLIT_TABLES 8
+#define SPLIT_BLOCK (SPLIT_TABLES << 15) // 32768 increments per counter at most
+
+static const unsigned char vowelBytes[] = { 'a', 'e', 'i', 'o', 'u', 'A', 'E', 'I', 'O', 'U' };
+
+static void flushSplitTables(uint16_t tables[SPLIT_TABLES][256], uint64_t* totals) {
+    for (int c = 0; c < 256; c++) {
+        register uint64_t sum = 0;
+        for (int t = 0; t < SPLIT_TABLES; t++) sum += tables[t][c];
+        totals[c] += sum;
+    }
+    memset(tables, 0, SPLIT_TABLES * 256 * sizeof(uint16_t));
+}
+
+// Adds buf[0..size) to counts and returns its vowel count, read off the
+// range's own histogram rather than classified byte by byte. With `hash`,
+// also adds the content hash terms of buf (the input from byte `offset` on):
+// each 16 bytes counted, the 16 bytes of whole words up to 7 bytes behind
+// them are hashed in the same iteration.
+static uint64_t splitHistogramRange(const char* buf, size_t size, uint64_t* counts, uint64_t offset,
+                                    uint64_t* hash) {
+    uint16_t tables[SPLIT_TABLES][256];
+    uint64_t totals[256];
+    memset(tables, 0, sizeof(tables));
+    memset(totals, 0, sizeof(totals));
+
+    register uint16_t* t0 = tables[0];
+    register uint16_t* t1 = tables[1];
+    register uint16_t* t2 = tables[2];
+    register uint16_t* t3 = tables[3];
+    uint16_t* t4 = tables[4];
+    uint16_t* t5 = tables[5];
+    uint16_t* t6 = tables[6];
+    uint16_t* t7 = tables[7];
+
+    size_t lead = offset % 8;       // Bytes of buf's first word that lie before it
+    uint64_t wordIndex = offset / 8;
+    uint64_t hashSum = 0;
+
+    for (size_t done = 0; done < size; done += SPLIT_BLOCK) {
+        register const unsigned char* ptr = (const unsigned char*)buf + done;
+        const unsigned char* endPtr = ptr + (size - done < SPLIT_BLOCK ? size - done : SPLIT_BLOCK);
+
+        if (hash != NULL) {
+            const char* words = (const char*)ptr - lead;
+            while (endPtr - ptr >= 16) {
+                t0[ptr[0]]++;  t1[ptr[1]]++;  t2[ptr[2]]++;  t3[ptr[3]]++;
+                t4[ptr[4]]++;  t5[ptr[5]]++;  t6[ptr[6]]++;  t7[ptr[7]]++;
+                t0[ptr[8]]++;  t1[ptr[9]]++;  t2[ptr[10]]++; t3[ptr[11]]++;
+                t4[ptr[12]]++; t5[ptr[13]]++; t6[ptr[14]]++; t7[ptr[15]]++;
+                uint64_t w0, w1;
+                memcpy(&w0, words, 8);
+                memcpy(&w1, words + 8, 8);
+                hashSum += CONTENT_HASH_TERM(w0, wordIndex) + CONTENT_HASH_TERM(w1, wordIndex + 1);
+                wordIndex += 2;
+                words += 16;
+                ptr += 16;
+            }
+        } else {
+            while (endPtr - ptr >= 16) {
+                t0[ptr[0]]++;  t1[ptr[1]]++;  t2[ptr[2]]++;  t3[ptr[3]]++;
+                t4[ptr[4]]++;  t5[ptr[5]]++;  t6[ptr[6]]++;  t7[ptr[7]]++;
+                t0[ptr[8]]++;  t1[ptr[9]]++;  t2[ptr[10]]++; t3[ptr[11]]++;
+                t4[ptr[12]]++; t5[ptr[13]]++; t6[ptr[14]]++; t7[ptr[15]]++;
+                ptr += 16;
+            }
+        }
+        for (int t = 0; ptr < endPtr; ptr++, t++) tables[t % SPLIT_TABLES][*ptr]++;
+
+        flushSplitTables(tables, totals);
+    }
+
+    // Blocks are whole 16-byte steps until the last, so the words hashed so
+    // far are contiguous; the few left end in the final partial step
+    if (hash != NULL) {
+        size_t hashed = size / 16 * 16;
+        size_t remaining = (offset + size) / 8 - wordIndex;
+        *hash += hashSum + contentHashWords(buf + hashed - lead, wordIndex, remaining);
+    }
+
+    uint64_t vowelCount = 0;
+    for (size_t v = 0; v < sizeof(vowelBytes); v++) vowelCount += totals[vowelBytes[v]];
+    for (int c = 0; c < 256; c++) counts[c] += totals[c];
+    return vowelCount;
+}
+
+// "split" (the default) counts into interleaved narrow tables; "unrolled"
+// increments one 64-bit table and classifies every byte for the vowel count
+int vowelStatsSetHistogramEngine(VowelStats* stats, const char* engine) {
+    if (strcmp(engine, "split") == 0) {
+        stats->useUnrolledHistogram = false;
+    } else if (strcmp(engine, "unrolled") == 0) {
+        stats->useUnrolledHistogram = true;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+#define SIMD_BLOCK (64 << 10) // Bytes counted per pass before the vector vowel pass
+
+// Adds buf[0..size) to counts and returns its vowel count; with `hash`, adds
+// the content hash terms of buf, which starts at byte `offset` of the input.
+// NULL counts only hashes. The unrolled engine hashes in a loop of its own.
+static uint64_t histogramRange(const VowelStats* stats, const char* buf, size_t size, uint64_t* counts,
+                               uint64_t offset, uint64_t* hash) {
+    if (counts == NULL) {
+        if (hash != NULL) *hash += contentHashRange(buf, offset, size);
+        return 0;
+    }
+    if (!stats->useUnrolledHistogram) return splitHistogramRange(buf, size, counts, offset, hash);
+    if (hash != NULL) *hash += contentHashRange(buf, offset, size);
+
+    uint64_t vowelCount = 0;
+
+    if (stats->simd->countVowels != NULL) {
+        // Byte counts stay scalar; vowels come from the vector classifier
+        // while each block is still in L2
+        for (size_t done = 0; done < size; done += SIMD_BLOCK) {
+            size_t block = size - done < SIMD_BLOCK ? size - done : SIMD_BLOCK;
+            byteCountRange(buf + done, block, counts);
+            vowelCount += stats->simd->countVowels(buf + done, block);
+        }
+        return vowelCount;
+    }
+
+    register const char* ptr = buf;
+    register const char* endPtr = buf + size;
 
 // 16x Unrolled Loop
-while (ptr <= endPtr - 16) {
+while (endPtr - ptr >= 16) {
     register unsigned char c0  = ptr[0],  c1  = ptr[1],  c2  = ptr[2],  c3  = ptr[3];
     register unsigned char c4  = ptr[4],  c5  = ptr[5],  c6  = ptr[6],  c7  = ptr[7];
     register unsigned char c8  = ptr[8],  c9  = ptr[9],  c10 = ptr[10], c11 = ptr[11];
     register unsigned char c12 = ptr[12], c13 = ptr[13], c14 = ptr[14], c15 = ptr[15];
     
-    globalCounts[c0]++; globalCounts[c1]++; globalCounts[c2]++; globalCounts[c3]++;
-    globalCounts[c4]++; globalCounts[c5]++; globalCounts[c6]++; globalCounts[c7]++;
-    globalCounts[c8]++; globalCounts[c9]++; globalCounts[c10]++; globalCounts[c11]++;
-    globalCounts[c12]++; globalCounts[c13]++; globalCounts[c14]++; globalCounts[c15]++;
+    counts[c0]++; counts[c1]++; counts[c2]++; counts[c3]++;
+    counts[c4]++; counts[c5]++; counts[c6]++; counts[c7]++;
+    counts[c8]++; counts[c9]++; counts[c10]++; counts[c11]++;
+    counts[c12]++; counts[c13]++; counts[c14]++; counts[c15]++;
     
     vowelCount += ((charProps[c0] & FLAG_VOWEL) >> 3) + ((charProps[c1] & FLAG_VOWEL) >> 3);
     vowelCount += ((charProps[c2] & FLAG_VOWEL) >> 3) + ((charProps[c3] & FLAG_VOWEL) >> 3);
@@ -239,78 +1105,991 @@ while (ptr <= endPtr - 16) {
     // Handle tail
     while (ptr < endPtr) {
         unsigned char c = (unsigned char)(*ptr);
-        globalCounts[c]++;
+        counts[c]++;
         vowelCount += ((charProps[c] & FLAG_VOWEL) >> 3);
         ptr++;
     }
     
-    // Consolidate Results - unrolled
-letterCounts[0] = globalCounts['a'] + globalCounts['A'];
-letterCounts[1] = globalCounts['b'] + globalCounts['B'];
-letterCounts[2] = globalCounts['c'] + globalCounts['C'];
-letterCounts[3] = globalCounts['d'] + globalCounts['D'];
-letterCounts[4] = globalCounts['e'] + globalCounts['E'];
-letterCounts[5] = globalCounts['f'] + globalCounts['F'];
-letterCounts[6] = globalCounts['g'] + globalCounts['G'];
-letterCounts[7] = globalCounts['h'] + globalCounts['H'];
-letterCounts[8] = globalCounts['i'] + globalCounts['I'];
-letterCounts[9] = globalCounts['j'] + globalCounts['J'];
-letterCounts[10] = globalCounts['k'] + globalCounts['K'];
-letterCounts[11] = globalCounts['l'] + globalCounts['L'];
-letterCounts[12] = globalCounts['m'] + globalCounts['M'];
-letterCounts[13] = globalCounts['n'] + globalCounts['N'];
-letterCounts[14] = globalCounts['o'] + globalCounts['O'];
-letterCounts[15] = globalCounts['p'] + globalCounts['P'];
-letterCounts[16] = globalCounts['q'] + globalCounts['Q'];
-letterCounts[17] = globalCounts['r'] + globalCounts['R'];
-letterCounts[18] = globalCounts['s'] + globalCounts['S'];
-letterCounts[19] = globalCounts['t'] + globalCounts['T'];
-letterCounts[20] = globalCounts['u'] + globalCounts['U'];
-letterCounts[21] = globalCounts['v'] + globalCounts['V'];
-letterCounts[22] = globalCounts['w'] + globalCounts['W'];
-letterCounts[23] = globalCounts['x'] + globalCounts['X'];
-letterCounts[24] = globalCounts['y'] + globalCounts['Y'];
-letterCounts[25] = globalCounts['z'] + globalCounts['Z'];
-
-digitCounts[0] = globalCounts['0'];
-digitCounts[1] = globalCounts['1'];
-digitCounts[2] = globalCounts['2'];
-digitCounts[3] = globalCounts['3'];
-digitCounts[4] = globalCounts['4'];
-digitCounts[5] = globalCounts['5'];
-digitCounts[6] = globalCounts['6'];
-digitCounts[7] = globalCounts['7'];
-digitCounts[8] = globalCounts['8'];
-digitCounts[9] = globalCounts['9'];
-
-    wait(NULL); 
     return vowelCount;
 }
 
-// Getters (Required by Main)
-int* getLetterCounts() { return letterCounts; }
-int* getDigitCounts() { return digitCounts; }
+// Private table per worker, padded to whole cache lines so no two workers
+// ever write to the same line
+typedef struct {
+    uint64_t counts[256];
+    uint64_t vowelCount;
+    uint64_t hash;
+    const VowelStats* stats;
+    const char* buf;
+    size_t size;
+    uint64_t offset;
+    bool count;
+    bool hashing;
+} __attribute__((aligned(64))) HistogramWorker;
+
+static void histogramWorker(void* arg) {
+    HistogramWorker* worker = (HistogramWorker*)arg;
+    worker->vowelCount = histogramRange(worker->stats, worker->buf, worker->size,
+                                        worker->count ? worker->counts : NULL, worker->offset,
+                                        worker->hashing ? &worker->hash : NULL);
+}
+
+// Splits buf (byte `offset` on of the input) across the workers, then merges
+// their tables into counts and their hash terms into *hash. Either may be NULL.
+static uint64_t parallelHistogram(const VowelStats* stats, const char* buf, size_t size,
+                                  uint64_t* counts, uint64_t offset, uint64_t* hash) {
+    long workers = workerCount(stats, size);
+    if (workers <= 1) return histogramRange(stats, buf, size, counts, offset, hash);
+
+    HistogramWorker* pool = (HistogramWorker*)aligned_alloc(64, workers * sizeof(HistogramWorker));
+    if (pool == NULL) return histogramRange(stats, buf, size, counts, offset, hash);
+
+    size_t slice = size / workers;
+    for (long w = 0; w < workers; w++) {
+        memset(pool[w].counts, 0, sizeof(pool[w].counts));
+        pool[w].hash = 0;
+        pool[w].stats = stats;
+        pool[w].buf = buf + w * slice;
+        pool[w].size = (w == workers - 1) ? size - w * slice : slice;
+        pool[w].offset = offset + w * slice;
+        pool[w].count = counts != NULL;
+        pool[w].hashing = hash != NULL;
+    }
+    runWorkers(stats, workers, histogramWorker, pool, sizeof(HistogramWorker));
+
+    uint64_t vowelCount = 0;
+    for (long w = 0; w < workers; w++) {
+        if (counts != NULL) {
+            for (int c = 0; c < 256; c++) counts[c] += pool[w].counts[c];
+        }
+        if (hash != NULL) *hash += pool[w].hash;
+        vowelCount += pool[w].vowelCount;
+    }
+
+    free(pool);
+    return vowelCount;
+}
+
+// Folds the byte histogram into the legacy letter/digit tables
+static void consolidateCounts(VowelStatsResult* result) {
+    // Consolidate Results - unrolled
+result->letterCounts[0] = result->byteCounts['a'] + result->byteCounts['A'];
+result->letterCounts[1] = result->byteCounts['b'] + result->byteCounts['B'];
+result->letterCounts[2] = result->byteCounts['c'] + result->byteCounts['C'];
+result->letterCounts[3] = result->byteCounts['d'] + result->byteCounts['D'];
+result->letterCounts[4] = result->byteCounts['e'] + result->byteCounts['E'];
+result->letterCounts[5] = result->byteCounts['f'] + result->byteCounts['F'];
+result->letterCounts[6] = result->byteCounts['g'] + result->byteCounts['G'];
+result->letterCounts[7] = result->byteCounts['h'] + result->byteCounts['H'];
+result->letterCounts[8] = result->byteCounts['i'] + result->byteCounts['I'];
+result->letterCounts[9] = result->byteCounts['j'] + result->byteCounts['J'];
+result->letterCounts[10] = result->byteCounts['k'] + result->byteCounts['K'];
+result->letterCounts[11] = result->byteCounts['l'] + result->byteCounts['L'];
+result->letterCounts[12] = result->byteCounts['m'] + result->byteCounts['M'];
+result->letterCounts[13] = result->byteCounts['n'] + result->byteCounts['N'];
+result->letterCounts[14] = result->byteCounts['o'] + result->byteCounts['O'];
+result->letterCounts[15] = result->byteCounts['p'] + result->byteCounts['P'];
+result->letterCounts[16] = result->byteCounts['q'] + result->byteCounts['Q'];
+result->letterCounts[17] = result->byteCounts['r'] + result->byteCounts['R'];
+result->letterCounts[18] = result->byteCounts['s'] + result->byteCounts['S'];
+result->letterCounts[19] = result->byteCounts['t'] + result->byteCounts['T'];
+result->letterCounts[20] = result->byteCounts['u'] + result->byteCounts['U'];
+result->letterCounts[21] = result->byteCounts['v'] + result->byteCounts['V'];
+result->letterCounts[22] = result->byteCounts['w'] + result->byteCounts['W'];
+result->letterCounts[23] = result->byteCounts['x'] + result->byteCounts['X'];
+result->letterCounts[24] = result->byteCounts['y'] + result->byteCounts['Y'];
+result->letterCounts[25] = result->byteCounts['z'] + result->byteCounts['Z'];
+
+result->digitCounts[0] = result->byteCounts['0'];
+result->digitCounts[1] = result->byteCounts['1'];
+result->digitCounts[2] = result->byteCounts['2'];
+result->digitCounts[3] = result->byteCounts['3'];
+result->digitCounts[4] = result->byteCounts['4'];
+result->digitCounts[5] = result->byteCounts['5'];
+result->digitCounts[6] = result->byteCounts['6'];
+result->digitCounts[7] = result->byteCounts['7'];
+result->digitCounts[8] = result->byteCounts['8'];
+result->digitCounts[9] = result->byteCounts['9'];
+
+}
+
+// ==========================================
+// UTF-8 STATISTICS
+// ==========================================
+
+// Adds the code points and errors the decoder emits on bytes [first, last)
+// of buf[0..size). Started at the sync point before `first`, it is in the
+// same state at `first` as a decoder that read from the beginning; a
+// sequence running past `last` counts in the range holding its final byte.
+static void utf8Range(const VowelStats* stats, const char* buf, size_t size, size_t first, size_t last,
+                      Utf8Counts* counts) {
+    Utf8Decoder decoder;
+    Utf8Counts previous; // Emitted before `first`: the previous range has them
+    memset(&previous, 0, sizeof(previous));
+    utf8DecoderInit(&decoder);
+    size_t sync = utf8SyncPoint(buf, first);
+    utf8DecoderFeed(&decoder, buf + sync, first - sync, stats->simd->highBytes, &previous);
+    utf8DecoderFeed(&decoder, buf + first, last - first, stats->simd->highBytes, counts);
+    if (last == size) utf8DecoderFinish(&decoder, counts);
+}
+
+typedef struct {
+    Utf8Counts counts;
+    const VowelStats* stats;
+    const char* buf;
+    size_t size;
+    size_t first;
+    size_t last;
+} __attribute__((aligned(64))) Utf8Worker;
+
+static void utf8Worker(void* arg) {
+    Utf8Worker* worker = (Utf8Worker*)arg;
+    utf8Range(worker->stats, worker->buf, worker->size, worker->first, worker->last, &worker->counts);
+}
+
+// Splits [first, last) across the workers like the histogram
+static void parallelUtf8(const VowelStats* stats, const char* buf, size_t size, size_t first, size_t last,
+                         Utf8Counts* counts) {
+    long workers = workerCount(stats, last - first);
+    Utf8Worker* pool = workers > 1 ? (Utf8Worker*)aligned_alloc(64, workers * sizeof(Utf8Worker)) : NULL;
+    if (pool == NULL) {
+        utf8Range(stats, buf, size, first, last, counts);
+        return;
+    }
+
+    size_t slice = (last - first) / workers;
+    for (long w = 0; w < workers; w++) {
+        memset(&pool[w].counts, 0, sizeof(pool[w].counts));
+        pool[w].stats = stats;
+        pool[w].buf = buf;
+        pool[w].size = size;
+        pool[w].first = first + w * slice;
+        pool[w].last = (w == workers - 1) ? last : first + (w + 1) * slice;
+    }
+    runWorkers(stats, workers, utf8Worker, pool, sizeof(Utf8Worker));
+    for (long w = 0; w < workers; w++) utf8CountsMerge(counts, &pool[w].counts);
+    free(pool);
+}
+
+// ==========================================
+// STREAMING MODE (Bounded Memory)
+// ==========================================
+
+static void resetResult(const VowelStats* stats, VowelStatsResult* result) {
+    memset(result, 0, sizeof(*result));
+    result->bestHammingIndex = -1;
+    result->patternCount = stats->patternSet ? patternSetCount(stats->patternSet) : 0;
+    result->hasUtf8 = runsPass(stats, VOWEL_STATS_UTF8);
+}
+
+int vowelStatsStreamBegin(VowelStats* stats) {
+    ensurePool(stats);
+    resetResult(stats, &stats->stream);
+    utf8DecoderInit(&stats->streamUtf8);
+    prefixMatcherFree(stats->streamPiMatcher);
+    patternMatchFree(stats->streamPatterns);
+    bool kmp = stats->useKmpPrefix && runsPass(stats, VOWEL_STATS_PI_PREFIX);
+    bool patterns = stats->patternSet != NULL && runsPass(stats, VOWEL_STATS_PATTERNS);
+    stats->streamPiMatcher = kmp ? prefixMatcherCreate(piDigits, PI_LENGTH) : NULL;
+    stats->streamPatterns = patterns ? patternMatchCreate(stats->patternSet) : NULL;
+    if ((kmp && stats->streamPiMatcher == NULL) || (patterns && stats->streamPatterns == NULL)) {
+        return -1;
+    }
+
+    size_t capacity = STREAM_OVERLAP;
+    if (patterns && patternSetMaxLength(stats->patternSet) > capacity) {
+        capacity = patternSetMaxLength(stats->patternSet);
+    }
+    if (capacity != stats->streamTailCapacity) {
+        free(stats->streamTail);
+        stats->streamTail = (char*)malloc(capacity);
+        stats->streamTailCapacity = stats->streamTail != NULL ? capacity : 0;
+        if (stats->streamTail == NULL) return -1;
+    }
+    stats->streamTailLength = 0;
+    return 0;
+}
+
+// Appends fresh bytes to the retained tail, keeping the last streamTailCapacity
+static void keepStreamTail(VowelStats* stats, const char* fresh, size_t length) {
+    char* tail = stats->streamTail;
+    size_t capacity = stats->streamTailCapacity;
+    if (length >= capacity) {
+        memcpy(tail, fresh + length - capacity, capacity);
+        stats->streamTailLength = capacity;
+        return;
+    }
+    size_t keep = stats->streamTailLength < capacity - length ? stats->streamTailLength : capacity - length;
+    memmove(tail, tail + stats->streamTailLength - keep, keep);
+    memcpy(tail + keep, fresh, length);
+    stats->streamTailLength = keep + length;
+}
+
+void vowelStatsStreamProcess(VowelStats* stats, const char* window, size_t carry, size_t fresh) {
+    VowelStatsResult* stream = &stats->stream;
+    size_t length = carry + fresh;
+    uint64_t windowStart = stream->size - carry;
+
+    // Histogram, vowels and hash: fresh bytes only, the carry was counted
+    // last time (the hash may read back into it for the first word)
+    bool histogram = runsPass(stats, VOWEL_STATS_HISTOGRAM);
+    if (histogram || runsPass(stats, VOWEL_STATS_HASH)) {
+        stream->vowelCount += parallelHistogram(stats, window + carry, fresh,
+                                                histogram ? stream->byteCounts : NULL, stream->size,
+                                                runsPass(stats, VOWEL_STATS_HASH) ? &stream->contentHash : NULL);
+    }
+
+    // Sparse addresses: next global multiple of 1000 at or after the fresh bytes
+    uint64_t nextSparse = (stream->size + 999) / 1000 * 1000;
+    if (runsPass(stats, VOWEL_STATS_SPARSE) && nextSparse < stream->size + fresh) {
+        sparseRange(stats, window, (size_t)(nextSparse - windowStart), length, &stream->sparse);
+    }
+
+    // Pi kernels: starts that now have all 100 bytes in view. The carry holds
+    // exactly the starts the previous window could not finish.
+    if (length >= PI_LENGTH) {
+        size_t last = length - PI_LENGTH + 1;
+        int64_t previousBest = stream->bestHammingIndex;
+        if (!stats->useKmpPrefix && runsPass(stats, VOWEL_STATS_PI_PREFIX)) {
+            stream->longestPiMatch = piMatchRange(stats, window, 0, last, stream->longestPiMatch);
+        }
+        if (runsPass(stats, VOWEL_STATS_HAMMING)) {
+            hammingRange(stats, window, 0, last, windowStart,
+                         &stream->bestHammingScore, &stream->bestHammingIndex);
+        }
+        if (stream->bestHammingIndex != previousBest) {
+            // Keep a copy, the chunk it came from is about to go
+            memcpy(stream->bestHammingWindow, window + (stream->bestHammingIndex - windowStart), PI_LENGTH);
+        }
+    }
+
+    // KMP and the pattern set carry their state over, so fresh bytes only
+    if (stats->streamPiMatcher != NULL) {
+        prefixMatcherFeed(stats->streamPiMatcher, window + carry, fresh);
+        stream->longestPiMatch = prefixMatcherLongest(stats->streamPiMatcher);
+    }
+    if (stats->streamPatterns != NULL) patternMatchFeed(stats->streamPatterns, window + carry, fresh);
+    if (runsPass(stats, VOWEL_STATS_UTF8)) {
+        utf8DecoderFeed(&stats->streamUtf8, window + carry, fresh, stats->simd->highBytes, &stream->utf8);
+    }
+
+    keepStreamTail(stats, window + carry, fresh);
+    stream->size += fresh;
+}
+
+void vowelStatsStreamEnd(VowelStats* stats, VowelStatsResult* result) {
+    if (stats->streamPatterns != NULL) collectPatternMatches(stats->streamPatterns, &stats->stream);
+    if (runsPass(stats, VOWEL_STATS_UTF8)) utf8DecoderFinish(&stats->streamUtf8, &stats->stream.utf8);
+    prefixMatcherFree(stats->streamPiMatcher);
+    patternMatchFree(stats->streamPatterns);
+    stats->streamPiMatcher = NULL;
+    stats->streamPatterns = NULL;
+    consolidateCounts(&stats->stream);
+    *result = stats->stream;
+    // The starts the last window could not finish, cut short at the end. The
+    // result only: appended bytes may still complete them.
+    if (!stats->useKmpPrefix && runsPass(stats, VOWEL_STATS_PI_PREFIX)) {
+        size_t unfinished = result->size < STREAM_OVERLAP ? (size_t)result->size : STREAM_OVERLAP;
+        const char* end = stats->streamTail + stats->streamTailLength;
+        result->longestPiMatch = piMatchTail(stats, end - unfinished, 0, unfinished, unfinished,
+                                             result->longestPiMatch);
+    }
+    if (runsPass(stats, VOWEL_STATS_HASH)) {
+        result->contentHash += contentHashEnd(stats->streamTail + stats->streamTailLength, result->size);
+    }
+}
+
+// ==========================================
+// CHECKPOINTS (Append-Only Inputs)
+// ==========================================
+
+// Checkpoint file: the magic, then little-endian 64-bit fields in this order,
+// then the retained tail bytes -
+//   version, passes, kmpPrefix, patternHash (0 without a pattern set),
+//   prefixHash, tailLength;
+//   the stream result before StreamEnd: size, vowelCount, byteCounts[256],
+//   longestPiMatch, bestHammingScore, bestHammingIndex, the four sparse
+//   tallies, patternLongest[patternCount], the UTF-8 counts (codePoints,
+//   invalid, lengths[4], scripts[UTF8_SCRIPT_COUNT], accentedVowels[5])
+//   without the pending sequence, contentHash;
+//   the UTF-8 decoder (state, codePoint, length);
+//   bestHammingWindow as VOWEL_STATS_PI_LENGTH raw bytes.
+// The option fields catch a context whose results would differ. Threads,
+// vector level and engines other than the prefix one give identical results,
+// so they are not recorded. prefixHash is the content hash of the bytes the
+// checkpoint covers, as the hash pass gives for them alone.
+#define CHECKPOINT_MAGIC "VSTATCKP"
+#define CHECKPOINT_VERSION 2
+
+typedef struct {
+    char magic[8];
+    uint64_t version;
+    uint64_t passes;
+    uint64_t kmpPrefix;
+    uint64_t patternHash;
+    uint64_t prefixHash;
+    uint64_t tailLength;
+} CheckpointHeader;
+
+// One pass over the layout serves both directions: writing stores each
+// field, reading overwrites it. The first failure sticks in status.
+typedef struct {
+    FILE* file;
+    bool writing;
+    int status;
+} CheckpointIo;
+
+static void checkpointBytes(CheckpointIo* io, char* bytes, size_t length) {
+    if (io->status != 0) return;
+    size_t done = io->writing ? fwrite(bytes, 1, length, io->file) : fread(bytes, 1, length, io->file);
+    if (done != length) io->status = -1;
+}
+
+static void checkpointField(CheckpointIo* io, uint64_t* value) {
+    unsigned char bytes[8];
+    if (io->writing) {
+        for (int i = 0; i < 8; i++) bytes[i] = (unsigned char)(*value >> (8 * i));
+    }
+    checkpointBytes(io, (char*)bytes, sizeof(bytes));
+    if (!io->writing && io->status == 0) {
+        *value = 0;
+        for (int i = 7; i >= 0; i--) *value = *value << 8 | bytes[i];
+    }
+}
+
+// Fields of other integer types go through a uint64_t (signed ones as two's complement)
+#define CHECKPOINT_INT(io, field)                 \
+    do {                                          \
+        uint64_t value_ = (uint64_t)(field);      \
+        checkpointField(io, &value_);             \
+        (field) = (__typeof__(field))value_;      \
+    } while (0)
+
+static void checkpointFields(CheckpointIo* io, uint64_t* fields, size_t count) {
+    for (size_t i = 0; i < count; i++) checkpointField(io, &fields[i]);
+}
+
+static void checkpointHeader(CheckpointIo* io, CheckpointHeader* header) {
+    checkpointBytes(io, header->magic, sizeof(header->magic));
+    checkpointField(io, &header->version);
+    checkpointField(io, &header->passes);
+    checkpointField(io, &header->kmpPrefix);
+    checkpointField(io, &header->patternHash);
+    checkpointField(io, &header->prefixHash);
+    checkpointField(io, &header->tailLength);
+}
+
+// patternCount is not stored: the pattern hash has already matched the set
+static void checkpointStream(CheckpointIo* io, VowelStatsResult* stream, Utf8Decoder* utf8) {
+    checkpointField(io, &stream->size);
+    checkpointField(io, &stream->vowelCount);
+    checkpointFields(io, stream->byteCounts, 256);
+    CHECKPOINT_INT(io, stream->longestPiMatch);
+    CHECKPOINT_INT(io, stream->bestHammingScore);
+    CHECKPOINT_INT(io, stream->bestHammingIndex);
+    checkpointField(io, &stream->sparse.positionsChecked);
+    checkpointField(io, &stream->sparse.count3);
+    checkpointField(io, &stream->sparse.vowelCount);
+    checkpointField(io, &stream->sparse.digitCount);
+    for (int p = 0; p < stream->patternCount; p++) CHECKPOINT_INT(io, stream->patternLongest[p]);
+    checkpointField(io, &stream->utf8.codePoints);
+    checkpointField(io, &stream->utf8.invalid);
+    checkpointFields(io, stream->utf8.lengths, 4);
+    checkpointFields(io, stream->utf8.scripts, UTF8_SCRIPT_COUNT);
+    checkpointFields(io, stream->utf8.accentedVowels, 5);
+    checkpointField(io, &stream->contentHash);
+    CHECKPOINT_INT(io, utf8->state);
+    CHECKPOINT_INT(io, utf8->codePoint);
+    CHECKPOINT_INT(io, utf8->length);
+    checkpointBytes(io, stream->bestHammingWindow, VOWEL_STATS_PI_LENGTH);
+}
+
+static void fillCheckpointHeader(const VowelStats* stats, CheckpointHeader* header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic));
+    header->version = CHECKPOINT_VERSION;
+    header->passes = stats->passes;
+    header->kmpPrefix = stats->useKmpPrefix;
+    header->patternHash = stats->patternSet != NULL ? patternSetHash(stats->patternSet) : 0;
+}
+
+int vowelStatsStreamSave(const VowelStats* stats, const char* path) {
+    if (stats->streamTail == NULL || !runsPass(stats, VOWEL_STATS_HASH)) return -1;
+
+    CheckpointHeader header;
+    fillCheckpointHeader(stats, &header);
+    // The whole words so far are in the stream's hash; the tail holds the partial last one
+    header.prefixHash = stats->stream.contentHash +
+                        contentHashEnd(stats->streamTail + stats->streamTailLength, stats->stream.size);
+    header.tailLength = stats->streamTailLength;
+    VowelStatsResult stream = stats->stream;
+    Utf8Decoder utf8 = stats->streamUtf8;
+    if (stats->streamPatterns != NULL) collectPatternMatches(stats->streamPatterns, &stream);
+
+    // Written beside the old checkpoint and renamed over it, so a crash
+    // leaves one or the other
+    size_t pathLength = strlen(path);
+    char* temporary = (char*)malloc(pathLength + 5);
+    if (temporary == NULL) return -1;
+    memcpy(temporary, path, pathLength);
+    memcpy(temporary + pathLength, ".tmp", 5);
+
+    CheckpointIo io = { fopen(temporary, "wb"), true, 0 };
+    if (io.file == NULL) io.status = -1;
+    checkpointHeader(&io, &header);
+    checkpointStream(&io, &stream, &utf8);
+    checkpointBytes(&io, stats->streamTail, header.tailLength);
+    if (io.file != NULL && fclose(io.file) != 0) io.status = -1;
+    if (io.status == 0 && rename(temporary, path) != 0) io.status = -1;
+    if (io.status != 0) remove(temporary);
+    free(temporary);
+    return io.status;
+}
+
+int vowelStatsStreamResume(VowelStats* stats, const char* path, uint64_t* size, uint64_t* prefixHash) {
+    CheckpointIo io = { fopen(path, "rb"), false, 0 };
+    if (io.file == NULL) return -1;
+
+    CheckpointHeader header;
+    CheckpointHeader expected;
+    fillCheckpointHeader(stats, &expected);
+    checkpointHeader(&io, &header);
+    if (io.status == 0 && (memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+                           header.version != expected.version || header.passes != expected.passes ||
+                           header.kmpPrefix != expected.kmpPrefix || header.patternHash != expected.patternHash ||
+                           !runsPass(stats, VOWEL_STATS_HASH))) {
+        io.status = -1;
+    }
+    if (io.status == 0 && vowelStatsStreamBegin(stats) != 0) io.status = -1;
+
+    // Fields the file does not store (patternCount, hasUtf8) come from the fresh stream
+    VowelStatsResult stream = stats->stream;
+    Utf8Decoder utf8 = stats->streamUtf8;
+    checkpointStream(&io, &stream, &utf8);
+    // The tail is always as long as the capacity allows
+    uint64_t fullTail = stream.size < stats->streamTailCapacity ? stream.size : stats->streamTailCapacity;
+    if (io.status == 0 && header.tailLength != fullTail) io.status = -1;
+    checkpointBytes(&io, stats->streamTail, (size_t)header.tailLength);
+    if (io.status == 0 && fgetc(io.file) != EOF) io.status = -1; // Trailing bytes: not this layout
+    fclose(io.file);
+    if (io.status != 0) return -1;
+
+    stats->stream = stream;
+    stats->streamUtf8 = utf8;
+    stats->streamTailLength = header.tailLength;
+    if (stats->streamPiMatcher != NULL) {
+        prefixMatcherResume(stats->streamPiMatcher, stats->streamTail, header.tailLength, stream.longestPiMatch);
+    }
+    if (stats->streamPatterns != NULL) {
+        patternMatchResume(stats->streamPatterns, stats->streamTail, header.tailLength, stream.patternLongest);
+    }
+    *size = stream.size;
+    *prefixHash = header.prefixHash;
+    return 0;
+}
+
+size_t vowelStatsStreamTail(const VowelStats* stats, char* carry) {
+    size_t length = stats->streamTailLength < STREAM_OVERLAP ? stats->streamTailLength : STREAM_OVERLAP;
+    memcpy(carry, stats->streamTail + stats->streamTailLength - length, length);
+    return length;
+}
+
+// ==========================================
+// CORE OPTIMIZATION: Main Entry + Side Job
+// ==========================================
+
+void vowelStatsSetFusedBlock(VowelStats* stats, size_t blockBytes) {
+    stats->fusedBlock = blockBytes;
+}
+
+// One read of the buffer: each block goes through the streaming kernels while
+// it is still in cache. The carry is just the 99 bytes before the block, so
+// no copy is needed.
+static int fusedAnalyze(VowelStats* stats, const char* buf, size_t size, VowelStatsResult* result) {
+    if (vowelStatsStreamBegin(stats) != 0) return -1;
+    for (size_t offset = 0; offset < size; offset += stats->fusedBlock) {
+        size_t carry = offset < STREAM_OVERLAP ? offset : STREAM_OVERLAP;
+        size_t fresh = size - offset < stats->fusedBlock ? size - offset : stats->fusedBlock;
+        vowelStatsStreamProcess(stats, buf + offset - carry, carry, fresh);
+    }
+    vowelStatsStreamEnd(stats, result);
+    return 0;
+}
+
+// The pi, Hamming, sparse and pattern passes, run beside the histogram. Each
+// writes its own fields of the result, so the two sides never share a counter.
+typedef struct {
+    const VowelStats* stats;
+    const char* buf;
+    size_t size;
+    VowelStatsResult* result;
+    int status;
+} SidePasses;
+
+static void sidePassesWorker(void* arg) {
+    SidePasses* job = (SidePasses*)arg;
+    if (runsPass(job->stats, VOWEL_STATS_PI_PREFIX)) {
+        job->result->longestPiMatch = findLongestPiMatch(job->stats, job->buf, job->size);
+    }
+    if (runsPass(job->stats, VOWEL_STATS_HAMMING)) {
+        findBestHammingMatch(job->stats, job->buf, job->size, job->result);
+    }
+    if (runsPass(job->stats, VOWEL_STATS_SPARSE)) {
+        sparseRange(job->stats, job->buf, 0, job->size, &job->result->sparse);
+    }
+    job->status = findLongestPatternMatches(job->stats, job->buf, job->size, job->result);
+}
+
+// Histogram and hash of the whole buffer, into a fresh result
+static void countWholeBuffer(const VowelStats* stats, const char* buf, size_t size, bool hashing,
+                             VowelStatsResult* result) {
+    bool histogram = runsPass(stats, VOWEL_STATS_HISTOGRAM);
+    if (!histogram && !hashing) return;
+    result->vowelCount = parallelHistogram(stats, buf, size, histogram ? result->byteCounts : NULL, 0,
+                                           hashing ? &result->contentHash : NULL);
+    if (hashing) result->contentHash += contentHashEnd(buf + size, size);
+    if (histogram) consolidateCounts(result);
+}
+
+// The multi-pass design; `counted` when countWholeBuffer() already ran
+static int multiPassAnalyze(VowelStats* stats, const char* buf, size_t size, bool counted,
+                            VowelStatsResult* result) {
+    // PARALLELISM: the pi passes run as a pool job while this thread counts
+    SidePasses job = { stats, buf, size, result, 0 };
+    JobGroup group;
+    if (stats->pool != NULL) {
+        jobGroupInit(&group);
+        jobPoolSubmit(stats->pool, &group, sidePassesWorker, &job);
+    }
+
+    // Count vowels (CPU Bound, split across worker threads)
+    if (!counted) countWholeBuffer(stats, buf, size, runsPass(stats, VOWEL_STATS_HASH), result);
+    if (runsPass(stats, VOWEL_STATS_UTF8)) parallelUtf8(stats, buf, size, 0, size, &result->utf8);
+
+    if (stats->pool != NULL) {
+        jobPoolWait(stats->pool, &group);
+        jobGroupDestroy(&group);
+    } else {
+        sidePassesWorker(&job);
+    }
+    return job.status;
+}
+
+// ==========================================
+// RESULT CACHE (Identical Inputs)
+// ==========================================
+
+void vowelStatsSetCache(VowelStats* stats, ResultCache* cache) {
+    stats->cache = cache;
+}
+
+// The prefix and Hamming engines; they agree on every input, but each keeps
+// entries of its own so one can never be served another's result
+static unsigned cacheEngines(const VowelStats* stats) {
+    return (unsigned)stats->useKmpPrefix | (unsigned)(stats->templatePrefix != NULL) << 1 |
+           (unsigned)stats->useBitsetBackend << 2 | (unsigned)stats->useQgramBackend << 3 |
+           (unsigned)(stats->templateHamming != NULL) << 4;
+}
+
+// Like a checkpoint, only options that change the result count: passes, the
+// engines and the pattern set, plus the result layout of this build
+static uint64_t cacheOptions(const VowelStats* stats) {
+    uint64_t options = stats->patternSet != NULL ? patternSetHash(stats->patternSet) : 0;
+    options ^= ((uint64_t)sizeof(VowelStatsResult) << 32) | cacheEngines(stats) << 16 |
+               (stats->passes | VOWEL_STATS_HASH);
+    return options;
+}
+
+// The histogram pass hashes the input as it counts; the other passes - the
+// Hamming search above all - only run on a miss. They then run after the
+// count instead of beside it, which costs a miss one histogram pass of
+// overlap. A fused miss streams the whole buffer, histogram included, so the
+// overlap is the same.
+static int cachedAnalyze(VowelStats* stats, const char* buf, size_t size, VowelStatsResult* result) {
+    countWholeBuffer(stats, buf, size, true, result);
+    ResultCacheKey key = { result->contentHash, size, cacheOptions(stats) };
+    if (resultCacheLoad(stats->cache, &key, result, sizeof(*result)) == 0) return 0;
+
+    int status;
+    if (stats->fusedBlock > 0) {
+        status = fusedAnalyze(stats, buf, size, result);
+        result->contentHash = key.contentHash;
+    } else {
+        status = multiPassAnalyze(stats, buf, size, true, result);
+    }
+    if (status == 0) resultCacheStore(stats->cache, &key, result, sizeof(*result));
+    return status;
+}
+
+int vowelStatsAnalyze(VowelStats* stats, const char* buf, size_t size, VowelStatsResult* result) {
+    ensurePool(stats);
+    resetResult(stats, result);
+    result->size = size;
+    if (stats->cache != NULL) return cachedAnalyze(stats, buf, size, result);
+    if (stats->fusedBlock > 0) return fusedAnalyze(stats, buf, size, result);
+    return multiPassAnalyze(stats, buf, size, false, result);
+}
+
+// ==========================================
+// PARTS (Callers That Split One Buffer)
+// ==========================================
+
+int vowelStatsAnalyzePart(VowelStats* stats, const char* buf, size_t size, size_t first, size_t last,
+                          VowelStatsResult* part) {
+    ensurePool(stats);
+    resetResult(stats, part);
+    part->size = last - first;
+    bool histogram = runsPass(stats, VOWEL_STATS_HISTOGRAM);
+    bool hashing = runsPass(stats, VOWEL_STATS_HASH);
+    if (histogram || hashing) {
+        part->vowelCount = parallelHistogram(stats, buf + first, last - first, histogram ? part->byteCounts : NULL,
+                                             first, hashing ? &part->contentHash : NULL);
+        if (hashing && last == size && first < last) part->contentHash += contentHashEnd(buf + size, size);
+        if (histogram) consolidateCounts(part);
+    }
+    if (runsPass(stats, VOWEL_STATS_UTF8)) parallelUtf8(stats, buf, size, first, last, &part->utf8);
+
+    size_t nextSparse = (first + 999) / 1000 * 1000;
+    if (runsPass(stats, VOWEL_STATS_SPARSE) && nextSparse < last) {
+        sparseRange(stats, buf, nextSparse, last, &part->sparse);
+    }
+
+    // Range kernels: the starts in [first, last) that have all 100 bytes in
+    // view, then (for pi prefixes) those cut short by the end of the input
+    size_t tail = piTailStart(size);
+    size_t lastStart = tail < last ? tail : last;
+    if (!stats->useKmpPrefix && runsPass(stats, VOWEL_STATS_PI_PREFIX) && last > tail) {
+        part->longestPiMatch = piMatchTail(stats, buf, first > tail ? first : tail, last, size, 0);
+    }
+    if (first < lastStart) {
+        if (!stats->useKmpPrefix && runsPass(stats, VOWEL_STATS_PI_PREFIX)) {
+            part->longestPiMatch = piMatchRange(stats, buf, first, lastStart, part->longestPiMatch);
+        }
+        if (runsPass(stats, VOWEL_STATS_HAMMING)) {
+            hammingRange(stats, buf, first, lastStart, 0, &part->bestHammingScore, &part->bestHammingIndex);
+        }
+        if (part->bestHammingIndex >= 0) {
+            memcpy(part->bestHammingWindow, buf + part->bestHammingIndex, PI_LENGTH);
+        }
+    }
+
+    // Stateful matchers start fresh at `first` and read on as far as a match
+    // starting before `last` can reach. The overlap with the next part only
+    // sees prefixes that part finds in full, so the merged maximum is exact.
+    if (stats->useKmpPrefix && runsPass(stats, VOWEL_STATS_PI_PREFIX)) {
+        PrefixMatcher* matcher = prefixMatcherCreate(piDigits, PI_LENGTH);
+        if (matcher == NULL) return -1;
+        size_t end = size - last > PI_LENGTH - 1 ? last + PI_LENGTH - 1 : size;
+        prefixMatcherFeed(matcher, buf + first, end - first);
+        part->longestPiMatch = prefixMatcherLongest(matcher);
+        prefixMatcherFree(matcher);
+    }
+    if (stats->patternSet != NULL && runsPass(stats, VOWEL_STATS_PATTERNS)) {
+        PatternMatch* match = patternMatchCreate(stats->patternSet);
+        if (match == NULL) return -1;
+        size_t reach = patternSetMaxLength(stats->patternSet) - 1;
+        size_t end = size - last > reach ? last + reach : size;
+        patternMatchFeed(match, buf + first, end - first);
+        collectPatternMatches(match, part);
+        patternMatchFree(match);
+    }
+    return 0;
+}
+
+void vowelStatsMerge(VowelStatsResult* total, const VowelStatsResult* part) {
+    total->size += part->size;
+    total->vowelCount += part->vowelCount;
+    for (int c = 0; c < 256; c++) total->byteCounts[c] += part->byteCounts[c];
+    for (int i = 0; i < 26; i++) total->letterCounts[i] += part->letterCounts[i];
+    for (int i = 0; i < 10; i++) total->digitCounts[i] += part->digitCounts[i];
+    total->contentHash += part->contentHash; // Terms of disjoint words
+
+    if (part->longestPiMatch > total->longestPiMatch) total->longestPiMatch = part->longestPiMatch;
+
+    // Higher score wins, then the lower index, as in the sequential scan
+    if (part->bestHammingIndex >= 0 &&
+        (total->bestHammingIndex < 0 || part->bestHammingScore > total->bestHammingScore ||
+         (part->bestHammingScore == total->bestHammingScore &&
+          part->bestHammingIndex < total->bestHammingIndex))) {
+        total->bestHammingScore = part->bestHammingScore;
+        total->bestHammingIndex = part->bestHammingIndex;
+        memcpy(total->bestHammingWindow, part->bestHammingWindow, PI_LENGTH);
+    }
+
+    total->sparse.positionsChecked += part->sparse.positionsChecked;
+    total->sparse.count3 += part->sparse.count3;
+    total->sparse.vowelCount += part->sparse.vowelCount;
+    total->sparse.digitCount += part->sparse.digitCount;
+
+    for (int i = 0; i < total->patternCount; i++) {
+        if (part->patternLongest[i] > total->patternLongest[i]) {
+            total->patternLongest[i] = part->patternLongest[i];
+        }
+    }
+
+    if (part->hasUtf8) {
+        total->hasUtf8 = true;
+        utf8CountsMerge(&total->utf8, &part->utf8);
+    }
+}
+
+// ==========================================
+// REPORT
+// ==========================================
+
+static void printHammingMatch(FILE* out, const VowelStatsResult* result) {
+    fprintf(out, "=== Best Hamming Match to Pi (100 digits) ===\n");
+    fprintf(out, "Best index: %" PRId64 "\n", result->bestHammingIndex);
+    fprintf(out, "Hamming score: %d/100 matches\n", result->bestHammingScore);
+
+    if (result->bestHammingIndex >= 0) {
+        const char* bestPtr = result->bestHammingWindow;
+        fprintf(out, "Character-by-character comparison:\n");
+        fprintf(out, "Pi:  ");
+        for (int j = 0; j < PI_LENGTH; j++) fputc(piDigits[j], out);
+        fprintf(out, "\nBuf: ");
+        for (int j = 0; j < PI_LENGTH; j++) fputc(bestPtr[j], out);
+        fprintf(out, "\n     ");
+        for (int j = 0; j < PI_LENGTH; j++) {
+            fputc((bestPtr[j] == piDigits[j]) ? '^' : ' ', out);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+static void printSparseStats(FILE* out, const VowelStatsSparse* stats) {
+    fprintf(out, "Positions checked: %" PRIu64 "\n", stats->positionsChecked);
+    fprintf(out, "Count of '3' at addresses divisible by 1000: %" PRIu64 "\n", stats->count3);
+    fprintf(out, "Vowels at sparse addresses: %" PRIu64 "\n", stats->vowelCount);
+    fprintf(out, "Digits at sparse addresses: %" PRIu64 "\n", stats->digitCount);
+}
+
+// The built-in pi reference is the report's own pi line; printing it again
+// would only repeat that line
+static bool isReportPi(const PatternSet* patterns, int index) {
+    return strcmp(patternSetName(patterns, index), "pi") == 0 && patternSetIsBuiltin(patterns, index);
+}
+
+// Everything the original prints from countVowels() itself
+static void printMatches(FILE* out, const VowelStatsResult* result, const PatternSet* patterns) {
+    fprintf(out, "Longest pi digit match found: %zu characters\n", result->longestPiMatch);
+    printHammingMatch(out, result);
+    printSparseStats(out, &result->sparse);
+    for (int i = 0; patterns != NULL && i < result->patternCount; i++) {
+        if (isReportPi(patterns, i)) continue;
+        // Only the built-in references are digits; a custom pattern may be any bytes
+        fprintf(out, "Longest %s %s match found: %zu characters\n", patternSetName(patterns, i),
+                patternSetIsBuiltin(patterns, i) ? "digit" : "prefix", result->patternLongest[i]);
+    }
+}
+
+// The printAllStats() line
+static void printCounts(FILE* out, const VowelStatsResult* result) {
+    fprintf(out, "Vowel count: %" PRIu64 ", Letters: [", result->vowelCount);
 
-void printAllStats(int vowelCount) {
-    printf("Vowel count: %d, Letters: [", vowelCount);
-    
     bool first = true;
     for (register int i = 0; i < 26; i++) {
-        if (letterCounts[i] > 0) {
-            if (!first) printf(", ");
-            printf("(%c,%d)", 'a' + i, letterCounts[i]);
+        if (result->letterCounts[i] > 0) {
+            if (!first) fprintf(out, ", ");
+            fprintf(out, "(%c,%" PRIu64 ")", 'a' + i, result->letterCounts[i]);
             first = false;
         }
     }
-    
-    printf("], Digits: [");
+
+    fprintf(out, "], Digits: [");
     first = true;
     for (int i = 0; i < 10; i++) {
-        if (digitCounts[i] > 0) {
-            if (!first) printf(", ");
-            printf("(%d,%d)", i, digitCounts[i]);
+        if (result->digitCounts[i] > 0) {
+            if (!first) fprintf(out, ", ");
+            fprintf(out, "(%d,%" PRIu64 ")", i, result->digitCounts[i]);
+            first = false;
+        }
+    }
+    fprintf(out, "]\n");
+}
+
+static const char accentedVowelBases[5] = { 'a', 'e', 'i', 'o', 'u' };
+
+// The UTF-8 pass, in the same (name,count) style as the letter line
+static void printUtf8(FILE* out, const Utf8Counts* utf8) {
+    fprintf(out, "UTF-8 code points: %" PRIu64 ", Invalid sequences: %" PRIu64
+            ", By length: [(1,%" PRIu64 "), (2,%" PRIu64 "), (3,%" PRIu64 "), (4,%" PRIu64 ")]\n",
+            utf8->codePoints, utf8->invalid, utf8->lengths[0], utf8->lengths[1], utf8->lengths[2],
+            utf8->lengths[3]);
+
+    fprintf(out, "Scripts: [");
+    bool first = true;
+    for (int i = 0; i < UTF8_SCRIPT_COUNT; i++) {
+        if (utf8->scripts[i] > 0) {
+            if (!first) fprintf(out, ", ");
+            fprintf(out, "(%s,%" PRIu64 ")", utf8ScriptName(i), utf8->scripts[i]);
+            first = false;
+        }
+    }
+
+    fprintf(out, "], Accented vowels: [");
+    first = true;
+    for (int i = 0; i < 5; i++) {
+        if (utf8->accentedVowels[i] > 0) {
+            if (!first) fprintf(out, ", ");
+            fprintf(out, "(%c,%" PRIu64 ")", accentedVowelBases[i], utf8->accentedVowels[i]);
             first = false;
         }
     }
-    printf("]\n");
+    fprintf(out, "]\n");
+}
+
+void vowelStatsPrint(FILE* out, const VowelStatsResult* result, const PatternSet* patterns) {
+    printMatches(out, result, patterns);
+    printCounts(out, result);
+    if (result->hasUtf8) printUtf8(out, &result->utf8);
+}
+
+// Byte classes for the totals line, in print order
+enum {
+    BYTE_CONTROL,
+    BYTE_SPACE,
+    BYTE_DIGIT,
+    BYTE_UPPER,
+    BYTE_LOWER,
+    BYTE_PUNCT,
+    BYTE_UTF8_CONTINUATION, // 80..BF
+    BYTE_UTF8_LEAD,         // C2..F4
+    BYTE_NOT_UTF8,          // C0, C1, F5..FF: in no well-formed UTF-8
+    BYTE_CLASS_COUNT
+};
+
+static const char* const byteClassNames[BYTE_CLASS_COUNT] = {
+    "control", "space", "digit", "upper", "lower", "punct", "utf8_continuation", "utf8_lead", "not_utf8",
+};
+
+static int byteClassOf(int c) {
+    if (c >= 0x80) {
+        if (c < 0xC0) return BYTE_UTF8_CONTINUATION;
+        return (c >= 0xC2 && c <= 0xF4) ? BYTE_UTF8_LEAD : BYTE_NOT_UTF8;
+    }
+    if (c == ' ' || (c >= '\t' && c <= '\r')) return BYTE_SPACE;
+    if (c < 0x20 || c == 0x7F) return BYTE_CONTROL;
+    if (c >= '0' && c <= '9') return BYTE_DIGIT;
+    if (c >= 'A' && c <= 'Z') return BYTE_UPPER;
+    if (c >= 'a' && c <= 'z') return BYTE_LOWER;
+    return BYTE_PUNCT;
+}
+
+void vowelStatsPrintBytes(FILE* out, const VowelStatsResult* result) {
+    uint64_t classTotals[BYTE_CLASS_COUNT] = { 0 };
+    for (int row = 0; row < 256; row += 8) {
+        fprintf(out, "Bytes 0x%02x-0x%02x:", row, row + 7);
+        for (int c = row; c < row + 8; c++) {
+            fprintf(out, " %" PRIu64, result->byteCounts[c]);
+            classTotals[byteClassOf(c)] += result->byteCounts[c];
+        }
+        fputc('\n', out);
+    }
+
+    fprintf(out, "Byte classes: [");
+    for (int i = 0; i < BYTE_CLASS_COUNT; i++) {
+        fprintf(out, i ? ", (%s,%" PRIu64 ")" : "(%s,%" PRIu64 ")", byteClassNames[i], classTotals[i]);
+    }
+    fprintf(out, "]\n");
+}
+
+static void printJsonString(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const unsigned char* c = (const unsigned char*)text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if (*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void printJsonArray(FILE* out, const uint64_t* values, int count) {
+    fputc('[', out);
+    for (int i = 0; i < count; i++) fprintf(out, i ? ",%" PRIu64 : "%" PRIu64, values[i]);
+    fputc(']', out);
+}
+
+void vowelStatsPrintJson(FILE* out, const char* name, const VowelStatsResult* result,
+                         const PatternSet* patterns) {
+    fprintf(out, "{\"file\":");
+    printJsonString(out, name);
+    if (result == NULL) {
+        fprintf(out, ",\"error\":\"unreadable\"}\n");
+        return;
+    }
+    fprintf(out, ",\"size\":%" PRIu64 ",\"vowels\":%" PRIu64 ",\"letters\":",
+            result->size, result->vowelCount);
+    printJsonArray(out, result->letterCounts, 26);
+    fprintf(out, ",\"digits\":");
+    printJsonArray(out, result->digitCounts, 10);
+    fprintf(out, ",\"longest_pi\":%zu,\"hamming_index\":%" PRId64 ",\"hamming_score\":%d",
+            result->longestPiMatch, result->bestHammingIndex, result->bestHammingScore);
+    fprintf(out, ",\"sparse\":{\"positions\":%" PRIu64 ",\"count3\":%" PRIu64
+            ",\"vowels\":%" PRIu64 ",\"digits\":%" PRIu64 "}",
+            result->sparse.positionsChecked, result->sparse.count3,
+            result->sparse.vowelCount, result->sparse.digitCount);
+    if (patterns != NULL && result->patternCount > 0) {
+        fprintf(out, ",\"patterns\":{");
+        for (int i = 0; i < result->patternCount; i++) {
+            if (i) fputc(',', out);
+            printJsonString(out, patternSetName(patterns, i));
+            fprintf(out, ":%zu", result->patternLongest[i]);
+        }
+        fputc('}', out);
+    }
+    if (result->hasUtf8) {
+        const Utf8Counts* utf8 = &result->utf8;
+        fprintf(out, ",\"utf8\":{\"code_points\":%" PRIu64 ",\"invalid\":%" PRIu64 ",\"lengths\":",
+                utf8->codePoints, utf8->invalid);
+        printJsonArray(out, utf8->lengths, 4);
+        fprintf(out, ",\"scripts\":{");
+        for (int i = 0; i < UTF8_SCRIPT_COUNT; i++) {
+            fprintf(out, i ? ",\"%s\":%" PRIu64 : "\"%s\":%" PRIu64, utf8ScriptName(i), utf8->scripts[i]);
+        }
+        fprintf(out, "},\"accented_vowels\":");
+        printJsonArray(out, utf8->accentedVowels, 5);
+        fputc('}', out);
+    }
+    fprintf(out, "}\n");
+}
+
+// ==========================================
+// BASELINE INTERFACE (Default Context)
+// ==========================================
+
+static VowelStats* defaultStats;     // Created by the first call, freed at exit
+static VowelStatsResult lastResult; // What printAllStats() reports
+
+static void freeDefaultStats(void) {
+    vowelStatsFree(defaultStats);
+}
+
+// Like the original, not reentrant: calls share the default context, its
+// workers and scratch buffers, and the result printAllStats() reports
+uint64_t countVowels(char* buf, size_t size) {
+    if (defaultStats == NULL) {
+        defaultStats = vowelStatsCreate();
+        if (defaultStats != NULL) atexit(freeDefaultStats);
+    }
+    if (defaultStats == NULL || vowelStatsAnalyze(defaultStats, buf, size, &lastResult) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    printMatches(stdout, &lastResult, NULL);
+    return lastResult.vowelCount;
+}
+
+// Getters (Required by Main)
+uint64_t* getLetterCounts() { return lastResult.letterCounts; }
+uint64_t* getDigitCounts() { return lastResult.digitCounts; }
+
+void printAllStats(uint64_t vowelCount) {
+    VowelStatsResult shown = lastResult;
+    shown.vowelCount = vowelCount;
+    printCounts(stdout, &shown);
 }
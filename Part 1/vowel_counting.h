@@ -0,0 +1,17 @@
+/* vowel_counting.h */
+/* Interface of the optimized vowel counter (vowel_counting.c) */
+
+#ifndef VOWEL_COUNTING_H
+#define VOWEL_COUNTING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "vowel_stats.h"
+
+// Baseline interface - vowel_counting_original.c provides the same functions.
+// The optimized build implements them on a default libvowelstats context
+// (vowel_stats.h), so a driver written against the original still links.
+uint64_t countVowels(char* buf, size_t size);
+void printAllStats(uint64_t vowelCount);
+
+#endif
@@ -3,13 +3,15 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
 
 // Simple, unoptimized vowel counting
 // This is the baseline implementation
 
 // Count array for each character
-int letterCounts[26];  // a-z counts
-int digitCounts[10];   // 0-9 counts
+uint64_t letterCounts[26];  // a-z counts
+uint64_t digitCounts[10];   // 0-9 counts
 
 bool isLowerVowel(char c) {
     if (c == 'a') return true;
@@ -227,19 +229,19 @@ void countCharacter(char c) {
 }
 
 // function to find longest string that matches pi digits
-int findLongestPiMatch(char* buf, int size) {
+size_t findLongestPiMatch(char* buf, size_t size) {
     // First 100 digits of pi: 3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067
     char piDigits[] = "3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067";
     int piLength = 100;
-    int longestMatch = 0;
+    size_t longestMatch = 0;
     
     // search - check every position for longest match
-    for (int i = 0; i < size; i++) {
-        int currentMatch = 0;
+    for (size_t i = 0; i < size; i++) {
+        size_t currentMatch = 0;
         bool isInRow = true;
         
         // Check how many consecutive pi digits match starting at position i
-        for (int j = 0; j < piLength && (i + j) < size; j++) {
+        for (size_t j = 0; j < (size_t)piLength && (i + j) < size; j++) {
             if (buf[i + j] == piDigits[j] && isInRow) {
                 currentMatch++;
             }
@@ -258,15 +260,15 @@ int findLongestPiMatch(char* buf, int size) {
 
 // Find the position with highest Hamming match to 100 digits of pi
 // Hamming match = count of positions where characters match (ignores mismatches in between)
-void findBestHammingMatch(char* buf, int size) {
+void findBestHammingMatch(char* buf, size_t size) {
     char piDigits[] = "3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067";
     int piLength = 100;
     
-    int bestIndex = -1;
+    int64_t bestIndex = -1;
     int bestHammingScore = 0;
     
     // Check every possible starting position in buffer
-    for (int i = 0; i <= size - piLength; i++) {
+    for (size_t i = 0; i + piLength <= size; i++) {
         int hammingScore = 0;
         
         // Count matching characters at each position (Hamming similarity)
@@ -285,7 +287,7 @@ void findBestHammingMatch(char* buf, int size) {
     
     // Print results
     printf("=== Best Hamming Match to Pi (100 digits) ===\n");
-    printf("Best index: %d\n", bestIndex);
+    printf("Best index: %" PRId64 "\n", bestIndex);
     printf("Hamming score: %d/100 matches\n", bestHammingScore);
     
     if (bestIndex >= 0) {
@@ -316,16 +318,16 @@ void findBestHammingMatch(char* buf, int size) {
 }
 
 // Counts characters at addresses divisible by 1000 (huge stride = cache miss every access)
-void analyzeAtSparseAddresses(char* buf, int size) {
-    int count3 = 0;        // How many times '3' appears at index % 1000 == 0
-    int vowelCount = 0;    // Vowels at those positions
-    int digitCount = 0;    // Digits at those positions
-    int positionsChecked = 0;
+void analyzeAtSparseAddresses(char* buf, size_t size) {
+    uint64_t count3 = 0;        // How many times '3' appears at index % 1000 == 0
+    uint64_t vowelCount = 0;    // Vowels at those positions
+    uint64_t digitCount = 0;    // Digits at those positions
+    uint64_t positionsChecked = 0;
     
     // Jump by 1000 each time - this is TERRIBLE for cache!
     // Each access is ~1000 bytes apart, far exceeding cache line size (64 bytes)
     // Every single access will likely be a cache miss
-    for (int i = 0; i < size; i += 1000) {
+    for (size_t i = 0; i < size; i += 1000) {
         char c = buf[i];
         positionsChecked++;
         
@@ -343,13 +345,13 @@ void analyzeAtSparseAddresses(char* buf, int size) {
         }
     }
     
-    printf("Positions checked: %d\n", positionsChecked);
-    printf("Count of '3' at addresses divisible by 1000: %d\n", count3);
-    printf("Vowels at sparse addresses: %d\n", vowelCount);
-    printf("Digits at sparse addresses: %d\n", digitCount);
+    printf("Positions checked: %" PRIu64 "\n", positionsChecked);
+    printf("Count of '3' at addresses divisible by 1000: %" PRIu64 "\n", count3);
+    printf("Vowels at sparse addresses: %" PRIu64 "\n", vowelCount);
+    printf("Digits at sparse addresses: %" PRIu64 "\n", digitCount);
 }
 
-int countVowels(char* buf, int size) {
+uint64_t countVowels(char* buf, size_t size) {
     // Reset counts
     for (int i = 0; i < 26; i++) {
         letterCounts[i] = 0;
@@ -358,11 +360,11 @@ int countVowels(char* buf, int size) {
         digitCounts[i] = 0;
     }
     
-    int vowelCount = 0;
+    uint64_t vowelCount = 0;
     
     // pi digits check - find longest matching substring
-    int longestPiMatch = findLongestPiMatch(buf, size);
-    printf("Longest pi digit match found: %d characters\n", longestPiMatch);
+    size_t longestPiMatch = findLongestPiMatch(buf, size);
+    printf("Longest pi digit match found: %zu characters\n", longestPiMatch);
     
     // Find best Hamming match to pi digits
     findBestHammingMatch(buf, size);
@@ -370,7 +372,7 @@ int countVowels(char* buf, int size) {
     // analysis - counts '3' at sparse addresses
     analyzeAtSparseAddresses(buf, size);
     
-    for (int i = 0; i < size; i++) {
+    for (size_t i = 0; i < size; i++) {
         char c = buf[i];
         
         // Count this character
@@ -387,22 +389,22 @@ int countVowels(char* buf, int size) {
 
 // Getter functions for statistics
 
-int* getLetterCounts() {
+uint64_t* getLetterCounts() {
     return letterCounts;
 }
 
-int* getDigitCounts() {
+uint64_t* getDigitCounts() {
     return digitCounts;
 }
 
-void printAllStats(int vowelCount) {
-    printf("Vowel count: %d, Letters: [", vowelCount);
+void printAllStats(uint64_t vowelCount) {
+    printf("Vowel count: %" PRIu64 ", Letters: [", vowelCount);
     
     bool first = true;
     for (int i = 0; i < 26; i++) {
         if (letterCounts[i] > 0) {
             if (!first) printf(", ");
-            printf("(%c,%d)", 'a' + i, letterCounts[i]);
+            printf("(%c,%" PRIu64 ")", 'a' + i, letterCounts[i]);
             first = false;
         }
     }
@@ -412,7 +414,7 @@ void printAllStats(int vowelCount) {
     for (int i = 0; i < 10; i++) {
         if (digitCounts[i] > 0) {
             if (!first) printf(", ");
-            printf("(%d,%d)", i, digitCounts[i]);
+            printf("(%d,%" PRIu64 ")", i, digitCounts[i]);
             first = false;
         }
     }
@@ -0,0 +1,419 @@
+/* vowel_index.c */
+/* On-disk suffix array (SA-IS) of an input, mapped for repeated prefix queries */
+
+#include <stdlib.h>
+#include <string.h>   // for memcpy, memcmp, memset
+#include <errno.h>
+#include <fcntl.h>    // for open()
+#include <unistd.h>   // for ftruncate(), close(), unlink()
+#include <sys/mman.h> // for mmap(), msync()
+#include <sys/stat.h> // for fstat()
+#include "vowel_index.h"
+
+// ==========================================
+// FILE LAYOUT
+// ==========================================
+
+// Header, then the pair table (uint32_t[SUFFIX_INDEX_PAIRS + 1]: where each
+// two-byte prefix's suffixes start in the sorted order, the last entry being
+// the text size), then the suffix array (int32_t[size + 1], the sentinel
+// suffix first), then the text. The magic is written last, so a build that
+// dies halfway leaves a file suffixIndexOpen() rejects.
+#define INDEX_MAGIC "VSINDEX1"
+
+typedef struct {
+    char magic[8];
+    uint64_t textBytes;
+    uint64_t pairOffset;
+    uint64_t suffixOffset;
+    uint64_t textOffset;
+    uint64_t fileBytes;
+    uint64_t reserved[2];
+} IndexHeader;
+
+static void layoutIndex(IndexHeader* header, uint64_t size) {
+    memset(header, 0, sizeof(*header));
+    header->textBytes = size;
+    header->pairOffset = sizeof(IndexHeader);
+    header->suffixOffset = header->pairOffset + (SUFFIX_INDEX_PAIRS + 1) * sizeof(uint32_t);
+    header->textOffset = header->suffixOffset + (size + 1) * sizeof(int32_t);
+    header->fileBytes = header->textOffset + size;
+}
+
+// ==========================================
+// LEVEL-0 PASSES (Parallel Blocks)
+// ==========================================
+
+void suffixTypesRange(const char* buf, size_t size, uint8_t* types, size_t first, size_t last) {
+    const uint8_t* bytes = (const uint8_t*)buf;
+    if (last == size) types[size] = 1; // The sentinel is an S suffix
+    for (size_t i = last; i-- > first; ) {
+        if (i == size - 1) {
+            types[i] = 0; // Every byte sorts after the sentinel
+        } else if (bytes[i] != bytes[i + 1]) {
+            types[i] = bytes[i] < bytes[i + 1];
+        } else {
+            types[i] = i + 1 < last ? types[i + 1] : 0; // 0 until joined
+        }
+    }
+}
+
+void suffixTypesJoin(const char* buf, size_t size, uint8_t* types, size_t first, size_t last) {
+    if (last >= size) return;
+    for (size_t i = last; i-- > first && buf[i] == buf[i + 1]; ) types[i] = types[i + 1];
+}
+
+void suffixPairCounts(const char* buf, size_t size, size_t first, size_t last, uint64_t* counts) {
+    const uint8_t* bytes = (const uint8_t*)buf;
+    if (last > size - 1) last = size - 1;
+    for (size_t i = first; i < last; i++) counts[bytes[i] << 8 | bytes[i + 1]]++;
+}
+
+// ==========================================
+// SA-IS
+// ==========================================
+
+// Nong, Zhang and Chan's induced sorting. A suffix is S if it is smaller
+// than the next one, L otherwise; an LMS suffix is an S suffix after an L
+// one. Sorting the LMS suffixes fixes the order of all others: one pass
+// left to right places the L suffixes, one right to left the S suffixes.
+// The LMS suffixes are sorted by naming the substrings between them and
+// sorting the string of names the same way, which is at most half as long.
+
+// Level 0 reads the input bytes as symbols 1..256 with a sentinel 0 at the
+// end; deeper levels read names, the last of them the sentinel's 0.
+typedef struct {
+    const uint8_t* bytes;
+    const int32_t* names;
+    int32_t n;         // Symbols, sentinel included
+    int32_t alphabet;  // Symbols are 0..alphabet - 1
+} SaisText;
+
+#define SYMBOL(text, i) \
+    ((text)->names != NULL ? (text)->names[i] : (i) == (text)->n - 1 ? 0 : (text)->bytes[i] + 1)
+#define IS_LMS(types, i) ((i) > 0 && (types)[i] && !(types)[(i) - 1])
+
+static void bucketHeads(const int32_t* counts, int32_t alphabet, int32_t* bucket) {
+    int32_t sum = 0;
+    for (int32_t c = 0; c < alphabet; c++) {
+        bucket[c] = sum;
+        sum += counts[c];
+    }
+}
+
+static void bucketTails(const int32_t* counts, int32_t alphabet, int32_t* bucket) {
+    int32_t sum = 0;
+    for (int32_t c = 0; c < alphabet; c++) {
+        sum += counts[c];
+        bucket[c] = sum;
+    }
+}
+
+// From the LMS suffixes in sa, places the L suffixes at their bucket heads,
+// then the S suffixes (LMS ones included, again) at their bucket tails
+static void induce(const SaisText* text, const uint8_t* types, const int32_t* counts, int32_t* bucket,
+                   int32_t* sa) {
+    int32_t n = text->n;
+    bucketHeads(counts, text->alphabet, bucket);
+    for (int32_t i = 0; i < n; i++) {
+        int32_t j = sa[i] - 1;
+        if (sa[i] > 0 && !types[j]) sa[bucket[SYMBOL(text, j)]++] = j;
+    }
+    bucketTails(counts, text->alphabet, bucket);
+    for (int32_t i = n - 1; i >= 0; i--) {
+        int32_t j = sa[i] - 1;
+        if (sa[i] > 0 && types[j]) sa[--bucket[SYMBOL(text, j)]] = j;
+    }
+}
+
+// Sorts the suffixes of `text` into sa[0..n). types and counts are computed
+// when NULL (every level but the first). Returns -1 if out of memory.
+static int saIs(const SaisText* text, uint8_t* types, const int32_t* counts, int32_t* sa) {
+    int32_t n = text->n;
+    if (n == 1) {
+        sa[0] = 0;
+        return 0;
+    }
+
+    uint8_t* ownTypes = NULL;
+    int32_t* ownCounts = NULL;
+    if (types == NULL) {
+        types = ownTypes = (uint8_t*)malloc(n);
+        if (types == NULL) return -1;
+        types[n - 1] = 1;
+        for (int32_t i = n - 2; i >= 0; i--) {
+            int32_t c = SYMBOL(text, i), next = SYMBOL(text, i + 1);
+            types[i] = c < next || (c == next && types[i + 1]);
+        }
+    }
+    if (counts == NULL) {
+        counts = ownCounts = (int32_t*)calloc(text->alphabet, sizeof(int32_t));
+        if (counts == NULL) {
+            free(ownTypes);
+            return -1;
+        }
+        for (int32_t i = 0; i < n; i++) ownCounts[SYMBOL(text, i)]++;
+    }
+    int32_t* bucket = (int32_t*)malloc(text->alphabet * sizeof(int32_t));
+    if (bucket == NULL) {
+        free(ownTypes);
+        free(ownCounts);
+        return -1;
+    }
+
+    // 1. Sort the LMS substrings: LMS suffixes at their bucket tails, induced
+    for (int32_t i = 0; i < n; i++) sa[i] = -1;
+    bucketTails(counts, text->alphabet, bucket);
+    for (int32_t i = 1; i < n; i++) {
+        if (IS_LMS(types, i)) sa[--bucket[SYMBOL(text, i)]] = i;
+    }
+    induce(text, types, counts, bucket, sa);
+
+    // 2. Name them in that order, equal substrings alike. The sorted LMS
+    //    positions go to the front; the name of the one at p to m + p / 2
+    //    (LMS positions are at least 2 apart), then gathered to the back.
+    int32_t m = 0;
+    for (int32_t i = 0; i < n; i++) {
+        if (IS_LMS(types, sa[i])) sa[m++] = sa[i];
+    }
+    for (int32_t i = m; i < n; i++) sa[i] = -1;
+    int32_t names = 0;
+    int32_t previous = -1;
+    for (int32_t i = 0; i < m; i++) {
+        int32_t p = sa[i];
+        int differs = 0;
+        for (int32_t d = 0; ; d++) {
+            if (previous < 0 || SYMBOL(text, p + d) != SYMBOL(text, previous + d) ||
+                types[p + d] != types[previous + d]) {
+                differs = 1;
+                break;
+            }
+            if (d > 0 && (IS_LMS(types, p + d) || IS_LMS(types, previous + d))) break;
+        }
+        if (differs) {
+            names++;
+            previous = p;
+        }
+        sa[m + p / 2] = names - 1;
+    }
+    for (int32_t i = n - 1, j = n - 1; i >= m; i--) {
+        if (sa[i] >= 0) sa[j--] = sa[i];
+    }
+
+    // 3. Sort the LMS suffixes: recursively while names repeat, otherwise
+    //    each name is its suffix's rank
+    int32_t* reduced = sa + n - m;
+    int status = 0;
+    if (names < m) {
+        SaisText sub = { NULL, reduced, m, names };
+        status = saIs(&sub, NULL, NULL, sa);
+    } else {
+        for (int32_t i = 0; i < m; i++) sa[reduced[i]] = i;
+    }
+
+    // 4. Place them at their bucket tails in that order, and induce the rest
+    if (status == 0) {
+        for (int32_t i = 1, j = 0; i < n; i++) {
+            if (IS_LMS(types, i)) reduced[j++] = i;
+        }
+        for (int32_t i = 0; i < m; i++) sa[i] = reduced[sa[i]];
+        for (int32_t i = m; i < n; i++) sa[i] = -1;
+        bucketTails(counts, text->alphabet, bucket);
+        for (int32_t i = m - 1; i >= 0; i--) {
+            int32_t j = sa[i];
+            sa[i] = -1;
+            sa[--bucket[SYMBOL(text, j)]] = j;
+        }
+        induce(text, types, counts, bucket, sa);
+    }
+    free(bucket);
+    free(ownTypes);
+    free(ownCounts);
+    return status;
+}
+
+// ==========================================
+// INDEX FILE
+// ==========================================
+
+int suffixIndexWrite(const char* buf, size_t size, uint8_t* types, const uint64_t* pairs, const char* path) {
+    if (size > SUFFIX_INDEX_MAX_BYTES) {
+        errno = EFBIG;
+        return -1;
+    }
+    IndexHeader header;
+    layoutIndex(&header, size);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) return -1;
+    char* map = ftruncate(fd, header.fileBytes) == 0
+        ? (char*)mmap(NULL, header.fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        : (char*)MAP_FAILED;
+    close(fd); // The mapping keeps its own reference
+    if (map == MAP_FAILED) {
+        unlink(path);
+        return -1;
+    }
+
+    // Byte counts (symbol c + 1) from the pairs each byte starts, plus the last byte
+    const uint8_t* bytes = (const uint8_t*)buf;
+    int32_t counts[257] = { 1 }; // The sentinel
+    for (int key = 0; key < SUFFIX_INDEX_PAIRS; key++) counts[(key >> 8) + 1] += (int32_t)pairs[key];
+    if (size > 0) counts[bytes[size - 1] + 1]++;
+
+    // Pair starts: the one-byte last suffix sorts first among those starting with its byte
+    uint32_t* pairStarts = (uint32_t*)(map + header.pairOffset);
+    uint64_t sum = 0;
+    for (int key = 0; key < SUFFIX_INDEX_PAIRS; key++) {
+        pairStarts[key] = (uint32_t)(sum + (size > 0 && bytes[size - 1] <= key >> 8));
+        sum += pairs[key];
+    }
+    pairStarts[SUFFIX_INDEX_PAIRS] = (uint32_t)size;
+
+    SaisText text = { bytes, NULL, (int32_t)(size + 1), 257 };
+    int status = saIs(&text, types, counts, (int32_t*)(map + header.suffixOffset));
+    if (status == 0) {
+        memcpy(map + header.textOffset, buf, size);
+        memcpy(map, &header, sizeof(header));
+        memcpy(map, INDEX_MAGIC, 8);
+        status = msync(map, header.fileBytes, MS_SYNC);
+    } else {
+        errno = ENOMEM;
+    }
+    munmap(map, header.fileBytes);
+    if (status != 0) {
+        int error = errno;
+        unlink(path);
+        errno = error;
+    }
+    return status;
+}
+
+// ==========================================
+// QUERIES
+// ==========================================
+
+struct SuffixIndex {
+    char* map;
+    size_t mapBytes;
+    const uint32_t* pairStarts;
+    const int32_t* suffixes; // Sorted, sentinel left out
+    const uint8_t* text;
+    uint64_t size;
+};
+
+SuffixIndex* suffixIndexOpen(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    int mappable = fstat(fd, &st) == 0;
+    if (mappable && (size_t)st.st_size < sizeof(IndexHeader)) {
+        errno = EINVAL;
+        mappable = 0;
+    }
+    char* map = mappable ? (char*)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : (char*)MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    IndexHeader header, expected;
+    memcpy(&header, map, sizeof(header));
+    layoutIndex(&expected, header.textBytes);
+    memcpy(expected.magic, INDEX_MAGIC, 8);
+    SuffixIndex* index = memcmp(&header, &expected, sizeof(header)) == 0 &&
+                                 header.fileBytes == (uint64_t)st.st_size
+                             ? (SuffixIndex*)malloc(sizeof(SuffixIndex))
+                             : NULL;
+    if (index == NULL) {
+        munmap(map, st.st_size);
+        errno = EINVAL;
+        return NULL;
+    }
+    madvise(map, st.st_size, MADV_RANDOM); // Binary searches touch a page or two each
+    index->map = map;
+    index->mapBytes = st.st_size;
+    index->pairStarts = (const uint32_t*)(map + header.pairOffset);
+    index->suffixes = (const int32_t*)(map + header.suffixOffset) + 1;
+    index->text = (const uint8_t*)(map + header.textOffset);
+    index->size = header.textBytes;
+    return index;
+}
+
+void suffixIndexClose(SuffixIndex* index) {
+    if (index == NULL) return;
+    munmap(index->map, index->mapBytes);
+    free(index);
+}
+
+uint64_t suffixIndexTextBytes(const SuffixIndex* index) {
+    return index->size;
+}
+
+uint64_t suffixIndexFileBytes(const SuffixIndex* index) {
+    return index->mapBytes;
+}
+
+const char* suffixIndexText(const SuffixIndex* index) {
+    return (const char*)index->text;
+}
+
+// Byte `depth` of the i-th smallest suffix, -1 past its end (shorter sorts first)
+static int byteAt(const SuffixIndex* index, size_t i, size_t depth) {
+    uint64_t at = (uint64_t)index->suffixes[i] + depth;
+    return at < index->size ? index->text[at] : -1;
+}
+
+// Suffixes [*lo, *hi) share their first `depth` bytes; keeps those whose
+// next byte is c
+static void narrow(const SuffixIndex* index, size_t depth, int c, size_t* lo, size_t* hi) {
+    size_t a = *lo, b = *hi;
+    while (a < b) {
+        size_t mid = a + (b - a) / 2;
+        if (byteAt(index, mid, depth) < c) a = mid + 1; else b = mid;
+    }
+    *lo = a;
+    b = *hi;
+    while (a < b) {
+        size_t mid = a + (b - a) / 2;
+        if (byteAt(index, mid, depth) <= c) a = mid + 1; else b = mid;
+    }
+    *hi = a;
+}
+
+size_t suffixIndexLongestPrefix(const SuffixIndex* index, const char* pattern, size_t length,
+                                uint64_t* occurrences, uint64_t* first) {
+    const uint8_t* bytes = (const uint8_t*)pattern;
+    size_t lo = 0, hi = index->size, depth = 0;
+
+    // The first two bytes straight from the table. The one-byte last suffix
+    // sits between two first bytes' ranges, at the head of the later one.
+    if (length >= 2) {
+        int key = bytes[0] << 8 | bytes[1];
+        size_t start = index->pairStarts[key], end = index->pairStarts[key + 1];
+        if (bytes[1] == 255 && bytes[0] < 255 && index->size > 0 && index->text[index->size - 1] == bytes[0] + 1) {
+            end--;
+        }
+        if (start < end) {
+            lo = start;
+            hi = end;
+            depth = 2;
+        }
+    }
+    while (depth < length) {
+        size_t a = lo, b = hi;
+        narrow(index, depth, bytes[depth], &a, &b);
+        if (a == b) break;
+        lo = a;
+        hi = b;
+        depth++;
+    }
+
+    *occurrences = depth > 0 ? hi - lo : 0;
+    if (first != NULL) {
+        uint64_t lowest = 0;
+        for (size_t i = lo; depth > 0 && i < hi; i++) {
+            if (i == lo || (uint64_t)index->suffixes[i] < lowest) lowest = index->suffixes[i];
+        }
+        *first = lowest;
+    }
+    return depth;
+}
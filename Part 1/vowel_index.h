@@ -0,0 +1,70 @@
+/* vowel_index.h */
+/* On-disk suffix array (SA-IS) of an input, mapped for repeated prefix queries */
+
+#ifndef VOWEL_INDEX_H
+#define VOWEL_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Suffix array entries are 32-bit, with one more for the sentinel suffix
+#define SUFFIX_INDEX_MAX_BYTES ((size_t)INT32_MAX - 1)
+#define SUFFIX_INDEX_PAIRS 65536 // Buckets of the first two bytes of a suffix
+
+// ==========================================
+// BUILD
+// ==========================================
+
+// SA-IS sorts the suffixes of the input plus a sentinel that is smaller than
+// every byte. Its level-0 inputs - the L/S type of every suffix and the
+// bucket sizes - come from passes over the input that split into blocks, so
+// the caller computes them in parallel with the two range functions below;
+// the induced sorting itself is sequential.
+
+// Types of the suffixes starting in [first, last) (1 = S: smaller than the
+// next suffix, 0 = L). A type depends on the next one only across a run of
+// equal bytes, so the types at the end of a block that runs on into the next
+// one are left for suffixTypesJoin(). types has size + 1 entries, the last
+// for the sentinel.
+void suffixTypesRange(const char* buf, size_t size, uint8_t* types, size_t first, size_t last);
+// Settles the run at the end of block [first, last), once the block after it is settled
+void suffixTypesJoin(const char* buf, size_t size, uint8_t* types, size_t first, size_t last);
+
+// Adds the two-byte prefixes (byte i << 8 | byte i + 1) of the suffixes
+// starting in [first, last) to counts[SUFFIX_INDEX_PAIRS]. The last suffix,
+// one byte long, has no pair.
+void suffixPairCounts(const char* buf, size_t size, size_t first, size_t last, uint64_t* counts);
+
+// Creates the index file at `path` (replacing one there), sorts the suffixes
+// straight into its mapping, and writes the pair table and the text after
+// them. types and pairs are the settled results of the functions above.
+// Returns -1 (errno set) if the file cannot be written, the input is over
+// SUFFIX_INDEX_MAX_BYTES or out of memory.
+int suffixIndexWrite(const char* buf, size_t size, uint8_t* types, const uint64_t* pairs, const char* path);
+
+// ==========================================
+// QUERIES
+// ==========================================
+
+// A mapped index. Queries only read it, so threads may share one.
+typedef struct SuffixIndex SuffixIndex;
+
+// NULL (errno set) if the file cannot be mapped or is not an index
+SuffixIndex* suffixIndexOpen(const char* path);
+void suffixIndexClose(SuffixIndex* index);
+
+uint64_t suffixIndexTextBytes(const SuffixIndex* index);
+uint64_t suffixIndexFileBytes(const SuffixIndex* index);
+// The indexed input, as stored in the index
+const char* suffixIndexText(const SuffixIndex* index);
+
+// Longest prefix of pattern[0..length) that occurs in the text, found by
+// narrowing the sorted suffixes one byte at a time (two binary searches per
+// byte past the pair table: O(length log n)). Sets *occurrences to the
+// number of places that prefix occurs, and *first (if not NULL) to the
+// lowest of them, which walks every occurrence. Both are 0 for a length-0
+// answer.
+size_t suffixIndexLongestPrefix(const SuffixIndex* index, const char* pattern, size_t length,
+                                uint64_t* occurrences, uint64_t* first);
+
+#endif
@@ -0,0 +1,234 @@
+/* vowel_mismatch.c */
+/* k-mismatch search: pigeonhole q-gram filter, verified windows, top-K heap */
+
+#include <stdlib.h>
+#include <string.h> // for memcpy, memcmp, memset
+#include "vowel_mismatch.h"
+
+// ==========================================
+// HIT LISTS
+// ==========================================
+
+void mismatchListInit(MismatchList* list) {
+    memset(list, 0, sizeof(*list));
+}
+
+void mismatchListFree(MismatchList* list) {
+    free(list->hits);
+    mismatchListInit(list);
+}
+
+int mismatchListAppend(MismatchList* list, MismatchHit hit) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        MismatchHit* grown = (MismatchHit*)realloc(list->hits, capacity * sizeof(MismatchHit));
+        if (grown == NULL) return -1;
+        list->hits = grown;
+        list->capacity = capacity;
+    }
+    list->hits[list->count++] = hit;
+    return 0;
+}
+
+// Mismatches of p against pattern, stopping once there are more than `limit`
+static int countMismatches(const char* p, const char* pattern, size_t length, int limit) {
+    int mismatches = 0;
+    for (size_t i = 0; i < length; i++) {
+        mismatches += p[i] != pattern[i];
+        if (mismatches > limit) break;
+    }
+    return mismatches;
+}
+
+// ==========================================
+// Q-GRAM FILTER
+// ==========================================
+
+// Starts verified per round: candidates are marked in a bitmap of this many
+// bits, which both orders and de-duplicates them (a window can line up with
+// several blocks)
+#define FILTER_CHUNK 4096
+#define FILTER_EMPTY -1
+
+struct MismatchFilter {
+    const char* pattern;
+    size_t length;
+    int maxMismatches;
+    size_t q;         // Block length
+    int blocks;       // maxMismatches + 1
+    // Open-addressed table of the blocks' first 8 bytes. Equal blocks take
+    // separate slots, so a probe walks on past a key match.
+    uint64_t* keys;
+    int* blockOf;     // FILTER_EMPTY for a free slot
+    size_t mask;
+    int shift;
+};
+
+static size_t slotOf(const MismatchFilter* filter, uint64_t key) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> filter->shift);
+}
+
+int mismatchFilterMaxMismatches(size_t length) {
+    return length >= MISMATCH_MIN_QGRAM ? (int)(length / MISMATCH_MIN_QGRAM) - 1 : -1;
+}
+
+MismatchFilter* mismatchFilterCreate(const char* pattern, size_t length, int maxMismatches) {
+    if (maxMismatches < 0 || maxMismatches > mismatchFilterMaxMismatches(length)) return NULL;
+    MismatchFilter* filter = (MismatchFilter*)calloc(1, sizeof(MismatchFilter));
+    if (filter == NULL) return NULL;
+    filter->pattern = pattern;
+    filter->length = length;
+    filter->maxMismatches = maxMismatches;
+    filter->blocks = maxMismatches + 1;
+    filter->q = length / filter->blocks;
+
+    // At most a quarter full, so a miss usually stops at the first slot
+    size_t slots = 16;
+    filter->shift = 60;
+    while (slots < 4 * (size_t)filter->blocks) {
+        slots *= 2;
+        filter->shift--;
+    }
+    filter->mask = slots - 1;
+    filter->keys = (uint64_t*)malloc(slots * sizeof(uint64_t));
+    filter->blockOf = (int*)malloc(slots * sizeof(int));
+    if (filter->keys == NULL || filter->blockOf == NULL) {
+        mismatchFilterFree(filter);
+        return NULL;
+    }
+    for (size_t s = 0; s < slots; s++) filter->blockOf[s] = FILTER_EMPTY;
+    for (int j = 0; j < filter->blocks; j++) {
+        uint64_t key;
+        memcpy(&key, pattern + j * filter->q, 8);
+        size_t slot = slotOf(filter, key);
+        while (filter->blockOf[slot] != FILTER_EMPTY) slot = (slot + 1) & filter->mask;
+        filter->keys[slot] = key;
+        filter->blockOf[slot] = j;
+    }
+    return filter;
+}
+
+void mismatchFilterFree(MismatchFilter* filter) {
+    if (filter == NULL) return;
+    free(filter->keys);
+    free(filter->blockOf);
+    free(filter);
+}
+
+int mismatchFilterScan(const MismatchFilter* filter, const char* buf, size_t first, size_t last,
+                       uint64_t base, MismatchList* list) {
+    const char* pattern = filter->pattern;
+    size_t q = filter->q;
+    size_t reach = (filter->blocks - 1) * q; // Block j of start s begins at s + j * q
+    uint64_t marked[FILTER_CHUNK / 64];
+
+    for (size_t chunk = first; chunk < last; chunk += FILTER_CHUNK) {
+        size_t chunkEnd = last - chunk < FILTER_CHUNK ? last : chunk + FILTER_CHUNK;
+        memset(marked, 0, sizeof(marked));
+
+        // Every text position where a block of a start in the chunk can begin
+        size_t scanEnd = chunkEnd + reach;
+        for (size_t i = chunk; i < scanEnd; i++) {
+            uint64_t key;
+            memcpy(&key, buf + i, 8);
+            for (size_t slot = slotOf(filter, key); filter->blockOf[slot] != FILTER_EMPTY;
+                 slot = (slot + 1) & filter->mask) {
+                if (filter->keys[slot] != key) continue;
+                size_t offset = filter->blockOf[slot] * q;
+                if (i < chunk + offset || i - offset >= chunkEnd) continue;
+                if (q > 8 && memcmp(buf + i + 8, pattern + offset + 8, q - 8) != 0) continue;
+                size_t bit = i - offset - chunk;
+                marked[bit / 64] |= 1ULL << (bit % 64);
+            }
+        }
+
+        // Verify the candidates in index order
+        for (size_t w = 0; w < FILTER_CHUNK / 64; w++) {
+            for (uint64_t bits = marked[w]; bits != 0; bits &= bits - 1) {
+                size_t start = chunk + w * 64 + __builtin_ctzll(bits);
+                int mismatches = countMismatches(buf + start, pattern, filter->length, filter->maxMismatches);
+                if (mismatches > filter->maxMismatches) continue;
+                MismatchHit hit = { base + start, (int)filter->length - mismatches };
+                if (mismatchListAppend(list, hit) != 0) return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int mismatchScanAll(const char* pattern, size_t length, int maxMismatches, const char* buf, size_t first,
+                    size_t last, uint64_t base, MismatchList* list) {
+    for (size_t start = first; start < last; start++) {
+        int mismatches = countMismatches(buf + start, pattern, length, maxMismatches);
+        if (mismatches > maxMismatches) continue;
+        MismatchHit hit = { base + start, (int)length - mismatches };
+        if (mismatchListAppend(list, hit) != 0) return -1;
+    }
+    return 0;
+}
+
+// ==========================================
+// TOP-K HEAP
+// ==========================================
+
+static bool worse(MismatchHit a, MismatchHit b) {
+    return a.score < b.score || (a.score == b.score && a.index > b.index);
+}
+
+int matchHeapInit(MatchHeap* heap, size_t capacity) {
+    heap->hits = (MismatchHit*)malloc((capacity ? capacity : 1) * sizeof(MismatchHit));
+    heap->count = 0;
+    heap->capacity = capacity;
+    return heap->hits != NULL ? 0 : -1;
+}
+
+void matchHeapFree(MatchHeap* heap) {
+    free(heap->hits);
+    heap->hits = NULL;
+    heap->count = heap->capacity = 0;
+}
+
+static void siftDown(MismatchHit* hits, size_t count, size_t at) {
+    for (;;) {
+        size_t child = 2 * at + 1;
+        if (child >= count) return;
+        if (child + 1 < count && worse(hits[child + 1], hits[child])) child++;
+        if (!worse(hits[child], hits[at])) return;
+        MismatchHit swap = hits[at];
+        hits[at] = hits[child];
+        hits[child] = swap;
+        at = child;
+    }
+}
+
+void matchHeapPush(MatchHeap* heap, MismatchHit hit) {
+    if (heap->capacity == 0 || hit.score <= 0) return;
+    if (heap->count < heap->capacity) {
+        size_t at = heap->count++;
+        heap->hits[at] = hit;
+        while (at > 0 && worse(heap->hits[at], heap->hits[(at - 1) / 2])) {
+            MismatchHit swap = heap->hits[at];
+            heap->hits[at] = heap->hits[(at - 1) / 2];
+            heap->hits[(at - 1) / 2] = swap;
+            at = (at - 1) / 2;
+        }
+        return;
+    }
+    if (!worse(heap->hits[0], hit)) return;
+    heap->hits[0] = hit;
+    siftDown(heap->hits, heap->count, 0);
+}
+
+int matchHeapBound(const MatchHeap* heap) {
+    return heap->count < heap->capacity ? 0 : heap->hits[0].score;
+}
+
+void matchHeapSort(MatchHeap* heap) {
+    // Heapsort: the worst goes to the back each round, leaving best first
+    for (size_t end = heap->count; end > 1; end--) {
+        MismatchHit swap = heap->hits[0];
+        heap->hits[0] = heap->hits[end - 1];
+        heap->hits[end - 1] = swap;
+        siftDown(heap->hits, end - 1, 0);
+    }
+}
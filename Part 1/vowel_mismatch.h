@@ -0,0 +1,76 @@
+/* vowel_mismatch.h */
+/* k-mismatch search: pigeonhole q-gram filter, verified windows, top-K heap */
+
+#ifndef VOWEL_MISMATCH_H
+#define VOWEL_MISMATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MISMATCH_MIN_QGRAM 8 // Shortest block the filter looks up (one 64-bit key)
+
+typedef struct {
+    uint64_t index; // Start offset in the whole input
+    int score;      // Positions that match the pattern
+} MismatchHit;
+
+// Hits in index order, grown as needed
+typedef struct {
+    MismatchHit* hits;
+    size_t count;
+    size_t capacity;
+} MismatchList;
+
+void mismatchListInit(MismatchList* list);
+void mismatchListFree(MismatchList* list);
+// Returns -1 if out of memory
+int mismatchListAppend(MismatchList* list, MismatchHit hit);
+
+// A window with at most k mismatches against the pattern contains at least
+// one of k + 1 disjoint blocks of it exactly (pigeonhole). The filter splits
+// the pattern into k + 1 blocks of q = length / (k + 1) bytes, looks up the
+// q-gram at every text position in a table of the blocks, and verifies only
+// the windows a block lines up with.
+typedef struct MismatchFilter MismatchFilter;
+
+// NULL if the blocks would be shorter than MISMATCH_MIN_QGRAM (a filter that
+// passes most windows does not pay) or out of memory. `pattern` must
+// outlive the filter.
+MismatchFilter* mismatchFilterCreate(const char* pattern, size_t length, int maxMismatches);
+void mismatchFilterFree(MismatchFilter* filter);
+// Largest maxMismatches a filter can be created with for a pattern of `length`
+int mismatchFilterMaxMismatches(size_t length);
+
+// Appends, in index order, the starts in [first, last) of buf whose window
+// has at most maxMismatches mismatches (buf readable through
+// last - 1 + length; `base` is the global index of buf[0]). Returns -1 if
+// out of memory.
+int mismatchFilterScan(const MismatchFilter* filter, const char* buf, size_t first, size_t last,
+                       uint64_t base, MismatchList* list);
+
+// The same without a filter: every start is counted, stopping at
+// maxMismatches + 1. For thresholds too high to filter.
+int mismatchScanAll(const char* pattern, size_t length, int maxMismatches, const char* buf, size_t first,
+                    size_t last, uint64_t base, MismatchList* list);
+
+// Bounded heap of the K best hits, best meaning the higher score, then the
+// lower index (the Hamming tie-break). The root is the worst kept hit.
+typedef struct {
+    MismatchHit* hits;
+    size_t count;
+    size_t capacity;
+} MatchHeap;
+
+// Returns -1 if out of memory
+int matchHeapInit(MatchHeap* heap, size_t capacity);
+void matchHeapFree(MatchHeap* heap);
+// Keeps `hit` if it is among the best `capacity` seen so far
+void matchHeapPush(MatchHeap* heap, MismatchHit hit);
+// Score a hit at a higher index than all pushed so far must beat to be kept
+// (0 while the heap has room, so zero scores are never kept)
+int matchHeapBound(const MatchHeap* heap);
+// Sorts the kept hits best first (the heap is spent afterwards)
+void matchHeapSort(MatchHeap* heap);
+
+#endif
@@ -0,0 +1,399 @@
+/* vowel_patterns.c */
+/* Longest-prefix matchers: KMP for one pattern, Aho-Corasick for a set */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vowel_patterns.h"
+
+const char piDigits[] = "3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067";
+const char eDigits[] = "2718281828459045235360287471352662497757247093699959574966967627724076630353547594571382178525166427";
+const char sqrt2Digits[] = "1414213562373095048801688724209698078569671875376948073176679737990732478462107038850387534327641572";
+
+// ==========================================
+// SINGLE PATTERN (KMP)
+// ==========================================
+
+struct PrefixMatcher {
+    char* pattern;
+    size_t length;
+    uint32_t* fail;     // fail[i]: longest proper border of pattern[0..i]
+    size_t state;       // Pattern bytes matched by the current text suffix
+    size_t longest;
+};
+
+PrefixMatcher* prefixMatcherCreate(const char* pattern, size_t length) {
+    if (length == 0 || length > UINT32_MAX) return NULL;
+    PrefixMatcher* matcher = (PrefixMatcher*)calloc(1, sizeof(PrefixMatcher));
+    if (matcher == NULL) return NULL;
+    matcher->pattern = (char*)malloc(length);
+    matcher->fail = (uint32_t*)malloc(length * sizeof(uint32_t));
+    if (matcher->pattern == NULL || matcher->fail == NULL) {
+        prefixMatcherFree(matcher);
+        return NULL;
+    }
+    memcpy(matcher->pattern, pattern, length);
+    matcher->length = length;
+
+    matcher->fail[0] = 0;
+    size_t border = 0;
+    for (size_t i = 1; i < length; i++) {
+        while (border > 0 && pattern[i] != pattern[border]) border = matcher->fail[border - 1];
+        if (pattern[i] == pattern[border]) border++;
+        matcher->fail[i] = (uint32_t)border;
+    }
+    return matcher;
+}
+
+void prefixMatcherFree(PrefixMatcher* matcher) {
+    if (matcher == NULL) return;
+    free(matcher->pattern);
+    free(matcher->fail);
+    free(matcher);
+}
+
+void prefixMatcherFeed(PrefixMatcher* matcher, const char* buf, size_t size) {
+    const char* pattern = matcher->pattern;
+    const uint32_t* fail = matcher->fail;
+    size_t length = matcher->length;
+    register size_t state = matcher->state;
+    register size_t longest = matcher->longest;
+    const char* ptr = buf;
+    const char* end = buf + size;
+
+    while (ptr < end) {
+        if (state == 0) {
+            // Nothing matched: jump straight to the next possible first byte
+            ptr = (const char*)memchr(ptr, pattern[0], end - ptr);
+            if (ptr == NULL) break;
+            state = 1;
+        } else {
+            // Each fallback shrinks state, and state grows at most once per
+            // byte, so the total work stays O(size)
+            while (state > 0 && pattern[state] != *ptr) state = fail[state - 1];
+            if (pattern[state] == *ptr) state++;
+        }
+        if (state > longest) longest = state;
+        if (state == length) state = fail[length - 1]; // Full match: keep the longest border
+        ptr++;
+    }
+
+    matcher->state = state;
+    matcher->longest = longest;
+}
+
+size_t prefixMatcherLongest(const PrefixMatcher* matcher) {
+    return matcher->longest;
+}
+
+void prefixMatcherResume(PrefixMatcher* matcher, const char* tail, size_t tailLength, size_t longest) {
+    matcher->state = 0;
+    matcher->longest = 0;
+    prefixMatcherFeed(matcher, tail, tailLength);
+    if (longest > matcher->longest) matcher->longest = longest;
+}
+
+// ==========================================
+// PATTERN SETS (Aho-Corasick)
+// ==========================================
+
+// The automaton is a full DFA over byte classes: every byte that occurs in
+// some pattern gets its own class, all other bytes share class 0. Digit
+// patterns therefore need 11 transitions per node, not 256.
+//
+// For each node (a prefix of some pattern) and each pattern j, prefixDepth
+// holds the length of the longest suffix of that node's string which is also
+// a prefix of pattern j. After reading a byte the automaton sits on the
+// longest suffix of the text that is in the trie, so prefixDepth of that
+// node is the longest prefix of pattern j ending at this byte.
+
+typedef struct {
+    char* name;
+    char* bytes;
+    size_t length;
+} Pattern;
+
+struct PatternSet {
+    Pattern* patterns;
+    int count;
+    int capacity;
+
+    // Built automaton
+    int built;
+    int classes;
+    uint16_t classOf[256];
+    size_t nodes;
+    int32_t* next;          // nodes x classes
+    int32_t* depth;         // nodes
+    int32_t* prefixDepth;   // nodes x count
+};
+
+struct PatternMatch {
+    const PatternSet* set;
+    PrefixMatcher* single;  // Used instead of the automaton for a one-pattern set
+    int32_t state;
+    size_t shortest;        // min over longest[], lets most bytes skip the per-pattern loop
+    size_t* longest;
+};
+
+PatternSet* patternSetCreate(void) {
+    return (PatternSet*)calloc(1, sizeof(PatternSet));
+}
+
+void patternSetFree(PatternSet* set) {
+    if (set == NULL) return;
+    for (int i = 0; i < set->count; i++) {
+        free(set->patterns[i].name);
+        free(set->patterns[i].bytes);
+    }
+    free(set->patterns);
+    free(set->next);
+    free(set->depth);
+    free(set->prefixDepth);
+    free(set);
+}
+
+int patternSetAdd(PatternSet* set, const char* name, const char* bytes, size_t length) {
+    if (set->built || length == 0) return -1;
+    if (set->count == set->capacity) {
+        int capacity = set->capacity ? set->capacity * 2 : 4;
+        Pattern* grown = (Pattern*)realloc(set->patterns, capacity * sizeof(Pattern));
+        if (grown == NULL) return -1;
+        set->patterns = grown;
+        set->capacity = capacity;
+    }
+    Pattern* pattern = &set->patterns[set->count];
+    pattern->name = strdup(name);
+    pattern->bytes = (char*)malloc(length);
+    if (pattern->name == NULL || pattern->bytes == NULL) {
+        free(pattern->name);
+        free(pattern->bytes);
+        return -1;
+    }
+    memcpy(pattern->bytes, bytes, length);
+    pattern->length = length;
+    return set->count++;
+}
+
+int patternSetAddBuiltin(PatternSet* set, const char* name) {
+    if (strcmp(name, "pi") == 0) return patternSetAdd(set, name, piDigits, 100);
+    if (strcmp(name, "e") == 0) return patternSetAdd(set, name, eDigits, 100);
+    if (strcmp(name, "sqrt2") == 0) return patternSetAdd(set, name, sqrt2Digits, 100);
+    return -1;
+}
+
+int patternSetIsBuiltin(const PatternSet* set, int index) {
+    const Pattern* pattern = &set->patterns[index];
+    const char* digits = strcmp(pattern->name, "pi") == 0      ? piDigits
+                         : strcmp(pattern->name, "e") == 0     ? eDigits
+                         : strcmp(pattern->name, "sqrt2") == 0 ? sqrt2Digits
+                                                               : NULL;
+    return digits != NULL && pattern->length == 100 && memcmp(pattern->bytes, digits, 100) == 0;
+}
+
+int patternSetBuild(PatternSet* set) {
+    if (set->built || set->count == 0) return -1;
+    if (set->count == 1) {
+        set->built = 1; // Matched with KMP, no automaton needed
+        return 0;
+    }
+
+    // 1. Byte classes and an upper bound on the node count
+    size_t maxNodes = 1;
+    set->classes = 1;
+    memset(set->classOf, 0, sizeof(set->classOf));
+    for (int i = 0; i < set->count; i++) {
+        maxNodes += set->patterns[i].length;
+        for (size_t k = 0; k < set->patterns[i].length; k++) {
+            uint8_t c = (uint8_t)set->patterns[i].bytes[k];
+            if (set->classOf[c] == 0) set->classOf[c] = (uint16_t)set->classes++;
+        }
+    }
+
+    set->next = (int32_t*)malloc(maxNodes * set->classes * sizeof(int32_t));
+    set->depth = (int32_t*)malloc(maxNodes * sizeof(int32_t));
+    set->prefixDepth = (int32_t*)malloc(maxNodes * set->count * sizeof(int32_t));
+    int32_t* fail = (int32_t*)malloc(maxNodes * sizeof(int32_t));
+    int32_t* queue = (int32_t*)malloc(maxNodes * sizeof(int32_t));
+    if (!set->next || !set->depth || !set->prefixDepth || !fail || !queue) {
+        free(fail);
+        free(queue);
+        return -1;
+    }
+    for (size_t i = 0; i < maxNodes * set->classes; i++) set->next[i] = -1;
+    for (size_t i = 0; i < maxNodes * set->count; i++) set->prefixDepth[i] = -1;
+
+    // 2. Trie; nodes on pattern j's path are prefixes of j
+    set->nodes = 1;
+    set->depth[0] = 0;
+    for (int j = 0; j < set->count; j++) {
+        int32_t node = 0;
+        set->prefixDepth[j] = 0;
+        for (size_t k = 0; k < set->patterns[j].length; k++) {
+            int32_t* slot = &set->next[node * set->classes + set->classOf[(uint8_t)set->patterns[j].bytes[k]]];
+            if (*slot < 0) {
+                *slot = (int32_t)set->nodes;
+                set->depth[set->nodes] = set->depth[node] + 1;
+                set->nodes++;
+            }
+            node = *slot;
+            set->prefixDepth[node * set->count + j] = set->depth[node];
+        }
+    }
+
+    // 3. Breadth-first: failure links, missing transitions, inherited prefix depths
+    size_t head = 0, tail = 0;
+    for (int c = 0; c < set->classes; c++) {
+        int32_t* slot = &set->next[c];
+        if (*slot < 0) {
+            *slot = 0;
+        } else {
+            fail[*slot] = 0;
+            queue[tail++] = *slot;
+        }
+    }
+    while (head < tail) {
+        int32_t node = queue[head++];
+        for (int j = 0; j < set->count; j++) {
+            int32_t* own = &set->prefixDepth[node * set->count + j];
+            if (*own < 0) *own = set->prefixDepth[fail[node] * set->count + j];
+        }
+        for (int c = 0; c < set->classes; c++) {
+            int32_t* slot = &set->next[node * set->classes + c];
+            int32_t fallback = set->next[fail[node] * set->classes + c];
+            if (*slot < 0) {
+                *slot = fallback;
+            } else {
+                fail[*slot] = fallback;
+                queue[tail++] = *slot;
+            }
+        }
+    }
+
+    free(fail);
+    free(queue);
+    set->built = 1;
+    return 0;
+}
+
+int patternSetCount(const PatternSet* set) {
+    return set->count;
+}
+
+const char* patternSetName(const PatternSet* set, int index) {
+    return set->patterns[index].name;
+}
+
+const char* patternSetBytes(const PatternSet* set, int index, size_t* length) {
+    *length = set->patterns[index].length;
+    return set->patterns[index].bytes;
+}
+
+size_t patternSetMaxLength(const PatternSet* set) {
+    size_t longest = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (set->patterns[i].length > longest) longest = set->patterns[i].length;
+    }
+    return longest;
+}
+
+#define FNV_OFFSET 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+static uint64_t fnv1a(uint64_t hash, const char* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) hash = (hash ^ (unsigned char)bytes[i]) * FNV_PRIME;
+    return hash;
+}
+
+uint64_t patternSetHash(const PatternSet* set) {
+    uint64_t hash = FNV_OFFSET;
+    for (int i = 0; i < set->count; i++) {
+        // The terminating NULs keep ("ab", "c") apart from ("a", "bc")
+        hash = fnv1a(hash, set->patterns[i].name, strlen(set->patterns[i].name) + 1);
+        hash = fnv1a(hash, set->patterns[i].bytes, set->patterns[i].length);
+        hash = fnv1a(hash, "", 1);
+    }
+    return hash;
+}
+
+PatternMatch* patternMatchCreate(const PatternSet* set) {
+    if (!set->built) return NULL;
+    PatternMatch* match = (PatternMatch*)calloc(1, sizeof(PatternMatch));
+    if (match == NULL) return NULL;
+    match->longest = (size_t*)calloc(set->count, sizeof(size_t));
+    if (match->longest == NULL) {
+        free(match);
+        return NULL;
+    }
+    match->set = set;
+    if (set->count == 1) {
+        match->single = prefixMatcherCreate(set->patterns[0].bytes, set->patterns[0].length);
+        if (match->single == NULL) {
+            patternMatchFree(match);
+            return NULL;
+        }
+    }
+    return match;
+}
+
+void patternMatchFree(PatternMatch* match) {
+    if (match == NULL) return;
+    prefixMatcherFree(match->single);
+    free(match->longest);
+    free(match);
+}
+
+void patternMatchFeed(PatternMatch* match, const char* buf, size_t size) {
+    if (match->single != NULL) {
+        prefixMatcherFeed(match->single, buf, size);
+        match->longest[0] = prefixMatcherLongest(match->single);
+        return;
+    }
+
+    const PatternSet* set = match->set;
+    const int32_t* next = set->next;
+    const uint16_t* classOf = set->classOf;
+    int classes = set->classes;
+    int count = set->count;
+    register int32_t state = match->state;
+
+    for (size_t i = 0; i < size; i++) {
+        state = next[state * classes + classOf[(uint8_t)buf[i]]];
+
+        // No pattern can improve unless this node is deeper than the worst result
+        if ((size_t)set->depth[state] <= match->shortest) continue;
+
+        const int32_t* depths = &set->prefixDepth[state * count];
+        size_t shortest = SIZE_MAX;
+        for (int j = 0; j < count; j++) {
+            if ((size_t)depths[j] > match->longest[j]) match->longest[j] = depths[j];
+            if (match->longest[j] < shortest) shortest = match->longest[j];
+        }
+        match->shortest = shortest;
+    }
+    match->state = state;
+}
+
+size_t patternMatchLongest(const PatternMatch* match, int index) {
+    return match->longest[index];
+}
+
+void patternMatchResume(PatternMatch* match, const char* tail, size_t tailLength, const size_t* longest) {
+    int count = match->set->count;
+    if (match->single != NULL) {
+        prefixMatcherResume(match->single, tail, tailLength, longest[0]);
+        match->longest[0] = prefixMatcherLongest(match->single);
+        return;
+    }
+    match->state = 0;
+    match->shortest = 0;
+    memset(match->longest, 0, count * sizeof(size_t));
+    patternMatchFeed(match, tail, tailLength);
+
+    size_t shortest = SIZE_MAX;
+    for (int j = 0; j < count; j++) {
+        if (longest[j] > match->longest[j]) match->longest[j] = longest[j];
+        if (match->longest[j] < shortest) shortest = match->longest[j];
+    }
+    match->shortest = shortest;
+}
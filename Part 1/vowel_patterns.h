@@ -0,0 +1,70 @@
+/* vowel_patterns.h */
+/* Multi-pattern longest-prefix matching (Aho-Corasick automaton) */
+
+#ifndef VOWEL_PATTERNS_H
+#define VOWEL_PATTERNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Reference sequences shipped with the tool (100 digits each, no decimal point)
+extern const char piDigits[];
+extern const char eDigits[];
+extern const char sqrt2Digits[];
+
+// Single-pattern longest-prefix matcher (KMP failure function). Linear in
+// the input no matter how adversarial, and needs only 4 bytes per pattern
+// byte, so it handles references far longer than 100 digits.
+typedef struct PrefixMatcher PrefixMatcher;
+
+PrefixMatcher* prefixMatcherCreate(const char* pattern, size_t length);
+void prefixMatcherFree(PrefixMatcher* matcher);
+// Feed the next bytes of the text; state carries across calls
+void prefixMatcherFeed(PrefixMatcher* matcher, const char* buf, size_t size);
+// Longest prefix of the pattern seen anywhere in the text so far
+size_t prefixMatcherLongest(const PrefixMatcher* matcher);
+// Pick up a text from a checkpoint: its last bytes and the longest prefix it
+// had. The state only depends on the last length - 1 bytes, so a tail that
+// long (or the whole text) rebuilds it exactly.
+void prefixMatcherResume(PrefixMatcher* matcher, const char* tail, size_t tailLength, size_t longest);
+
+// A set of named patterns of any length, compiled into one automaton so a
+// single pass over the buffer finds, for every pattern, the longest prefix
+// of it that occurs anywhere in the buffer.
+typedef struct PatternSet PatternSet;
+
+PatternSet* patternSetCreate(void);
+void patternSetFree(PatternSet* set);
+
+// Add a pattern (copied). Returns its index, or -1 once the set is built or on error.
+int patternSetAdd(PatternSet* set, const char* name, const char* bytes, size_t length);
+// Add "pi", "e" or "sqrt2". Returns its index, or -1 for an unknown name.
+int patternSetAddBuiltin(PatternSet* set, const char* name);
+// 1 if pattern `index` is one of those references (name and digits), else 0
+int patternSetIsBuiltin(const PatternSet* set, int index);
+// Compile the automaton; no patterns can be added afterwards. Returns -1 on failure.
+int patternSetBuild(PatternSet* set);
+
+int patternSetCount(const PatternSet* set);
+const char* patternSetName(const PatternSet* set, int index);
+// The bytes of pattern `index`, their count in *length
+const char* patternSetBytes(const PatternSet* set, int index, size_t* length);
+// Length of the longest pattern (how far a match can reach past its start)
+size_t patternSetMaxLength(const PatternSet* set);
+// FNV-1a over every name and pattern, to tell whether two sets are the same
+uint64_t patternSetHash(const PatternSet* set);
+
+// One scan over a (possibly chunked) buffer. The automaton state carries
+// across feeds, so chunks need no overlap. A set with a single pattern is
+// scanned with a PrefixMatcher instead of the automaton.
+typedef struct PatternMatch PatternMatch;
+
+PatternMatch* patternMatchCreate(const PatternSet* set);
+void patternMatchFree(PatternMatch* match);
+void patternMatchFeed(PatternMatch* match, const char* buf, size_t size);
+size_t patternMatchLongest(const PatternMatch* match, int index);
+// As prefixMatcherResume(), with one longest prefix per pattern; the tail
+// needs the last patternSetMaxLength() bytes
+void patternMatchResume(PatternMatch* match, const char* tail, size_t tailLength, const size_t* longest);
+
+#endif
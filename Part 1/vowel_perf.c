@@ -0,0 +1,129 @@
+/* vowel_perf.c */
+/* Hardware counters around a stage of the analysis (perf_event_open) */
+
+#include <string.h> // for memset
+#include <errno.h>
+#include <unistd.h> // for syscall(), read()
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "vowel_perf.h"
+
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+} events[PERF_COUNTER_COUNT] = {
+    [PERF_CYCLES]        = { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERF_INSTRUCTIONS]  = { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERF_L1D_MISSES]    = { "l1d_misses", PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D) },
+    [PERF_LLC_MISSES]    = { "llc_misses", PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL) },
+    [PERF_BRANCH_MISSES] = { "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    [PERF_DTLB_MISSES]   = { "dtlb_misses", PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB) },
+    [PERF_TASK_CLOCK]    = { "task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    [PERF_PAGE_FAULTS]   = { "page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+};
+
+// What read() returns with the format below
+typedef struct {
+    uint64_t value;
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+} CounterReading;
+
+int perfCountersOpen(PerfCounters* counters) {
+    memset(counters, 0, sizeof(PerfCounters));
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[id].type;
+        attr.config = events[id].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // Allowed at perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        counters->fds[id] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counters->fds[id] >= 0) {
+            counters->available++;
+        } else if (counters->firstError == 0) {
+            counters->firstError = errno;
+        }
+    }
+    return counters->available;
+}
+
+void perfCountersClose(PerfCounters* counters) {
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        if (counters->fds[id] >= 0) close(counters->fds[id]);
+        counters->fds[id] = -1;
+    }
+    counters->available = 0;
+}
+
+void perfCountersStart(PerfCounters* counters) {
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        if (counters->fds[id] < 0) continue;
+        ioctl(counters->fds[id], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counters->fds[id], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void perfCountersStop(PerfCounters* counters, PerfSample* sample) {
+    // Disable everything first so reading one counter is not counted by the next
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        if (counters->fds[id] >= 0) ioctl(counters->fds[id], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    memset(sample, 0, sizeof(PerfSample));
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        CounterReading reading;
+        if (counters->fds[id] < 0 || read(counters->fds[id], &reading, sizeof(reading)) != sizeof(reading)) {
+            continue;
+        }
+        if (reading.timeRunning == 0) continue; // Never got a hardware counter
+        // More events than counters: the kernel time-shares them, so scale up
+        sample->values[id] = reading.timeRunning < reading.timeEnabled
+            ? (uint64_t)((double)reading.value * reading.timeEnabled / reading.timeRunning)
+            : reading.value;
+        sample->valid[id] = true;
+    }
+}
+
+const char* perfCounterName(PerfCounterId id) {
+    return events[id].name;
+}
+
+const char* perfCountersNote(const PerfCounters* counters) {
+    if (counters->available == PERF_COUNTER_COUNT) return NULL;
+    switch (counters->firstError) {
+        case ENOENT:
+        case EOPNOTSUPP:
+            return "some events are not supported here (no PMU, e.g. in a VM)";
+        case EACCES:
+        case EPERM:
+            return "perf events are restricted (see /proc/sys/kernel/perf_event_paranoid)";
+        case ENOSYS:
+            return "perf_event_open is not available";
+        default:
+            return "some events could not be opened";
+    }
+}
+
+void perfSamplePrintJson(FILE* out, const PerfSample* sample) {
+    fputc('{', out);
+    const char* separator = "";
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        if (!sample->valid[id]) continue;
+        fprintf(out, "%s\"%s\":%llu", separator, events[id].name, (unsigned long long)sample->values[id]);
+        separator = ",";
+    }
+    if (sample->valid[PERF_CYCLES] && sample->valid[PERF_INSTRUCTIONS] && sample->values[PERF_CYCLES] > 0) {
+        fprintf(out, "%s\"ipc\":%.3f", separator,
+                (double)sample->values[PERF_INSTRUCTIONS] / sample->values[PERF_CYCLES]);
+    }
+    fputc('}', out);
+}
@@ -0,0 +1,53 @@
+/* vowel_perf.h */
+/* Hardware counters around a stage of the analysis (perf_event_open) */
+
+#ifndef VOWEL_PERF_H
+#define VOWEL_PERF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Counted for the calling thread, user space only, so perf_event_paranoid=2
+// (the usual default) is enough. Each counter opens on its own: on a host or
+// VM without some event (no PMU, restricted paranoia) the rest still work.
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_TASK_CLOCK,   // Software: ns on the CPU, available without a PMU
+    PERF_PAGE_FAULTS,  // Software
+    PERF_COUNTER_COUNT
+} PerfCounterId;
+
+typedef struct {
+    int fds[PERF_COUNTER_COUNT]; // -1 where the event could not be opened
+    int available;
+    int firstError;              // errno of the first event that failed, or 0
+} PerfCounters;
+
+typedef struct {
+    bool valid[PERF_COUNTER_COUNT];
+    uint64_t values[PERF_COUNTER_COUNT]; // Scaled up if the kernel multiplexed
+} PerfSample;
+
+// Returns how many counters opened (0 = instrumentation unavailable)
+int perfCountersOpen(PerfCounters* counters);
+void perfCountersClose(PerfCounters* counters);
+
+void perfCountersStart(PerfCounters* counters);
+void perfCountersStop(PerfCounters* counters, PerfSample* sample);
+
+// Short name used as the table header and JSON key, e.g. "llc_misses"
+const char* perfCounterName(PerfCounterId id);
+
+// Why counters are missing, for a one-line note (NULL when all opened)
+const char* perfCountersNote(const PerfCounters* counters);
+
+// One JSON object of the valid counters, plus "ipc" when both sides are known
+void perfSamplePrintJson(FILE* out, const PerfSample* sample);
+
+#endif
@@ -0,0 +1,487 @@
+/* vowel_pool.c */
+/* Thread pools: work stealing (one Chase-Lev deque per worker) and a parked job pool */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h> // for memset
+#include <semaphore.h> // for parking idle job workers
+#include <unistd.h> // for sysconf()
+#include <pthread.h>
+#include <stdatomic.h>
+#include "vowel_pool.h"
+
+#define INITIAL_DEQUE_CAPACITY 64 // Slots per deque before the first grow (power of two)
+
+typedef struct {
+    WorkFn fn;
+    void* arg;
+} WorkTask;
+
+// Ring of task pointers. A grown deque keeps its old rings until the pool is
+// freed, since a thief may still be reading one.
+typedef struct TaskRing {
+    int64_t capacity;
+    struct TaskRing* retired;
+    _Atomic(WorkTask*) slots[];
+} TaskRing;
+
+// The owner pushes and pops at bottom; thieves take from top. Padded so the
+// owner's and the thieves' indices of different workers never share a line.
+typedef struct {
+    _Atomic int64_t top;
+    _Atomic int64_t bottom;
+    _Atomic(TaskRing*) ring;
+    uint64_t rng; // Victim selection, owner only
+} __attribute__((aligned(64))) Deque;
+
+struct WorkPool {
+    int workers;
+    int nextDeal;           // Round-robin target for submissions before run
+    _Atomic long pending;   // Submitted but not yet finished
+    Deque* deques;
+
+    // Workers with nothing to steal park here until a push or the last task ends
+    _Atomic unsigned long pushes; // Bumped after every push, so a parked worker sees it
+    _Atomic int sleepers;
+    pthread_mutex_t idleLock;
+    pthread_cond_t idle;
+};
+
+static _Thread_local WorkPool* currentPool = NULL;
+static _Thread_local int currentWorker = -1;
+
+static TaskRing* ringCreate(int64_t capacity) {
+    TaskRing* ring = (TaskRing*)calloc(1, sizeof(TaskRing) + capacity * sizeof(WorkTask*));
+    if (ring != NULL) ring->capacity = capacity;
+    return ring;
+}
+
+// ==========================================
+// CHASE-LEV DEQUE
+// ==========================================
+// Lê, Pop, Cohen, Zappa Nardelli: "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (PPoPP 2013), with the same fences.
+
+static int dequePush(Deque* deque, WorkTask* task) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    TaskRing* ring = atomic_load_explicit(&deque->ring, memory_order_relaxed);
+
+    if (bottom - top > ring->capacity - 1) {
+        // Full: copy the live range into a ring twice the size
+        TaskRing* grown = ringCreate(ring->capacity * 2);
+        if (grown == NULL) return -1;
+        for (int64_t i = top; i < bottom; i++) {
+            atomic_store_explicit(&grown->slots[i & (grown->capacity - 1)],
+                                  atomic_load_explicit(&ring->slots[i & (ring->capacity - 1)],
+                                                       memory_order_relaxed),
+                                  memory_order_relaxed);
+        }
+        grown->retired = ring;
+        atomic_store_explicit(&deque->ring, grown, memory_order_release);
+        ring = grown;
+    }
+
+    atomic_store_explicit(&ring->slots[bottom & (ring->capacity - 1)], task, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return 0;
+}
+
+static WorkTask* dequePop(Deque* deque) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    TaskRing* ring = atomic_load_explicit(&deque->ring, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    WorkTask* task = NULL;
+    if (top <= bottom) {
+        task = atomic_load_explicit(&ring->slots[bottom & (ring->capacity - 1)], memory_order_relaxed);
+        if (top == bottom) {
+            // Last task: race the thieves for it
+            if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed)) {
+                task = NULL;
+            }
+            atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static WorkTask* dequeSteal(Deque* deque) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return NULL;
+
+    TaskRing* ring = atomic_load_explicit(&deque->ring, memory_order_acquire);
+    WorkTask* task = atomic_load_explicit(&ring->slots[top & (ring->capacity - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL; // Lost to the owner or another thief
+    }
+    return task;
+}
+
+// ==========================================
+// POOL
+// ==========================================
+
+WorkPool* workPoolCreate(int workers) {
+    if (workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers <= 0) workers = 1;
+
+    WorkPool* pool = (WorkPool*)calloc(1, sizeof(WorkPool));
+    if (pool == NULL) return NULL;
+    pool->workers = workers;
+    pthread_mutex_init(&pool->idleLock, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    pool->deques = (Deque*)aligned_alloc(64, workers * sizeof(Deque));
+    if (pool->deques == NULL) {
+        pool->workers = 0;
+        workPoolFree(pool);
+        return NULL;
+    }
+    for (int w = 0; w < workers; w++) {
+        Deque* deque = &pool->deques[w];
+        atomic_init(&deque->top, 0);
+        atomic_init(&deque->bottom, 0);
+        atomic_init(&deque->ring, ringCreate(INITIAL_DEQUE_CAPACITY));
+        deque->rng = 0x9E3779B97F4A7C15ULL * (w + 1);
+        if (atomic_load(&deque->ring) == NULL) {
+            pool->workers = w; // Free only what was set up
+            workPoolFree(pool);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void workPoolFree(WorkPool* pool) {
+    if (pool == NULL) return;
+    for (int w = 0; w < pool->workers; w++) {
+        Deque* deque = &pool->deques[w];
+        // Tasks still queued (the pool never ran) are dropped
+        WorkTask* task;
+        while ((task = dequePop(deque)) != NULL) free(task);
+        TaskRing* ring = atomic_load(&deque->ring);
+        while (ring != NULL) {
+            TaskRing* retired = ring->retired;
+            free(ring);
+            ring = retired;
+        }
+    }
+    pthread_mutex_destroy(&pool->idleLock);
+    pthread_cond_destroy(&pool->idle);
+    free(pool->deques);
+    free(pool);
+}
+
+int workPoolWorkers(const WorkPool* pool) {
+    return pool->workers;
+}
+
+int workPoolSubmit(WorkPool* pool, WorkFn fn, void* arg) {
+    WorkTask* task = (WorkTask*)malloc(sizeof(WorkTask));
+    if (task == NULL) return -1;
+    task->fn = fn;
+    task->arg = arg;
+
+    int target;
+    if (currentPool == pool) {
+        target = currentWorker;
+    } else {
+        target = pool->nextDeal;
+        pool->nextDeal = (pool->nextDeal + 1) % pool->workers;
+    }
+    atomic_fetch_add(&pool->pending, 1);
+    if (dequePush(&pool->deques[target], task) != 0) {
+        atomic_fetch_sub(&pool->pending, 1);
+        free(task);
+        return -1;
+    }
+    // A worker that counted itself a sleeper before this bump rechecks
+    // `pushes` under the lock, so the signal below cannot be missed
+    atomic_fetch_add(&pool->pushes, 1);
+    if (atomic_load(&pool->sleepers) > 0) {
+        pthread_mutex_lock(&pool->idleLock);
+        pthread_cond_signal(&pool->idle);
+        pthread_mutex_unlock(&pool->idleLock);
+    }
+    return 0;
+}
+
+// Own deque first; when it is empty, steal from a random victim
+static WorkTask* findTask(WorkPool* pool, int worker) {
+    Deque* own = &pool->deques[worker];
+    WorkTask* task = dequePop(own);
+    if (task != NULL || pool->workers == 1) return task;
+
+    own->rng ^= own->rng << 13;
+    own->rng ^= own->rng >> 7;
+    own->rng ^= own->rng << 17;
+    int start = (int)(own->rng % pool->workers);
+    for (int i = 0; i < pool->workers; i++) {
+        int victim = (start + i) % pool->workers;
+        if (victim == worker) continue;
+        task = dequeSteal(&pool->deques[victim]);
+        if (task != NULL) return task;
+    }
+    return NULL;
+}
+
+typedef struct {
+    WorkPool* pool;
+    int worker;
+} WorkerStart;
+
+// Nothing to steal while others are still busy: sleep until a task they
+// submit arrives or the last one finishes
+static void parkIdle(WorkPool* pool, unsigned long pushesSeen) {
+    pthread_mutex_lock(&pool->idleLock);
+    atomic_fetch_add(&pool->sleepers, 1);
+    while (atomic_load(&pool->pushes) == pushesSeen && atomic_load(&pool->pending) > 0) {
+        pthread_cond_wait(&pool->idle, &pool->idleLock);
+    }
+    atomic_fetch_sub(&pool->sleepers, 1);
+    pthread_mutex_unlock(&pool->idleLock);
+}
+
+static void* workerLoop(void* arg) {
+    WorkerStart* start = (WorkerStart*)arg;
+    WorkPool* pool = start->pool;
+    currentPool = pool;
+    currentWorker = start->worker;
+
+    while (atomic_load(&pool->pending) > 0) {
+        unsigned long pushesSeen = atomic_load(&pool->pushes);
+        WorkTask* task = findTask(pool, currentWorker);
+        if (task == NULL) {
+            parkIdle(pool, pushesSeen);
+            continue;
+        }
+        task->fn(task->arg, currentWorker);
+        free(task);
+        if (atomic_fetch_sub(&pool->pending, 1) == 1) {
+            pthread_mutex_lock(&pool->idleLock);
+            pthread_cond_broadcast(&pool->idle);
+            pthread_mutex_unlock(&pool->idleLock);
+        }
+    }
+
+    currentPool = NULL;
+    currentWorker = -1;
+    return NULL;
+}
+
+void workPoolRun(WorkPool* pool) {
+    pthread_t* threads = (pthread_t*)malloc(pool->workers * sizeof(pthread_t));
+    WorkerStart* starts = (WorkerStart*)malloc(pool->workers * sizeof(WorkerStart));
+    int spawned = 1;
+    if (threads != NULL && starts != NULL) {
+        for (; spawned < pool->workers; spawned++) {
+            starts[spawned].pool = pool;
+            starts[spawned].worker = spawned;
+            if (pthread_create(&threads[spawned], NULL, workerLoop, &starts[spawned]) != 0) break;
+        }
+    }
+
+    // Worker 0 runs on the calling thread; deques of workers that failed to
+    // start are drained by stealing
+    WorkerStart self = { pool, 0 };
+    workerLoop(&self);
+
+    for (int w = 1; w < spawned; w++) pthread_join(threads[w], NULL);
+    free(threads);
+    free(starts);
+}
+
+// ==========================================
+// JOB POOL (Persistent, Bounded MPMC Queue)
+// ==========================================
+// Vyukov's bounded MPMC queue: each cell's sequence number says whose turn it
+// is, so producers and consumers only contend on their own position counter.
+
+#define JOB_QUEUE_CAPACITY 1024 // Power of two; a full queue runs jobs inline
+
+typedef struct {
+    _Atomic size_t sequence;
+    JobFn fn;
+    void* arg;
+    JobGroup* group;
+} JobCell;
+
+struct JobPool {
+    JobCell* cells;
+    _Atomic size_t enqueuePos __attribute__((aligned(64)));
+    _Atomic size_t dequeuePos __attribute__((aligned(64)));
+    sem_t ready __attribute__((aligned(64))); // One post per queued job
+    atomic_bool stopping;
+    int threads;
+    pthread_t* handles;
+};
+
+static int jobQueuePush(JobPool* pool, JobFn fn, void* arg, JobGroup* group) {
+    size_t pos = atomic_load_explicit(&pool->enqueuePos, memory_order_relaxed);
+    JobCell* cell;
+    for (;;) {
+        cell = &pool->cells[pos & (JOB_QUEUE_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&pool->enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; // Full
+        } else {
+            pos = atomic_load_explicit(&pool->enqueuePos, memory_order_relaxed);
+        }
+    }
+    cell->fn = fn;
+    cell->arg = arg;
+    cell->group = group;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return 0;
+}
+
+static int jobQueuePop(JobPool* pool, JobFn* fn, void** arg, JobGroup** group) {
+    size_t pos = atomic_load_explicit(&pool->dequeuePos, memory_order_relaxed);
+    JobCell* cell;
+    for (;;) {
+        cell = &pool->cells[pos & (JOB_QUEUE_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&pool->dequeuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1; // Empty
+        } else {
+            pos = atomic_load_explicit(&pool->dequeuePos, memory_order_relaxed);
+        }
+    }
+    *fn = cell->fn;
+    *arg = cell->arg;
+    *group = cell->group;
+    atomic_store_explicit(&cell->sequence, pos + JOB_QUEUE_CAPACITY, memory_order_release);
+    return 0;
+}
+
+static void finishJob(JobGroup* group) {
+    long left = atomic_load_explicit(&group->pending, memory_order_relaxed);
+    while (left > 1) {
+        if (atomic_compare_exchange_weak_explicit(&group->pending, &left, left - 1,
+                                                  memory_order_acq_rel, memory_order_relaxed)) {
+            return;
+        }
+    }
+    // Possibly the last one: count down under the lock, so the submitter
+    // cannot see zero and drop the group while this thread still signals it
+    pthread_mutex_lock(&group->lock);
+    if (atomic_fetch_sub_explicit(&group->pending, 1, memory_order_acq_rel) == 1) {
+        pthread_cond_broadcast(&group->done);
+    }
+    pthread_mutex_unlock(&group->lock);
+}
+
+// Runs one queued job, if there is one
+static int runQueuedJob(JobPool* pool) {
+    JobFn fn;
+    void* arg;
+    JobGroup* group;
+    if (jobQueuePop(pool, &fn, &arg, &group) != 0) return 0;
+    fn(arg);
+    finishJob(group);
+    return 1;
+}
+
+static void* jobWorker(void* arg) {
+    JobPool* pool = (JobPool*)arg;
+    for (;;) {
+        while (sem_wait(&pool->ready) != 0) {
+        }
+        if (atomic_load(&pool->stopping)) return NULL;
+        runQueuedJob(pool); // May find nothing: a waiting submitter got there first
+    }
+}
+
+JobPool* jobPoolCreate(int threads) {
+    JobPool* pool = (JobPool*)aligned_alloc(64, sizeof(JobPool));
+    if (pool == NULL) return NULL;
+    memset(pool, 0, sizeof(JobPool));
+    pool->cells = (JobCell*)calloc(JOB_QUEUE_CAPACITY, sizeof(JobCell));
+    pool->handles = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    if (pool->cells == NULL || pool->handles == NULL || sem_init(&pool->ready, 0, 0) != 0) {
+        free(pool->cells);
+        free(pool->handles);
+        free(pool);
+        return NULL;
+    }
+    for (size_t i = 0; i < JOB_QUEUE_CAPACITY; i++) atomic_init(&pool->cells[i].sequence, i);
+    atomic_init(&pool->enqueuePos, 0);
+    atomic_init(&pool->dequeuePos, 0);
+    atomic_init(&pool->stopping, false);
+
+    for (; pool->threads < threads; pool->threads++) {
+        if (pthread_create(&pool->handles[pool->threads], NULL, jobWorker, pool) != 0) break;
+    }
+    if (pool->threads == 0) {
+        jobPoolFree(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void jobPoolFree(JobPool* pool) {
+    if (pool == NULL) return;
+    atomic_store(&pool->stopping, true);
+    for (int t = 0; t < pool->threads; t++) sem_post(&pool->ready);
+    for (int t = 0; t < pool->threads; t++) pthread_join(pool->handles[t], NULL);
+    sem_destroy(&pool->ready);
+    free(pool->handles);
+    free(pool->cells);
+    free(pool);
+}
+
+void jobGroupInit(JobGroup* group) {
+    atomic_init(&group->pending, 0);
+    pthread_mutex_init(&group->lock, NULL);
+    pthread_cond_init(&group->done, NULL);
+}
+
+void jobGroupDestroy(JobGroup* group) {
+    pthread_mutex_destroy(&group->lock);
+    pthread_cond_destroy(&group->done);
+}
+
+void jobPoolSubmit(JobPool* pool, JobGroup* group, JobFn fn, void* arg) {
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    if (jobQueuePush(pool, fn, arg, group) != 0) {
+        fn(arg);
+        finishJob(group);
+        return;
+    }
+    sem_post(&pool->ready);
+}
+
+void jobPoolWait(JobPool* pool, JobGroup* group) {
+    // Help while there is queued work, then sleep until the stragglers finish.
+    // Only this thread submits to the group, so once the queue has run dry
+    // every job of the group is already running somewhere.
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0 && runQueuedJob(pool)) {
+    }
+    pthread_mutex_lock(&group->lock);
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+        pthread_cond_wait(&group->done, &group->lock);
+    }
+    pthread_mutex_unlock(&group->lock);
+}
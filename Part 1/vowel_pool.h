@@ -0,0 +1,56 @@
+/* vowel_pool.h */
+/* Thread pools: work stealing for batch analysis, parked job pool per call */
+
+#ifndef VOWEL_POOL_H
+#define VOWEL_POOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+// A task gets its argument and the index of the worker running it, so it can
+// use per-worker scratch state without locking.
+typedef void (*WorkFn)(void* arg, int worker);
+
+typedef struct WorkPool WorkPool;
+
+// `workers` threads (0 = online CPUs); none start until workPoolRun()
+WorkPool* workPoolCreate(int workers);
+void workPoolFree(WorkPool* pool);
+int workPoolWorkers(const WorkPool* pool);
+
+// Queue a task. Before workPoolRun() tasks are dealt round-robin across the
+// workers; from inside a running task they go on that worker's own deque,
+// where it pops them newest-first and idle workers steal them oldest-first.
+// Submitting from any other thread while the pool runs is not allowed.
+// Returns -1 if out of memory.
+int workPoolSubmit(WorkPool* pool, WorkFn fn, void* arg);
+
+// Run until every queued task, and every task those submit, has finished
+void workPoolRun(WorkPool* pool);
+
+// Persistent pool: threads start once and park between jobs. Any thread may
+// submit over a lock-free bounded MPMC queue; a caller collects its jobs
+// through a JobGroup and helps run queued jobs while it waits, so nested
+// submissions (a job that submits jobs) cannot deadlock.
+typedef void (*JobFn)(void* arg);
+
+typedef struct JobPool JobPool;
+
+typedef struct {
+    _Atomic long pending;
+    pthread_mutex_t lock;   // Only taken to sleep on, or signal, the last job
+    pthread_cond_t done;
+} JobGroup;
+
+JobPool* jobPoolCreate(int threads);
+void jobPoolFree(JobPool* pool);
+
+void jobGroupInit(JobGroup* group);
+void jobGroupDestroy(JobGroup* group);
+
+// Queue fn(arg) as part of `group`; runs it right here if the queue is full
+void jobPoolSubmit(JobPool* pool, JobGroup* group, JobFn fn, void* arg);
+// Return once every job of `group` has finished
+void jobPoolWait(JobPool* pool, JobGroup* group);
+
+#endif
@@ -0,0 +1,408 @@
+/* vowel_reader.c */
+/* Asynchronous in-order block reader: io_uring, or pread threads as fallback */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h> // for memset, strcmp
+#include <errno.h>
+#include <unistd.h> // for pread(), syscall()
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h> // for the io_uring rings
+#include <sys/syscall.h>
+#include <sys/uio.h> // for struct iovec
+#include <linux/io_uring.h>
+#include "vowel_reader.h"
+
+// Block b always lands in slot b % depth: a slot is reused for the block
+// `depth` further on as soon as the caller releases it, so the reads in
+// flight stay `depth` blocks ahead of the analysis.
+
+#define PAGE_BYTES 4096
+#define MAX_READ_BYTES 0x7ffff000 // The most one read returns on Linux; sqe->len is 32 bits
+
+enum { SLOT_FREE, SLOT_READING, SLOT_READY };
+
+typedef struct {
+    char* data;     // Block start; the `headroom` bytes before it are the caller's
+    off_t offset;   // File offset of the block
+    size_t want;    // Block length
+    size_t filled;  // Bytes read so far
+    int state;
+    int error;
+} ReadSlot;
+
+// Rings shared with the kernel (no liburing: the raw syscalls are enough for
+// one producer and one consumer on the same thread)
+typedef struct {
+    int fd;
+    bool fixedBuffers;          // Slots registered, so reads skip the page pinning
+    _Atomic unsigned* sqTail;
+    unsigned sqMask;
+    unsigned* sqArray;
+    struct io_uring_sqe* sqes;
+    _Atomic unsigned* cqHead;
+    _Atomic unsigned* cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe* cqes;
+    void* sqRing;
+    size_t sqRingBytes;
+    void* cqRing;               // Same mapping as sqRing with IORING_FEAT_SINGLE_MMAP
+    size_t cqRingBytes;
+    size_t sqesBytes;
+} UringQueue;
+
+struct BlockReader {
+    int fd;
+    off_t start;
+    size_t length;
+    size_t blockSize;
+    int depth;
+    char* arena;            // All slot buffers, page aligned
+    ReadSlot* slots;
+    size_t blocks;
+    size_t nextIssue;       // Next block to start reading
+    size_t nextConsume;     // Next block to hand out
+    bool useUring;
+    UringQueue uring;
+
+    // pread backend
+    pthread_t* threads;
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    bool stopping;
+};
+
+static void prepareSlot(BlockReader* reader, ReadSlot* slot, size_t block) {
+    slot->offset = reader->start + (off_t)(block * reader->blockSize);
+    slot->want = reader->length - block * reader->blockSize;
+    if (slot->want > reader->blockSize) slot->want = reader->blockSize;
+    slot->filled = 0;
+    slot->error = 0;
+    slot->state = SLOT_READING;
+}
+
+// ==========================================
+// IO_URING BACKEND
+// ==========================================
+
+static int uringSetup(UringQueue* queue, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(queue, 0, sizeof(UringQueue));
+    queue->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (queue->fd < 0) return -1;
+
+    queue->sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    queue->cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && queue->cqRingBytes > queue->sqRingBytes) queue->sqRingBytes = queue->cqRingBytes;
+
+    queue->sqRing = mmap(NULL, queue->sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         queue->fd, IORING_OFF_SQ_RING);
+    if (queue->sqRing == MAP_FAILED) goto fail;
+    queue->cqRing = single ? queue->sqRing
+                           : mmap(NULL, queue->cqRingBytes, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, queue->fd, IORING_OFF_CQ_RING);
+    if (queue->cqRing == MAP_FAILED) goto fail;
+    queue->sqesBytes = params.sq_entries * sizeof(struct io_uring_sqe);
+    queue->sqes = (struct io_uring_sqe*)mmap(NULL, queue->sqesBytes, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, queue->fd, IORING_OFF_SQES);
+    if (queue->sqes == MAP_FAILED) goto fail;
+
+    char* sq = (char*)queue->sqRing;
+    char* cq = (char*)queue->cqRing;
+    queue->sqTail = (_Atomic unsigned*)(sq + params.sq_off.tail);
+    queue->sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    queue->sqArray = (unsigned*)(sq + params.sq_off.array);
+    queue->cqHead = (_Atomic unsigned*)(cq + params.cq_off.head);
+    queue->cqTail = (_Atomic unsigned*)(cq + params.cq_off.tail);
+    queue->cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    queue->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return 0;
+
+fail:
+    if (queue->sqRing != NULL && queue->sqRing != MAP_FAILED) munmap(queue->sqRing, queue->sqRingBytes);
+    if (!single && queue->cqRing != NULL && queue->cqRing != MAP_FAILED) {
+        munmap(queue->cqRing, queue->cqRingBytes);
+    }
+    close(queue->fd);
+    return -1;
+}
+
+static void uringTeardown(UringQueue* queue) {
+    munmap(queue->sqes, queue->sqesBytes);
+    if (queue->cqRing != queue->sqRing) munmap(queue->cqRing, queue->cqRingBytes);
+    munmap(queue->sqRing, queue->sqRingBytes);
+    close(queue->fd); // Also unregisters the buffers
+}
+
+static int uringEnter(UringQueue* queue, unsigned submit, unsigned waitFor) {
+    unsigned flags = waitFor > 0 ? IORING_ENTER_GETEVENTS : 0;
+    for (;;) {
+        long done = syscall(__NR_io_uring_enter, queue->fd, submit, waitFor, flags, NULL, 0);
+        if (done >= 0) return 0;
+        if (errno != EINTR) return -1;
+    }
+}
+
+// Queues the rest of slot `index`'s block, at most MAX_READ_BYTES of it. A
+// larger block finishes through the short-read resubmits in uringReap().
+static int uringSubmitRead(BlockReader* reader, int index) {
+    UringQueue* queue = &reader->uring;
+    ReadSlot* slot = &reader->slots[index];
+    unsigned tail = atomic_load_explicit(queue->sqTail, memory_order_relaxed);
+    unsigned entry = tail & queue->sqMask;
+    struct io_uring_sqe* sqe = &queue->sqes[entry];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = queue->fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = reader->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(slot->data + slot->filled);
+    size_t remaining = slot->want - slot->filled;
+    sqe->len = (unsigned)(remaining < MAX_READ_BYTES ? remaining : MAX_READ_BYTES);
+    sqe->off = (uint64_t)(slot->offset + slot->filled);
+    sqe->buf_index = queue->fixedBuffers ? (uint16_t)index : 0;
+    sqe->user_data = (uint64_t)index;
+    queue->sqArray[entry] = entry;
+    atomic_store_explicit(queue->sqTail, tail + 1, memory_order_release);
+    return uringEnter(queue, 1, 0);
+}
+
+// Consumes completions, waiting for at least one if `wait` is set. Short
+// reads are resubmitted for the remainder; a zero-byte read means the file
+// ended early and the slot is handed out with what it has.
+static int uringReap(BlockReader* reader, bool wait) {
+    UringQueue* queue = &reader->uring;
+    if (wait && uringEnter(queue, 0, 1) != 0) return -1;
+
+    unsigned head = atomic_load_explicit(queue->cqHead, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(queue->cqTail, memory_order_acquire);
+    int status = 0;
+    for (; head != tail; head++) {
+        struct io_uring_cqe* cqe = &queue->cqes[head & queue->cqMask];
+        int index = (int)cqe->user_data;
+        ReadSlot* slot = &reader->slots[index];
+        bool resubmit = false;
+        if (cqe->res == -EINTR || cqe->res == -EAGAIN) {
+            resubmit = true;
+        } else if (cqe->res < 0) {
+            slot->error = -cqe->res;
+            slot->state = SLOT_READY;
+        } else {
+            slot->filled += (size_t)cqe->res;
+            if (cqe->res == 0 || slot->filled == slot->want) {
+                slot->state = SLOT_READY;
+            } else {
+                resubmit = true;
+            }
+        }
+        // Free the completion entry before the resubmit can need it
+        atomic_store_explicit(queue->cqHead, head + 1, memory_order_release);
+        if (resubmit && uringSubmitRead(reader, index) != 0) {
+            slot->error = EIO;
+            slot->state = SLOT_READY;
+            status = -1;
+        }
+    }
+    return status;
+}
+
+static int uringStart(BlockReader* reader) {
+    if (uringSetup(&reader->uring, (unsigned)reader->depth) != 0) return -1;
+
+    // Registered buffers are pinned once here instead of on every read. The
+    // locked-memory limit may refuse them; plain reads work the same way.
+    struct iovec* vectors = (struct iovec*)malloc(reader->depth * sizeof(struct iovec));
+    if (vectors != NULL) {
+        for (int i = 0; i < reader->depth; i++) {
+            vectors[i].iov_base = reader->slots[i].data;
+            vectors[i].iov_len = reader->blockSize;
+        }
+        reader->uring.fixedBuffers =
+            syscall(__NR_io_uring_register, reader->uring.fd, IORING_REGISTER_BUFFERS,
+                    vectors, reader->depth) == 0;
+        free(vectors);
+    }
+
+    for (; reader->nextIssue < reader->blocks && reader->nextIssue < (size_t)reader->depth;
+         reader->nextIssue++) {
+        int index = (int)reader->nextIssue;
+        prepareSlot(reader, &reader->slots[index], reader->nextIssue);
+        if (uringSubmitRead(reader, index) != 0) {
+            // Nothing reads into the buffers once the ring is gone
+            uringTeardown(&reader->uring);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// ==========================================
+// PREAD BACKEND (Fallback)
+// ==========================================
+
+static void* preadWorker(void* arg) {
+    BlockReader* reader = (BlockReader*)arg;
+    pthread_mutex_lock(&reader->lock);
+    for (;;) {
+        while (!reader->stopping &&
+               !(reader->nextIssue < reader->blocks &&
+                 reader->slots[reader->nextIssue % reader->depth].state == SLOT_FREE)) {
+            pthread_cond_wait(&reader->changed, &reader->lock);
+        }
+        if (reader->stopping) break;
+        ReadSlot* slot = &reader->slots[reader->nextIssue % reader->depth];
+        prepareSlot(reader, slot, reader->nextIssue++);
+        pthread_mutex_unlock(&reader->lock);
+
+        while (slot->filled < slot->want) {
+            ssize_t got = pread(reader->fd, slot->data + slot->filled, slot->want - slot->filled,
+                                slot->offset + (off_t)slot->filled);
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) slot->error = errno;
+            if (got <= 0) break;
+            slot->filled += (size_t)got;
+        }
+
+        pthread_mutex_lock(&reader->lock);
+        slot->state = SLOT_READY;
+        pthread_cond_broadcast(&reader->changed);
+    }
+    pthread_mutex_unlock(&reader->lock);
+    return NULL;
+}
+
+static int preadStart(BlockReader* reader) {
+    reader->threads = (pthread_t*)malloc(reader->depth * sizeof(pthread_t));
+    if (reader->threads == NULL) return -1;
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->changed, NULL);
+    for (; reader->threadCount < reader->depth; reader->threadCount++) {
+        if (pthread_create(&reader->threads[reader->threadCount], NULL, preadWorker, reader) != 0) break;
+    }
+    if (reader->threadCount > 0) return 0;
+    free(reader->threads);
+    pthread_mutex_destroy(&reader->lock);
+    pthread_cond_destroy(&reader->changed);
+    return -1;
+}
+
+// ==========================================
+// READER
+// ==========================================
+
+BlockReader* blockReaderOpen(int fd, off_t offset, size_t length, size_t blockSize, int depth,
+                             size_t headroom, const char* backend) {
+    bool tryUring = backend == NULL || strcmp(backend, "io_uring") == 0;
+    bool tryPread = backend == NULL || strcmp(backend, "pread") == 0;
+    if ((!tryUring && !tryPread) || blockSize == 0 || depth <= 0) return NULL;
+
+    BlockReader* reader = (BlockReader*)calloc(1, sizeof(BlockReader));
+    if (reader == NULL) return NULL;
+    reader->fd = fd;
+    reader->start = offset;
+    reader->length = length;
+    reader->blockSize = blockSize;
+    reader->blocks = (length + blockSize - 1) / blockSize;
+    reader->depth = reader->blocks < (size_t)depth ? (int)(reader->blocks ? reader->blocks : 1) : depth;
+
+    // Headroom rounded up to whole pages keeps every block page aligned
+    size_t lead = (headroom + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+    size_t stride = lead + (blockSize + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+    reader->arena = (char*)aligned_alloc(PAGE_BYTES, reader->depth * stride);
+    reader->slots = (ReadSlot*)calloc(reader->depth, sizeof(ReadSlot));
+    if (reader->arena == NULL || reader->slots == NULL) {
+        free(reader->arena);
+        free(reader->slots);
+        free(reader);
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(reader->arena, reader->depth * stride, MADV_HUGEPAGE); // Best effort
+#endif
+    for (int i = 0; i < reader->depth; i++) reader->slots[i].data = reader->arena + i * stride + lead;
+
+    if (tryUring && uringStart(reader) == 0) {
+        reader->useUring = true;
+        return reader;
+    }
+    reader->nextIssue = 0;
+    for (int i = 0; i < reader->depth; i++) reader->slots[i].state = SLOT_FREE;
+    if (tryPread && preadStart(reader) == 0) return reader;
+
+    free(reader->arena);
+    free(reader->slots);
+    free(reader);
+    return NULL;
+}
+
+void blockReaderClose(BlockReader* reader) {
+    if (reader == NULL) return;
+    if (reader->useUring) {
+        // The kernel may still be writing into the buffers: drain first
+        for (int i = 0; i < reader->depth; i++) {
+            while (reader->slots[i].state == SLOT_READING) {
+                if (uringReap(reader, true) != 0) break;
+            }
+        }
+        uringTeardown(&reader->uring);
+    } else {
+        pthread_mutex_lock(&reader->lock);
+        reader->stopping = true;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+        for (int t = 0; t < reader->threadCount; t++) pthread_join(reader->threads[t], NULL);
+        pthread_mutex_destroy(&reader->lock);
+        pthread_cond_destroy(&reader->changed);
+        free(reader->threads);
+    }
+    free(reader->arena);
+    free(reader->slots);
+    free(reader);
+}
+
+const char* blockReaderBackend(const BlockReader* reader) {
+    return reader->useUring ? "io_uring" : "pread";
+}
+
+ssize_t blockReaderNext(BlockReader* reader, char** data) {
+    if (reader->nextConsume == reader->blocks) return 0;
+    ReadSlot* slot = &reader->slots[reader->nextConsume % reader->depth];
+
+    if (reader->useUring) {
+        while (slot->state != SLOT_READY) {
+            if (uringReap(reader, true) != 0 && slot->state != SLOT_READY) return -1;
+        }
+    } else {
+        pthread_mutex_lock(&reader->lock);
+        while (slot->state != SLOT_READY) pthread_cond_wait(&reader->changed, &reader->lock);
+        pthread_mutex_unlock(&reader->lock);
+    }
+    if (slot->error != 0) return -1;
+    *data = slot->data;
+    return (ssize_t)slot->filled;
+}
+
+void blockReaderRelease(BlockReader* reader) {
+    int index = (int)(reader->nextConsume % reader->depth);
+    reader->nextConsume++;
+
+    if (reader->useUring) {
+        reader->slots[index].state = SLOT_FREE;
+        if (reader->nextIssue < reader->blocks) {
+            prepareSlot(reader, &reader->slots[index], reader->nextIssue++);
+            if (uringSubmitRead(reader, index) != 0) {
+                reader->slots[index].error = EIO;
+                reader->slots[index].state = SLOT_READY;
+            }
+        }
+    } else {
+        pthread_mutex_lock(&reader->lock);
+        reader->slots[index].state = SLOT_FREE;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+    }
+}
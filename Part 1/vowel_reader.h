@@ -0,0 +1,31 @@
+/* vowel_reader.h */
+/* Asynchronous in-order block reader: io_uring, or pread threads as fallback */
+
+#ifndef VOWEL_READER_H
+#define VOWEL_READER_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+// Reads bytes [offset, offset + length) of a file in `blockSize` blocks with
+// up to `depth` reads in flight, and hands the blocks back in file order as
+// they complete, so the caller analyzes one block while the next ones load.
+typedef struct BlockReader BlockReader;
+
+// `backend` is "io_uring", "pread", or NULL to try io_uring first. Every
+// block has `headroom` writable bytes in front of it (for a carry the caller
+// prepends). Returns NULL if the backend is unavailable or out of memory.
+BlockReader* blockReaderOpen(int fd, off_t offset, size_t length, size_t blockSize, int depth,
+                             size_t headroom, const char* backend);
+void blockReaderClose(BlockReader* reader);
+
+// The backend actually in use
+const char* blockReaderBackend(const BlockReader* reader);
+
+// Waits for the next block in file order and points *data at it. Returns its
+// length, 0 at the end, or -1 on a read error. The block stays valid until
+// blockReaderRelease(), which also reuses its buffer for a read further on.
+ssize_t blockReaderNext(BlockReader* reader, char** data);
+void blockReaderRelease(BlockReader* reader);
+
+#endif
@@ -0,0 +1,281 @@
+/* vowel_simd.c */
+/* SSE2 / AVX2 / AVX-512 kernels with runtime dispatch */
+
+#include <string.h>
+#include <immintrin.h>
+#include "vowel_simd.h"
+
+// Every kernel must give bit-for-bit the same answer as the scalar code.
+// Buffers are never read past the bytes the caller vouched for: the last
+// partial vector is loaded overlapping the previous one and the repeated
+// lanes are masked off.
+
+// Scalar tails
+static int isVowelByte(unsigned char c) {
+    c |= 0x20; // Fold 'A'..'Z' onto 'a'..'z'; no other byte lands on a vowel
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+}
+
+// ==========================================
+// SSE2 (16 bytes per step)
+// ==========================================
+
+__attribute__((target("sse2,popcnt")))
+static int hammingScoreSse2(const char* p, const char* pattern, size_t length) {
+    int score = 0;
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)),
+                                    _mm_loadu_si128((const __m128i*)(pattern + i)));
+        score += __builtin_popcount(_mm_movemask_epi8(eq));
+    }
+    if (i < length) {
+        if (length < 16) {
+            for (; i < length; i++) score += (p[i] == pattern[i]);
+        } else {
+            size_t back = length - 16; // Overlaps [back, i) which is already counted
+            __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + back)),
+                                        _mm_loadu_si128((const __m128i*)(pattern + back)));
+            unsigned mask = _mm_movemask_epi8(eq) >> (i - back);
+            score += __builtin_popcount(mask);
+        }
+    }
+    return score;
+}
+
+__attribute__((target("sse2")))
+static size_t prefixLengthSse2(const char* p, const char* pattern, size_t max) {
+    size_t i = 0;
+    for (; i + 16 <= max; i += 16) {
+        __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)),
+                                    _mm_loadu_si128((const __m128i*)(pattern + i)));
+        unsigned mismatch = ~_mm_movemask_epi8(eq) & 0xFFFF;
+        if (mismatch) return i + __builtin_ctz(mismatch);
+    }
+    while (i < max && p[i] == pattern[i]) i++;
+    return i;
+}
+
+__attribute__((target("sse2,popcnt")))
+static uint64_t countVowelsSse2(const char* buf, size_t size) {
+    // No byte shuffle before SSSE3: fold case, then compare against each vowel
+    const __m128i fold = _mm_set1_epi8(0x20);
+    const __m128i a = _mm_set1_epi8('a'), e = _mm_set1_epi8('e'), i_ = _mm_set1_epi8('i');
+    const __m128i o = _mm_set1_epi8('o'), u = _mm_set1_epi8('u');
+    uint64_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i c = _mm_or_si128(_mm_loadu_si128((const __m128i*)(buf + i)), fold);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, a), _mm_cmpeq_epi8(c, e)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(c, i_), _mm_or_si128(_mm_cmpeq_epi8(c, o),
+                                                                                    _mm_cmpeq_epi8(c, u))));
+        count += __builtin_popcount(_mm_movemask_epi8(hit));
+    }
+    for (; i < size; i++) count += isVowelByte((unsigned char)buf[i]);
+    return count;
+}
+
+// The high-byte mask of buf[0..min(size, 64)) one byte at a time, for the
+// last bytes of a buffer where a full vector would read past the end
+static uint64_t highBytesTail(const char* buf, size_t size) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < size && i < 64; i++) mask |= (uint64_t)((unsigned char)buf[i] >> 7) << i;
+    return mask;
+}
+
+__attribute__((target("sse2")))
+static size_t highBytesSse2(const char* buf, size_t size, uint64_t* mask) {
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(buf + i)))) break;
+    }
+    while (i < size && (unsigned char)buf[i] < 0x80) i++;
+    if (size - i < 64) {
+        *mask = highBytesTail(buf + i, size - i);
+        return i;
+    }
+    *mask = 0;
+    for (int v = 0; v < 4; v++) {
+        uint64_t bits = (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(buf + i + 16 * v)));
+        *mask |= bits << (16 * v);
+    }
+    return i;
+}
+
+// ==========================================
+// AVX2 (32 bytes per step, pshufb classification)
+// ==========================================
+
+// Nibble tables: a byte is a vowel when lowTable[lo] & highTable[hi] != 0.
+// Bit 0: x1 x5 x9 xF in rows 4/6 (A E I O, a e i o). Bit 1: x5 in rows 5/7 (U, u).
+#define VOWEL_LOW_NIBBLES  0, 1, 0, 0, 0, 3, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1
+#define VOWEL_HIGH_NIBBLES 0, 0, 0, 0, 1, 2, 1, 2, 0, 0, 0, 0, 0, 0, 0, 0
+
+__attribute__((target("avx2,popcnt")))
+static int hammingScoreAvx2(const char* p, const char* pattern, size_t length) {
+    if (length < 32) return hammingScoreSse2(p, pattern, length);
+    int score = 0;
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + i)),
+                                       _mm256_loadu_si256((const __m256i*)(pattern + i)));
+        score += __builtin_popcount((unsigned)_mm256_movemask_epi8(eq));
+    }
+    if (i < length) {
+        size_t back = length - 32;
+        __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + back)),
+                                       _mm256_loadu_si256((const __m256i*)(pattern + back)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(eq) >> (i - back);
+        score += __builtin_popcount(mask);
+    }
+    return score;
+}
+
+__attribute__((target("avx2,bmi")))
+static size_t prefixLengthAvx2(const char* p, const char* pattern, size_t max) {
+    size_t i = 0;
+    for (; i + 32 <= max; i += 32) {
+        __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(p + i)),
+                                       _mm256_loadu_si256((const __m256i*)(pattern + i)));
+        unsigned mismatch = ~(unsigned)_mm256_movemask_epi8(eq);
+        if (mismatch) return i + __builtin_ctz(mismatch);
+    }
+    return i + prefixLengthSse2(p + i, pattern + i, max - i);
+}
+
+__attribute__((target("avx2,popcnt")))
+static uint64_t countVowelsAvx2(const char* buf, size_t size) {
+    const __m256i lowTable = _mm256_setr_epi8(VOWEL_LOW_NIBBLES, VOWEL_LOW_NIBBLES);
+    const __m256i highTable = _mm256_setr_epi8(VOWEL_HIGH_NIBBLES, VOWEL_HIGH_NIBBLES);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    uint64_t count = 0;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i*)(buf + i));
+        __m256i low = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(c, nibble));
+        __m256i high = _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi16(c, 4), nibble));
+        __m256i miss = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+        count += 32 - __builtin_popcount((unsigned)_mm256_movemask_epi8(miss));
+    }
+    return count + countVowelsSse2(buf + i, size - i);
+}
+
+__attribute__((target("avx2,bmi")))
+static size_t highBytesAvx2(const char* buf, size_t size, uint64_t* mask) {
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        unsigned high = (unsigned)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(buf + i)));
+        if (high) {
+            i += __builtin_ctz(high);
+            break;
+        }
+    }
+    while (i < size && (unsigned char)buf[i] < 0x80) i++;
+    if (size - i < 64) {
+        *mask = highBytesTail(buf + i, size - i);
+        return i;
+    }
+    uint64_t low = (unsigned)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(buf + i)));
+    uint64_t high = (unsigned)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(buf + i + 32)));
+    *mask = low | (high << 32);
+    return i;
+}
+
+// ==========================================
+// AVX-512BW (64 bytes per step, masked loads for the tail)
+// ==========================================
+
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static int hammingScoreAvx512(const char* p, const char* pattern, size_t length) {
+    int score = 0;
+    for (size_t i = 0; i < length; i += 64) {
+        size_t left = length - i;
+        __mmask64 lanes = left >= 64 ? ~0ULL : (1ULL << left) - 1;
+        __m512i a = _mm512_maskz_loadu_epi8(lanes, p + i);
+        __m512i b = _mm512_maskz_loadu_epi8(lanes, pattern + i);
+        score += __builtin_popcountll(_mm512_mask_cmpeq_epi8_mask(lanes, a, b));
+    }
+    return score;
+}
+
+__attribute__((target("avx512f,avx512bw,bmi")))
+static size_t prefixLengthAvx512(const char* p, const char* pattern, size_t max) {
+    for (size_t i = 0; i < max; i += 64) {
+        size_t left = max - i;
+        __mmask64 lanes = left >= 64 ? ~0ULL : (1ULL << left) - 1;
+        __m512i a = _mm512_maskz_loadu_epi8(lanes, p + i);
+        __m512i b = _mm512_maskz_loadu_epi8(lanes, pattern + i);
+        uint64_t mismatch = _mm512_mask_cmpneq_epi8_mask(lanes, a, b);
+        if (mismatch) return i + __builtin_ctzll(mismatch);
+    }
+    return max;
+}
+
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static uint64_t countVowelsAvx512(const char* buf, size_t size) {
+    const __m512i lowTable = _mm512_broadcast_i32x4(_mm_setr_epi8(VOWEL_LOW_NIBBLES));
+    const __m512i highTable = _mm512_broadcast_i32x4(_mm_setr_epi8(VOWEL_HIGH_NIBBLES));
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    uint64_t count = 0;
+    for (size_t i = 0; i < size; i += 64) {
+        size_t left = size - i;
+        __mmask64 lanes = left >= 64 ? ~0ULL : (1ULL << left) - 1;
+        __m512i c = _mm512_maskz_loadu_epi8(lanes, buf + i);
+        __m512i low = _mm512_shuffle_epi8(lowTable, _mm512_and_si512(c, nibble));
+        __m512i high = _mm512_shuffle_epi8(highTable, _mm512_and_si512(_mm512_srli_epi16(c, 4), nibble));
+        count += __builtin_popcountll(_mm512_test_epi8_mask(low, high)); // Zeroed lanes never match
+    }
+    return count;
+}
+
+__attribute__((target("avx512f,avx512bw,bmi")))
+static size_t highBytesAvx512(const char* buf, size_t size, uint64_t* mask) {
+    for (size_t i = 0; i < size; i += 64) {
+        size_t left = size - i;
+        __mmask64 lanes = left >= 64 ? ~0ULL : (1ULL << left) - 1;
+        uint64_t high = _mm512_movepi8_mask(_mm512_maskz_loadu_epi8(lanes, buf + i)); // Zeroed lanes are ASCII
+        if (high) {
+            i += __builtin_ctzll(high);
+            left = size - i;
+            lanes = left >= 64 ? ~0ULL : (1ULL << left) - 1;
+            *mask = _mm512_movepi8_mask(_mm512_maskz_loadu_epi8(lanes, buf + i));
+            return i;
+        }
+    }
+    *mask = 0;
+    return size;
+}
+
+// ==========================================
+// DISPATCH
+// ==========================================
+
+static const SimdKernels scalarKernels = { "scalar", NULL, NULL, NULL, NULL };
+static const SimdKernels sse2Kernels = {
+    "sse2", hammingScoreSse2, prefixLengthSse2, countVowelsSse2, highBytesSse2
+};
+static const SimdKernels avx2Kernels = {
+    "avx2", hammingScoreAvx2, prefixLengthAvx2, countVowelsAvx2, highBytesAvx2
+};
+static const SimdKernels avx512Kernels = {
+    "avx512", hammingScoreAvx512, prefixLengthAvx512, countVowelsAvx512, highBytesAvx512
+};
+
+const SimdKernels* simdKernelsFor(const char* level) {
+    __builtin_cpu_init();
+    int hasSse2 = __builtin_cpu_supports("sse2") && __builtin_cpu_supports("popcnt");
+    int hasAvx2 = hasSse2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+    int hasAvx512 = hasAvx2 && __builtin_cpu_supports("avx512bw");
+
+    if (level == NULL) {
+        if (hasAvx512) return &avx512Kernels;
+        if (hasAvx2) return &avx2Kernels;
+        if (hasSse2) return &sse2Kernels;
+        return &scalarKernels;
+    }
+    if (strcmp(level, "scalar") == 0) return &scalarKernels;
+    if (strcmp(level, "sse2") == 0) return hasSse2 ? &sse2Kernels : NULL;
+    if (strcmp(level, "avx2") == 0) return hasAvx2 ? &avx2Kernels : NULL;
+    if (strcmp(level, "avx512") == 0) return hasAvx512 ? &avx512Kernels : NULL;
+    return NULL;
+}
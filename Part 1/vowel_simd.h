@@ -0,0 +1,35 @@
+/* vowel_simd.h */
+/* Vectorized kernels for vowel_counting.c, picked at startup via CPUID */
+
+#ifndef VOWEL_SIMD_H
+#define VOWEL_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One implementation level. A NULL kernel means "use the scalar code in
+// vowel_counting.c", so the scalar level is simply all NULLs.
+typedef struct {
+    const char* name;
+
+    // Positions where p[i] == pattern[i] for i < length
+    int (*hammingScore)(const char* p, const char* pattern, size_t length);
+
+    // Length of the common prefix of p and pattern, at most max.
+    // Both must be readable for max bytes.
+    size_t (*prefixLength)(const char* p, const char* pattern, size_t max);
+
+    // Number of aeiouAEIOU bytes in buf[0..size)
+    uint64_t (*countVowels)(const char* buf, size_t size);
+
+    // UTF-8 decoder fast path: offset of the first byte >= 0x80 in
+    // buf[0..size) (size if none), with *mask set to which of the up to 64
+    // bytes from there are >= 0x80 (bit 0 = that byte; 0 if none)
+    size_t (*highBytes)(const char* buf, size_t size, uint64_t* mask);
+} SimdKernels;
+
+// Kernels for "scalar", "sse2", "avx2" or "avx512"; NULL picks the best
+// level this CPU supports. Returns NULL for unknown or unsupported levels.
+const SimdKernels* simdKernelsFor(const char* level);
+
+#endif
@@ -0,0 +1,221 @@
+/* vowel_stats.h */
+/* libvowelstats - reentrant buffer analysis behind an opaque context */
+
+#ifndef VOWEL_STATS_H
+#define VOWEL_STATS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "vowel_patterns.h"
+#include "vowel_utf8.h"
+#include "vowel_cache.h"
+#include "vowel_mismatch.h"
+#include "vowel_index.h"
+
+#define VOWEL_STATS_PI_LENGTH 100     // Digits of pi the matchers compare against
+#define VOWEL_STATS_MAX_PATTERNS 32   // Extra reference sequences per context
+
+// Tallies of sampled bytes; the report's sparse line samples offsets divisible by 1000
+typedef struct {
+    uint64_t positionsChecked;
+    uint64_t count3;
+    uint64_t vowelCount;
+    uint64_t digitCount;
+} VowelStatsSparse;
+
+// Everything one analysis produces; plain data, safe to copy
+typedef struct {
+    uint64_t size;                   // Bytes analyzed
+    uint64_t vowelCount;
+    uint64_t byteCounts[256];        // Full histogram
+    uint64_t letterCounts[26];       // a-z, case folded
+    uint64_t digitCounts[10];
+    size_t longestPiMatch;
+    int bestHammingScore;            // Matching digits out of 100
+    int64_t bestHammingIndex;        // -1 when no 100-byte window matches a digit
+    char bestHammingWindow[VOWEL_STATS_PI_LENGTH]; // Input bytes at bestHammingIndex
+    VowelStatsSparse sparse;
+    int patternCount;                // Entries of the pattern set, in set order
+    size_t patternLongest[VOWEL_STATS_MAX_PATTERNS];
+    bool hasUtf8;                    // The UTF-8 pass ran
+    Utf8Counts utf8;                 // Code points, scripts and accented vowels
+    uint64_t contentHash;            // Sum of the input's word terms (vowel_cache.h)
+} VowelStatsResult;
+
+// Analysis context: options plus scratch state. A context serves one call at
+// a time; separate contexts can be used from separate threads concurrently.
+typedef struct VowelStats VowelStats;
+
+VowelStats* vowelStatsCreate(void);
+// New context with the same options (for one-context-per-thread callers)
+VowelStats* vowelStatsClone(const VowelStats* stats);
+void vowelStatsFree(VowelStats* stats);
+
+// Threads the histogram and Hamming passes are split across (0 = online CPUs).
+// The context starts threads-1 workers on first use and keeps them parked
+// until it is freed or the count changes; 1 runs everything on the caller.
+void vowelStatsSetThreads(VowelStats* stats, int threads);
+
+// Vector kernel level: "scalar", "sse2", "avx2", "avx512", or NULL for the
+// best this CPU supports (the default). Returns -1 if unknown or unsupported.
+int vowelStatsSetSimdLevel(VowelStats* stats, const char* level);
+const char* vowelStatsSimdLevel(const VowelStats* stats);
+
+// Hamming search engine: "unrolled" (per-offset compares, the default),
+// "bitset" (bit-parallel scores for 64 offsets at a time), "template" (the
+// unrolled compares generated from pi's digits at compile time, see
+// vowel_templates.h) or "qgram" (the k-mismatch filter below at its widest,
+// falling back to "unrolled" when no window is within its reach). Returns
+// -1 if unknown.
+int vowelStatsSetHammingBackend(VowelStats* stats, const char* backend);
+
+// k-mismatch search over the 100-byte windows the Hamming pass scores.
+// Thresholds up to 11 mismatches run the pigeonhole q-gram filter of
+// vowel_mismatch.h and only verify the windows it passes; higher ones
+// count every window. Both use the context's threads.
+//
+// FindMismatches appends every window with at most maxMismatches mismatches
+// (capped at 99, so a window must match somewhere) to *hits, in index order.
+// TopMatches writes the k best windows to hits[0..k), highest score first,
+// then lowest index, and sets *count (fewer if fewer windows score at all):
+// hits[0] is the match the report's Hamming lines give. Both return -1 if
+// out of memory.
+int vowelStatsFindMismatches(VowelStats* stats, const char* buf, size_t size, int maxMismatches,
+                             MismatchList* hits);
+int vowelStatsTopMatches(VowelStats* stats, const char* buf, size_t size, size_t k, MismatchHit* hits,
+                         size_t* count);
+
+// Writes a suffix index of buf[0..size) to `path` for suffixIndexOpen() (see
+// vowel_index.h): SA-IS over the input, with the suffix type and bucket
+// count passes split across the context's threads. Returns -1 (errno set)
+// if the file cannot be written, the input is over SUFFIX_INDEX_MAX_BYTES or
+// out of memory.
+int vowelStatsBuildIndex(VowelStats* stats, const char* buf, size_t size, const char* path);
+
+// Longest pi prefix engine: "scan" (memchr to each '3' then compare, the
+// default), "kmp" (linear time on any input) or "template" (the scan with
+// the compare generated from pi's digits). Returns -1 if unknown.
+int vowelStatsSetPrefixEngine(VowelStats* stats, const char* engine);
+
+// Byte histogram engine: "split" (interleaved 16-bit tables, vowels read off
+// the finished histogram, the default) or "unrolled" (one 64-bit table, each
+// byte classified for the vowel count). Returns -1 if unknown.
+int vowelStatsSetHistogramEngine(VowelStats* stats, const char* engine);
+
+// Additional reference sequences (a built PatternSet that outlives the
+// context, or NULL for none). The set is scanned once however many patterns
+// it holds. Returns -1 if it has more than VOWEL_STATS_MAX_PATTERNS.
+int vowelStatsSetPatternSet(VowelStats* stats, const PatternSet* set);
+
+// Passes an analysis runs (default: all but UTF-8). A skipped pass leaves its
+// fields as a fresh result has them - zero, or -1 for bestHammingIndex - so a
+// caller that needs only some statistics does not pay for the rest.
+#define VOWEL_STATS_HISTOGRAM  0x01 // vowelCount, byteCounts, letter and digit tables
+#define VOWEL_STATS_PI_PREFIX  0x02 // longestPiMatch
+#define VOWEL_STATS_HAMMING    0x04 // bestHamming*
+#define VOWEL_STATS_SPARSE     0x08 // sparse
+#define VOWEL_STATS_PATTERNS   0x10 // patternLongest
+#define VOWEL_STATS_UTF8       0x20 // utf8: validating decode of the input as UTF-8
+#define VOWEL_STATS_HASH       0x40 // contentHash, in the histogram's loop
+#define VOWEL_STATS_DEFAULT    0x1f // What original.out reports
+#define VOWEL_STATS_ALL        0x7f
+
+void vowelStatsSetPasses(VowelStats* stats, unsigned passes);
+
+// Fused pipeline: read the buffer once, `blockBytes` at a time, updating every
+// statistic per block while it is still in cache (0 = the multi-pass design -
+// histogram on the calling thread, other passes as a job on the context's
+// worker threads - which is the default).
+void vowelStatsSetFusedBlock(VowelStats* stats, size_t blockBytes);
+
+// Result cache (an open ResultCache that outlives the context, or NULL for
+// none, the default). With a cache, vowelStatsAnalyze() counts the histogram
+// and hashes the input first, then looks the result up by hash, size and the
+// options that change it (passes, prefix and Hamming engines, pattern set);
+// a hit returns the stored result without running the other passes, a miss
+// runs them as usual (fused, if a block is set) and stores what they give.
+// Streams and parts are never cached.
+void vowelStatsSetCache(VowelStats* stats, ResultCache* cache);
+
+// Strided sampling: tally buf[offset], buf[offset + stride], ... below `size`
+// into *sample (overwritten). Returns -1 if stride is 0.
+int vowelStatsSample(const VowelStats* stats, const char* buf, size_t size, size_t offset, size_t stride,
+                     VowelStatsSparse* sample);
+
+typedef struct {
+    size_t offset;
+    size_t stride;
+} VowelStatsStride;
+
+// Many samplings in one pass over the buffer: samples[i] gets what
+// vowelStatsSample() gives for strides[i], but every stride visits a block
+// while it is still cached. Returns -1 if a stride is 0 or out of memory.
+int vowelStatsSampleStrides(const VowelStats* stats, const char* buf, size_t size,
+                            const VowelStatsStride* strides, int count, VowelStatsSparse* samples);
+
+// Software prefetch distance of strided walks, in strides (default 16; 0 =
+// the plain pointer-bump loop). Strides under a cache line never prefetch.
+void vowelStatsSetPrefetchDistance(VowelStats* stats, unsigned strides);
+
+// Buffer for a large input: anonymous memory aligned to 2 MiB with
+// transparent huge pages requested, so a strided walk takes a TLB miss per
+// 2 MiB rather than per 4 KiB page. Free with vowelStatsFreeBuffer() and the
+// same size. NULL if out of memory or too close to SIZE_MAX to round up.
+char* vowelStatsAllocBuffer(size_t size);
+void vowelStatsFreeBuffer(char* buf, size_t size);
+
+// Analyze buf[0..size). Returns 0, or -1 if scratch memory ran out.
+int vowelStatsAnalyze(VowelStats* stats, const char* buf, size_t size, VowelStatsResult* result);
+
+// Split analysis: buf[first..last) of a `size`-byte buffer, reading past
+// `last` as far as a match that starts inside can reach. No side job;
+// set the thread count to 1 to keep it on the calling thread. Parts covering
+// [0, size) merged in any order give exactly the vowelStatsAnalyze() result.
+// Returns -1 if out of memory.
+int vowelStatsAnalyzePart(VowelStats* stats, const char* buf, size_t size, size_t first, size_t last,
+                          VowelStatsResult* part);
+// Fold `part` into `total` (start `total` as a copy of one part)
+void vowelStatsMerge(VowelStatsResult* total, const VowelStatsResult* part);
+
+// Streaming: feed the input one window at a time instead of one buffer.
+// Each window is `carry` bytes repeated from the end of the previous window
+// followed by `fresh` new bytes. The carry must be the last
+// min(STREAM_OVERLAP, previous window length) bytes so pi matches that cross
+// a chunk boundary are still found. Begin returns -1 if out of memory.
+#define STREAM_OVERLAP (VOWEL_STATS_PI_LENGTH - 1)
+
+int vowelStatsStreamBegin(VowelStats* stats);
+void vowelStatsStreamProcess(VowelStats* stats, const char* window, size_t carry, size_t fresh);
+void vowelStatsStreamEnd(VowelStats* stats, VowelStatsResult* result);
+
+// Checkpoints for append-only inputs: Save writes the stream state after the
+// last Process call (before End) to `path`; Resume begins a stream from it, so
+// only bytes appended since then need processing, and the end result is the
+// one a stream over the whole input gives. The first window after Resume
+// carries the bytes vowelStatsStreamTail() returns. Save needs
+// VOWEL_STATS_HASH among the passes and returns -1 without it. Resume
+// returns -1 if the file is missing, damaged, of another format version, or
+// was written with options that give different results (passes, prefix
+// engine, pattern set); *size is the input length the checkpoint covers and
+// *prefixHash the content hash of those bytes, for the caller to check the
+// input still starts with them.
+int vowelStatsStreamSave(const VowelStats* stats, const char* path);
+int vowelStatsStreamResume(VowelStats* stats, const char* path, uint64_t* size, uint64_t* prefixHash);
+// The last min(STREAM_OVERLAP, size) bytes streamed, into carry; returns the count
+size_t vowelStatsStreamTail(const VowelStats* stats, char* carry);
+
+// The report original.out prints: pi, Hamming, sparse-address and pattern
+// lines, then the vowel/letter/digit line, then UTF-8 lines if that pass
+// ran. `patterns` names the pattern lines and must be the set the result was
+// computed with (or NULL).
+void vowelStatsPrint(FILE* out, const VowelStatsResult* result, const PatternSet* patterns);
+// Every byte value's count, 8 per line, then totals per byte class
+void vowelStatsPrintBytes(FILE* out, const VowelStatsResult* result);
+// The same result as one JSON object on one line, tagged with `name`. A NULL
+// result prints an error record for inputs that could not be read.
+void vowelStatsPrintJson(FILE* out, const char* name, const VowelStatsResult* result,
+                         const PatternSet* patterns);
+
+#endif
@@ -0,0 +1,109 @@
+/* vowel_templates.cpp */
+/* Pattern kernels generated from templates over the pattern's bytes */
+
+#include <string.h> // for memcmp
+#include <utility>  // for std::index_sequence, std::integral_constant
+#include "vowel_templates.h"
+
+// Built without exceptions or RTTI and with nothing from the C++ runtime, so
+// the object links into the C library and programs as plain C.
+//
+// A pattern is a pointer to a constexpr literal. Each kernel expands over an
+// index pack, reading Literal[I] as a template argument: the compiler has to
+// fold it to a constant, so the 100 compares against pi come out as 100
+// compares against immediates with no loop, at any optimization level.
+// always_inline is honoured at -O0 too, so the pruned blocks of the Hamming
+// kernel end up in one function like the hand-unrolled C.
+
+// ==========================================
+// PATTERN KERNELS
+// ==========================================
+
+#define HAMMING_BLOCK 20 // Positions scored between pruning checks
+
+// index_sequence<Offset, ..., Offset + N - 1>
+template <size_t Offset, size_t... I>
+static constexpr std::index_sequence<(Offset + I)...> shift(std::index_sequence<I...>) {
+    return {};
+}
+template <size_t Offset, size_t N>
+using Span = decltype(shift<Offset>(std::make_index_sequence<N>{}));
+
+template <const char* Literal, size_t Length>
+struct Pattern {
+    template <size_t... I>
+    static inline __attribute__((always_inline)) int matches(const char* p, std::index_sequence<I...>) {
+        return ((p[I] == std::integral_constant<char, Literal[I]>::value) + ...);
+    }
+
+    template <size_t Offset>
+    static inline __attribute__((always_inline)) int scoreFrom(const char* p, int score, int bound) {
+        constexpr size_t block = Length - Offset < HAMMING_BLOCK ? Length - Offset : HAMMING_BLOCK;
+        score += matches(p, Span<Offset, block>{});
+        if constexpr (Offset + block < Length) {
+            if (score + (int)(Length - Offset - block) <= bound) return score;
+            return scoreFrom<Offset + block>(p, score, bound);
+        } else {
+            return score;
+        }
+    }
+
+    static int hammingScore(const char* p, int bound) {
+        return scoreFrom<0>(p, 0, bound);
+    }
+
+    // The && fold stops at the first mismatch
+    template <size_t... I>
+    static size_t prefixFrom(const char* p, std::index_sequence<I...>) {
+        size_t length = 0;
+        (void)(... && (p[I] == std::integral_constant<char, Literal[I]>::value ? (length++, true) : false));
+        return length;
+    }
+
+    static size_t prefixLength(const char* p) {
+        return prefixFrom(p, std::make_index_sequence<Length>{});
+    }
+
+    // The same fold with the bound checked first, for starts near the end of the input
+    template <size_t... I>
+    static size_t prefixFromUpTo(const char* p, size_t limit, std::index_sequence<I...>) {
+        size_t length = 0;
+        (void)(... && (I < limit && p[I] == std::integral_constant<char, Literal[I]>::value ? (length++, true)
+                                                                                             : false));
+        return length;
+    }
+
+    static size_t prefixLengthUpTo(const char* p, size_t limit) {
+        return prefixFromUpTo(p, limit, std::make_index_sequence<Length>{});
+    }
+};
+
+// The same digits as vowel_patterns.c; patternKernelsFor() compares the bytes,
+// so a mismatch here only means the lookup finds nothing
+static constexpr char piLiteral[] = "3141592653589793238462643383279502884197169399375105820974944592307816406286208998628034825342117067";
+static constexpr char eLiteral[] = "2718281828459045235360287471352662497757247093699959574966967627724076630353547594571382178525166427";
+static constexpr char sqrt2Literal[] = "1414213562373095048801688724209698078569671875376948073176679737990732478462107038850387534327641572";
+
+#define PATTERN_KERNELS(name, literal)                                          \
+    { name, sizeof(literal) - 1, Pattern<literal, sizeof(literal) - 1>::hammingScore, \
+      Pattern<literal, sizeof(literal) - 1>::prefixLength,                      \
+      Pattern<literal, sizeof(literal) - 1>::prefixLengthUpTo }
+
+static const PatternKernels instantiations[] = {
+    PATTERN_KERNELS("pi", piLiteral),
+    PATTERN_KERNELS("e", eLiteral),
+    PATTERN_KERNELS("sqrt2", sqrt2Literal),
+};
+
+#undef PATTERN_KERNELS
+
+static const char* const literals[] = { piLiteral, eLiteral, sqrt2Literal };
+
+const PatternKernels* patternKernelsFor(const char* pattern, size_t length) {
+    for (size_t i = 0; i < sizeof(instantiations) / sizeof(instantiations[0]); i++) {
+        if (instantiations[i].length == length && memcmp(literals[i], pattern, length) == 0) {
+            return &instantiations[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,39 @@
+/* vowel_templates.h */
+/* Compile-time specialized kernels (C++ templates, vowel_templates.cpp) */
+
+#ifndef VOWEL_TEMPLATES_H
+#define VOWEL_TEMPLATES_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The kernels for one reference sequence, instantiated with its bytes as
+// template arguments: every compare is against an immediate and the loops
+// are unrolled by pack expansion, so even -O0 builds emit straight-line code.
+typedef struct {
+    const char* name;
+    size_t length;
+
+    // Positions where p[i] == pattern[i]. Scored in blocks of 20 like the
+    // unrolled C kernel: once the rest of the pattern cannot lift the score
+    // above `bound` it returns early with a score <= bound.
+    int (*hammingScore)(const char* p, int bound);
+
+    // Length of the common prefix of p and the pattern (p readable for `length` bytes)
+    size_t (*prefixLength)(const char* p);
+    // The same, reading at most `limit` bytes of p
+    size_t (*prefixLengthUpTo)(const char* p, size_t limit);
+} PatternKernels;
+
+// The instantiation whose bytes are pattern[0..length), or NULL if none was
+// compiled in (pi, e and sqrt2 are)
+const PatternKernels* patternKernelsFor(const char* pattern, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,308 @@
+/* vowel_utf8.c */
+/* Validating UTF-8 decoder (byte-class DFA) with code point statistics */
+
+#include <string.h> // for memcpy
+#include "vowel_utf8.h"
+
+// ==========================================
+// DFA TABLES
+// ==========================================
+
+// Byte classes: which ranges a state can tell apart (Unicode Table 3-7)
+enum {
+    CLASS_ASCII,    // 00..7F
+    CLASS_CONT_80,  // 80..8F
+    CLASS_CONT_90,  // 90..9F
+    CLASS_CONT_A0,  // A0..BF
+    CLASS_LEAD2,    // C2..DF
+    CLASS_E0,       // E0: second byte A0..BF (no overlong forms)
+    CLASS_LEAD3,    // E1..EC, EE..EF
+    CLASS_ED,       // ED: second byte 80..9F (no surrogates)
+    CLASS_F0,       // F0: second byte 90..BF (no overlong forms)
+    CLASS_LEAD4,    // F1..F3
+    CLASS_F4,       // F4: second byte 80..8F (nothing past U+10FFFF)
+    CLASS_INVALID,  // C0, C1, F5..FF
+    CLASS_COUNT
+};
+
+// States: ACCEPT between sequences, NEEDn with n continuation bytes to go,
+// and the four states whose next byte has a narrower range
+enum {
+    ACCEPT,
+    NEED1,
+    NEED2,
+    NEED3,
+    AFTER_E0,
+    AFTER_ED,
+    AFTER_F0,
+    AFTER_F4,
+    STATE_COUNT,
+    REJECT = STATE_COUNT
+};
+
+static const unsigned char byteClass[256] = {
+    [0x80 ... 0x8F] = CLASS_CONT_80,
+    [0x90 ... 0x9F] = CLASS_CONT_90,
+    [0xA0 ... 0xBF] = CLASS_CONT_A0,
+    [0xC0 ... 0xC1] = CLASS_INVALID,
+    [0xC2 ... 0xDF] = CLASS_LEAD2,
+    [0xE0] = CLASS_E0,
+    [0xE1 ... 0xEC] = CLASS_LEAD3,
+    [0xED] = CLASS_ED,
+    [0xEE ... 0xEF] = CLASS_LEAD3,
+    [0xF0] = CLASS_F0,
+    [0xF1 ... 0xF3] = CLASS_LEAD4,
+    [0xF4] = CLASS_F4,
+    [0xF5 ... 0xFF] = CLASS_INVALID,
+};
+
+#define R REJECT
+static const unsigned char transitions[STATE_COUNT][CLASS_COUNT] = {
+    //           ASCII   80     90     A0     L2     E0        L3     ED        F0        L4     F4        INV
+    [ACCEPT]   = { ACCEPT, R,   R,     R,     NEED1, AFTER_E0, NEED2, AFTER_ED, AFTER_F0, NEED3, AFTER_F4, R },
+    [NEED1]    = { R,     ACCEPT, ACCEPT, ACCEPT, R, R, R, R, R, R, R, R },
+    [NEED2]    = { R,     NEED1, NEED1, NEED1, R, R, R, R, R, R, R, R },
+    [NEED3]    = { R,     NEED2, NEED2, NEED2, R, R, R, R, R, R, R, R },
+    [AFTER_E0] = { R,     R,     R,     NEED1, R, R, R, R, R, R, R, R },
+    [AFTER_ED] = { R,     NEED1, NEED1, R,     R, R, R, R, R, R, R, R },
+    [AFTER_F0] = { R,     R,     NEED2, NEED2, R, R, R, R, R, R, R, R },
+    [AFTER_F4] = { R,     NEED2, R,     R,     R, R, R, R, R, R, R, R },
+};
+#undef R
+
+// Payload bits of a lead byte, by class
+static const unsigned char leadMask[CLASS_COUNT] = {
+    [CLASS_ASCII] = 0x7F, [CLASS_LEAD2] = 0x1F, [CLASS_E0] = 0x0F, [CLASS_LEAD3] = 0x0F,
+    [CLASS_ED] = 0x0F, [CLASS_F0] = 0x07, [CLASS_LEAD4] = 0x07, [CLASS_F4] = 0x07,
+};
+
+// ==========================================
+// CODE POINT CLASSES
+// ==========================================
+
+// Script of each BMP code point, 16 at a time (every block boundary below
+// is a multiple of 16). ASCII never gets here, so 0 marks "other".
+static const unsigned char bmpScripts[0x10000 >> 4] = {
+    [0x008 ... 0x02A] = UTF8_SCRIPT_LATIN,     // U+0080..02AF: Latin-1 through IPA
+    [0x037 ... 0x03F] = UTF8_SCRIPT_GREEK,     // U+0370..03FF
+    [0x040 ... 0x052] = UTF8_SCRIPT_CYRILLIC,  // U+0400..052F
+    [0x059 ... 0x05F] = UTF8_SCRIPT_HEBREW,    // U+0590..05FF
+    [0x060 ... 0x06F] = UTF8_SCRIPT_ARABIC,    // U+0600..06FF
+    [0x075 ... 0x077] = UTF8_SCRIPT_ARABIC,    // U+0750..077F: supplement
+    [0x090 ... 0x0DF] = UTF8_SCRIPT_INDIC,     // U+0900..0DFF: Devanagari through Sinhala
+    [0x1E0 ... 0x1EF] = UTF8_SCRIPT_LATIN,     // U+1E00..1EFF: Latin Extended Additional
+    [0x1F0 ... 0x1FF] = UTF8_SCRIPT_GREEK,     // U+1F00..1FFF: Greek Extended
+    [0x200 ... 0x2BF] = UTF8_SCRIPT_SYMBOL,    // U+2000..2BFF: punctuation, arrows, math
+    [0x2E8 ... 0x31F] = UTF8_SCRIPT_CJK,       // U+2E80..31FF: radicals, kana, bopomofo
+    [0x340 ... 0x4DB] = UTF8_SCRIPT_CJK,       // U+3400..4DBF: Han Extension A
+    [0x4E0 ... 0x9FF] = UTF8_SCRIPT_CJK,       // U+4E00..9FFF: Han
+    [0xAC0 ... 0xD7A] = UTF8_SCRIPT_CJK,       // U+AC00..D7AF: Hangul
+    [0xF90 ... 0xFAF] = UTF8_SCRIPT_CJK,       // U+F900..FAFF: compatibility Han
+    [0xFF0 ... 0xFFE] = UTF8_SCRIPT_CJK,       // U+FF00..FFEF: full and half width forms
+};
+
+static const char* const scriptNames[UTF8_SCRIPT_COUNT] = {
+    "ascii", "latin", "greek", "cyrillic", "hebrew", "arabic", "indic", "cjk", "symbol", "other",
+};
+
+// Base vowel of each precomposed letter (NFD first character), '.' if none:
+// Latin-1 Supplement through Latin Extended-B, then Latin Extended Additional
+#define LATIN_FIRST 0x00C0
+#define LATIN_LAST 0x024F
+#define LATIN_ADDITIONAL_FIRST 0x1E00
+#define LATIN_ADDITIONAL_LAST 0x1EFF
+
+static const char latinVowels[] =
+    "aaaaaa..eeeeiiii..ooooo..uuuu...aaaaaa..eeeeiiii..ooooo..uuuu..."
+    "aaaaaa............eeeeeeeeee............iiiiiiiii..............."
+    "............oooooo......................uuuuuuuuuuuu............"
+    "................................oo.............uu..............."
+    ".............aaiioouuuuuuuuuu.aaaa........oooo............aa...."
+    "aaaaeeeeiiiioooo....uuuu..............aaeeoooooooo.............."
+    "................";
+
+static const char latinAdditionalVowels[] =
+    "aa..................eeeeeeeeee..............iiii................"
+    "............oooooooo..............................uuuuuuuuuu...."
+    "................................aaaaaaaaaaaaaaaaaaaaaaaaeeeeeeee"
+    "eeeeeeeeiiiioooooooooooooooooooooooouuuuuuuuuuuuuu..............";
+
+_Static_assert(sizeof(latinVowels) - 1 == LATIN_LAST - LATIN_FIRST + 1, "one entry per code point");
+_Static_assert(sizeof(latinAdditionalVowels) - 1 == LATIN_ADDITIONAL_LAST - LATIN_ADDITIONAL_FIRST + 1,
+               "one entry per code point");
+
+// Any code point past U+007F
+static Utf8Script scriptOf(uint32_t codePoint) {
+    if (codePoint < 0x10000) return bmpScripts[codePoint >> 4] ? bmpScripts[codePoint >> 4] : UTF8_SCRIPT_OTHER;
+    if (codePoint >= 0x1F000 && codePoint <= 0x1FAFF) return UTF8_SCRIPT_SYMBOL; // Emoji and pictographs
+    if (codePoint >= 0x20000 && codePoint <= 0x3FFFF) return UTF8_SCRIPT_CJK;    // Han Extensions B on
+    return UTF8_SCRIPT_OTHER;
+}
+
+static const signed char vowelIndex[128] = {
+    ['a'] = 1, ['e'] = 2, ['i'] = 3, ['o'] = 4, ['u'] = 5, // Index + 1, 0 = not a vowel
+};
+
+// Accented vowel a e i o u (0-4) of a Latin code point, or -1
+static int accentedVowelOf(uint32_t codePoint) {
+    char base = '.';
+    if (codePoint >= LATIN_FIRST && codePoint <= LATIN_LAST) {
+        base = latinVowels[codePoint - LATIN_FIRST];
+    } else if (codePoint >= LATIN_ADDITIONAL_FIRST && codePoint <= LATIN_ADDITIONAL_LAST) {
+        base = latinAdditionalVowels[codePoint - LATIN_ADDITIONAL_FIRST];
+    }
+    return vowelIndex[(unsigned char)base] - 1;
+}
+
+// A complete multi-byte sequence. A macro so the -O0 build does not pay a
+// call per code point; the Latin check keeps the vowel tables off other scripts.
+#define COUNT_CODE_POINT(codePoint, length)                                          \
+    do {                                                                             \
+        uint32_t cp_ = (codePoint);                                                  \
+        counts->codePoints++;                                                        \
+        counts->lengths[(length) - 1]++;                                             \
+        Utf8Script script_ = cp_ < 0x10000 ? bmpScripts[cp_ >> 4] : scriptOf(cp_);   \
+        if (script_ == UTF8_SCRIPT_ASCII) script_ = UTF8_SCRIPT_OTHER;               \
+        counts->scripts[script_]++;                                                  \
+        if (script_ == UTF8_SCRIPT_LATIN) {                                          \
+            int vowel_ = accentedVowelOf(cp_);                                       \
+            if (vowel_ >= 0) counts->accentedVowels[vowel_]++;                       \
+        }                                                                            \
+    } while (0)
+
+// ==========================================
+// DECODER
+// ==========================================
+
+#define HIGH_BITS 0x8080808080808080ULL
+#define GATHER_HIGH_BITS 0x0102040810204080ULL // Moves bit 0 of each byte into the top byte
+
+// Eight bytes per step; each word's high bits gathered into a byte of the mask
+static size_t highBytesScalar(const char* buf, size_t size, uint64_t* mask) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, buf + i, 8);
+        if (word & HIGH_BITS) break;
+    }
+    while (i < size && (unsigned char)buf[i] < 0x80) i++;
+
+    *mask = 0;
+    size_t at = 0;
+    for (; at < 64 && i + at + 8 <= size; at += 8) {
+        uint64_t word;
+        memcpy(&word, buf + i + at, 8);
+        *mask |= ((((word & HIGH_BITS) >> 7) * GATHER_HIGH_BITS) >> 56) << at;
+    }
+    for (; at < 64 && i + at < size; at++) *mask |= (uint64_t)((unsigned char)buf[i + at] >> 7) << at;
+    return i;
+}
+
+void utf8DecoderInit(Utf8Decoder* decoder) {
+    decoder->state = ACCEPT;
+    decoder->codePoint = 0;
+    decoder->length = 0;
+}
+
+void utf8DecoderFeed(Utf8Decoder* decoder, const char* buf, size_t size, Utf8HighBytesFn highBytes,
+                     Utf8Counts* counts) {
+    if (highBytes == NULL) highBytes = highBytesScalar;
+    register uint32_t state = decoder->state;
+    register uint32_t codePoint = decoder->codePoint;
+    int length = decoder->length;
+    register const unsigned char* ptr = (const unsigned char*)buf;
+    const unsigned char* end = ptr + size;
+    uint64_t window = 0; // High bytes from ptr on, as the kernel last saw them
+    uint64_t asciiCount = 0;
+
+    while (ptr < end) {
+        if (state == ACCEPT) {
+            // Between sequences: step over ASCII to the next high byte, from
+            // the mask while it has one, else by asking the kernel
+            size_t run;
+            if (window == 0) {
+                run = highBytes((const char*)ptr, end - ptr, &window);
+            } else {
+                run = __builtin_ctzll(window);
+                window >>= run;
+            }
+            asciiCount += run;
+            ptr += run;
+            if (ptr == end) break;
+
+            // Well-formed 2- and 3-byte sequences in one step, the DFA for the rest
+            unsigned char class = byteClass[*ptr];
+            if (class == CLASS_LEAD2 && end - ptr >= 2 && (ptr[1] & 0xC0) == 0x80) {
+                COUNT_CODE_POINT(((ptr[0] & 0x1F) << 6) | (ptr[1] & 0x3F), 2);
+                ptr += 2;
+                window >>= 2;
+                continue;
+            }
+            if (class == CLASS_LEAD3 && end - ptr >= 3 && ((ptr[1] & ptr[2]) & 0xC0) == 0x80 &&
+                ((ptr[1] | ptr[2]) & 0x40) == 0) {
+                COUNT_CODE_POINT(((ptr[0] & 0x0F) << 12) | ((ptr[1] & 0x3F) << 6) | (ptr[2] & 0x3F), 3);
+                ptr += 3;
+                window >>= 3;
+                continue;
+            }
+        }
+
+        unsigned char c = *ptr;
+        unsigned char class = byteClass[c];
+        uint32_t next = transitions[state][class];
+        window = 0; // The DFA moves byte by byte; ask the kernel again after it
+        if (next == REJECT) {
+            counts->invalid++;
+            if (state == ACCEPT) {
+                ptr++; // A stray continuation or never-valid byte
+            }
+            // Otherwise the byte that broke the sequence may start the next one
+            state = ACCEPT;
+            length = 0;
+            continue;
+        }
+
+        codePoint = state == ACCEPT ? (c & leadMask[class]) : (codePoint << 6) | (c & 0x3F);
+        length++;
+        state = next;
+        ptr++;
+        if (state == ACCEPT) {
+            COUNT_CODE_POINT(codePoint, length);
+            length = 0;
+        }
+    }
+
+    counts->codePoints += asciiCount;
+    counts->lengths[0] += asciiCount;
+    counts->scripts[UTF8_SCRIPT_ASCII] += asciiCount;
+    decoder->state = state;
+    decoder->codePoint = codePoint;
+    decoder->length = length;
+}
+
+#undef COUNT_CODE_POINT
+
+void utf8DecoderFinish(Utf8Decoder* decoder, Utf8Counts* counts) {
+    if (decoder->state != ACCEPT) counts->invalid++;
+    utf8DecoderInit(decoder);
+}
+
+size_t utf8SyncPoint(const char* buf, size_t first) {
+    for (size_t back = 0; back <= 3 && back <= first; back++) {
+        unsigned char c = (unsigned char)buf[first - back];
+        if (c < 0x80 || c >= 0xC0) return first - back;
+    }
+    return first;
+}
+
+void utf8CountsMerge(Utf8Counts* total, const Utf8Counts* part) {
+    total->codePoints += part->codePoints;
+    total->invalid += part->invalid;
+    for (int i = 0; i < 4; i++) total->lengths[i] += part->lengths[i];
+    for (int i = 0; i < UTF8_SCRIPT_COUNT; i++) total->scripts[i] += part->scripts[i];
+    for (int i = 0; i < 5; i++) total->accentedVowels[i] += part->accentedVowels[i];
+}
+
+const char* utf8ScriptName(Utf8Script script) {
+    return scriptNames[script];
+}
@@ -0,0 +1,69 @@
+/* vowel_utf8.h */
+/* Validating UTF-8 decoder (byte-class DFA) with code point statistics */
+
+#ifndef VOWEL_UTF8_H
+#define VOWEL_UTF8_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Script classes, by Unicode block. ASCII is its own class; "latin" is the
+// rest of Latin (accented letters, IPA, Vietnamese) and "cjk" covers Han,
+// kana, Hangul and their punctuation.
+typedef enum {
+    UTF8_SCRIPT_ASCII,
+    UTF8_SCRIPT_LATIN,
+    UTF8_SCRIPT_GREEK,
+    UTF8_SCRIPT_CYRILLIC,
+    UTF8_SCRIPT_HEBREW,
+    UTF8_SCRIPT_ARABIC,
+    UTF8_SCRIPT_INDIC,
+    UTF8_SCRIPT_CJK,
+    UTF8_SCRIPT_SYMBOL,  // General punctuation, arrows, math, emoji
+    UTF8_SCRIPT_OTHER,
+    UTF8_SCRIPT_COUNT
+} Utf8Script;
+
+typedef struct {
+    uint64_t codePoints;              // Well-formed code points
+    uint64_t invalid;                 // Ill-formed subsequences, one U+FFFD each
+    uint64_t lengths[4];              // Code points by encoded length, 1 to 4 bytes
+    uint64_t scripts[UTF8_SCRIPT_COUNT];
+    uint64_t accentedVowels[5];       // Precomposed a e i o u with diacritics, case folded
+} Utf8Counts;
+
+// Decoder state between calls, so input can arrive in pieces
+typedef struct {
+    uint32_t state;
+    uint32_t codePoint; // Bits of the sequence so far
+    int length;         // Bytes of the sequence so far
+} Utf8Decoder;
+
+// Offset of the first byte >= 0x80 in buf[0..size) (size if none), with
+// *mask set to which of the up to 64 bytes from there are >= 0x80. Usually a
+// vector kernel; NULL uses a word-at-a-time loop.
+typedef size_t (*Utf8HighBytesFn)(const char* buf, size_t size, uint64_t* mask);
+
+void utf8DecoderInit(Utf8Decoder* decoder);
+
+// Decodes buf[0..size) into counts. Errors follow the Unicode "maximal
+// subpart" practice, as most decoders do: an ill-formed sequence counts once
+// and decoding restarts at the byte that broke it. A sequence cut off at the
+// end stays in the decoder for the next call.
+void utf8DecoderFeed(Utf8Decoder* decoder, const char* buf, size_t size, Utf8HighBytesFn highBytes,
+                     Utf8Counts* counts);
+
+// End of input: a sequence still pending counts as one ill-formed subsequence
+void utf8DecoderFinish(Utf8Decoder* decoder, Utf8Counts* counts);
+
+// Where a decoder started fresh gives the same results as one that read
+// from the beginning: the last byte at or before `first` that is not a
+// continuation byte, looking back at most 3 bytes, else `first` itself
+size_t utf8SyncPoint(const char* buf, size_t first);
+
+void utf8CountsMerge(Utf8Counts* total, const Utf8Counts* part);
+
+// Short name for reports, e.g. "cyrillic"
+const char* utf8ScriptName(Utf8Script script);
+
+#endif